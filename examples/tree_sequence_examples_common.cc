@@ -51,9 +51,9 @@ apply_neutral_mutations(const options &o, const GSLrng &rng,
 options::options()
     : N{}, gcint(100), theta(), rho(), mean(0.), shape(1.), mu(),
       scoeff(std::numeric_limits<double>::quiet_NaN()), dominance(1.), scaling(2.),
-      seed(42), ancient_sampling_interval(-1), ancient_sample_size(-1), nsam(0),
+      gc_memory(0.), seed(42), ancient_sampling_interval(-1), ancient_sample_size(-1), nsam(0),
       leaf_test(false), matrix_test(false), visit_sites_test(false),
-      preserve_fixations(false), filename(), sfsfilename()
+      preserve_fixations(false), filename(), sfsfilename(), gc_report()
 {
 }
 
@@ -65,7 +65,11 @@ generate_main_options(options &o)
     options.add_options()("help", "Display help")
         ("N", po::value<unsigned>(&o.N), "Diploid population size")
         ("gc", po::value<unsigned>(&o.gcint),
-        "Simplification interval. Default is 100 generations.")
+        "Simplification interval. Default is 100 generations. Use 0 to let fwdpp::ts::simplification_scheduler pick the interval.")
+        ("gc_memory", po::value<double>(&o.gc_memory),
+        "Memory budget for the tables, in megabytes, when --gc is 0. Default is 0, meaning no budget.")
+        ("gc_report", po::value<std::string>(&o.gc_report),
+        "Write the decisions of the simplification scheduler to a file when --gc is 0.")
         ("theta", po::value<double>(&o.theta), "4Nu")
         ("rho", po::value<double>(&o.rho), "4Nr")
         ("mu", po::value<double>(&o.mu), "mutation rate to selected variants")
@@ -120,9 +124,9 @@ validate_primary_options(const options &o)
         {
             throw std::invalid_argument("N must be > 0");
         }
-    if (o.gcint < 1)
+    if (o.gc_memory < 0. || !std::isfinite(o.gc_memory))
         {
-            throw std::invalid_argument("Simplification (gc) interval must be > 0");
+            throw std::invalid_argument("gc_memory must be >= 0.0");
         }
     if (o.mu < 0)
         {
@@ -408,6 +412,26 @@ execute_serialization_test(const options &o,
         }
 }
 
+void
+write_gc_report(const options &o, const fwdpp::ts::simplification_scheduler &scheduler)
+{
+    if (o.gcint == 0 && !o.gc_report.empty())
+        {
+            const char *reasons[] = { "max_interval", "memory_budget", "edge_growth" };
+            std::ofstream out(o.gc_report.c_str());
+            out << "generation interval reason edges_before edges_after bytes_before "
+                   "simulation_seconds simplification_seconds growth_factor\n";
+            for (auto &d : scheduler.decisions())
+                {
+                    out << d.generation << ' ' << d.interval << ' '
+                        << reasons[static_cast<int>(d.reason)] << ' ' << d.edges_before
+                        << ' ' << d.edges_after << ' ' << d.bytes_before << ' '
+                        << d.simulation_seconds << ' ' << d.simplification_seconds << ' '
+                        << d.growth_factor << '\n';
+                }
+        }
+}
+
 void
 write_sfs(const options &o, const GSLrng &rng,
           const fwdpp::ts::std_table_collection &tables,
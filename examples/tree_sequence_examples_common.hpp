@@ -7,16 +7,17 @@
 #include <boost/program_options.hpp>
 #include <fwdpp/simfunctions/recycling.hpp>
 #include <fwdpp/ts/std_table_collection.hpp>
+#include <fwdpp/ts/simplification_scheduler.hpp>
 #include "tree_sequence_examples_types.hpp"
 
 struct options
 {
     fwdpp::uint_t N, gcint;
-    double theta, rho, mean, shape, mu, scoeff, dominance, scaling;
+    double theta, rho, mean, shape, mu, scoeff, dominance, scaling, gc_memory;
     unsigned seed;
     int ancient_sampling_interval, ancient_sample_size, nsam;
     bool leaf_test, matrix_test, visit_sites_test, preserve_fixations;
-    std::string filename, sfsfilename;
+    std::string filename, sfsfilename, gc_report;
     options();
 };
 
@@ -54,6 +55,9 @@ visit_sites_test(const options &o, const ts_examples_poptype &pop,
                  const fwdpp::ts::std_table_collection &tables,
                  const std::vector<fwdpp::ts::table_index_t> &samples);
 
+void write_gc_report(const options &o,
+                     const fwdpp::ts::simplification_scheduler &scheduler);
+
 void write_sfs(const options &o, const GSLrng &rng,
                const fwdpp::ts::std_table_collection &tables,
                const std::vector<fwdpp::ts::table_index_t> &samples);
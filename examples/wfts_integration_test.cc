@@ -65,6 +65,9 @@ main(int argc, char **argv)
     ts_examples_poptype pop(o.N);
     fwdpp::ts::std_table_collection tables(2 * pop.diploids.size(), 0, 0, 1.0);
     auto simplifier = fwdpp::ts::make_table_simplifier(tables);
+    // Only used if o.gcint == 0
+    fwdpp::ts::simplification_scheduler scheduler(
+        1, 10 * o.N, static_cast<std::size_t>(o.gc_memory * 1024. * 1024.));
     unsigned generation = 1;
     double recrate = o.rho / static_cast<double>(4 * o.N);
     fwdpp::genetic_map gm;
@@ -145,12 +148,26 @@ main(int argc, char **argv)
                               first_parental_index, next_index);
             // Recalculate fitnesses and the lookup table.
             lookup = calculate_fitnesses(pop, fitnesses, genetics.gvalue);
-            if (generation % o.gcint == 0.0)
+            if (o.gcint ? generation % o.gcint == 0.0
+                        : scheduler.should_simplify(generation, tables))
                 {
-                    auto rv = simplify_tables(
-                        pop, generation, pop.mcounts_from_preserved_nodes,
-                        tables, simplifier, tables.num_nodes() - 2 * o.N,
-                        2 * o.N, o.preserve_fixations);
+                    std::pair<std::vector<fwdpp::ts::table_index_t>,
+                              std::vector<std::size_t>>
+                        rv;
+                    const auto simplify = [&]() {
+                        rv = simplify_tables(pop, generation,
+                                             pop.mcounts_from_preserved_nodes, tables,
+                                             simplifier, tables.num_nodes() - 2 * o.N,
+                                             2 * o.N, o.preserve_fixations);
+                    };
+                    if (o.gcint)
+                        {
+                            simplify();
+                        }
+                    else
+                        {
+                            scheduler.timed_simplification(tables, simplify);
+                        }
                     if (!o.preserve_fixations)
                         {
                             genetics.mutation_recycling_bin
@@ -359,4 +376,5 @@ main(int argc, char **argv)
     execute_serialization_test(o, tables);
 	visit_sites_test(o, pop, tables, s);
     write_sfs(o, rng, tables, s);
+    write_gc_report(o, scheduler);
 }
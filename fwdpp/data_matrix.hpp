@@ -141,6 +141,9 @@ namespace fwdpp
      * the frequencies are summed, all using standard C++.
      *
      * \ingroup samplingPops
+     * \version 0.10.0 Counts are kept in a vector indexed by key rather
+     * than in a hash table.  Keys are returned in the order in which they
+     * are first found in the sample.
      */
     {
         return data_matrix_details::mutation_keys(
@@ -190,7 +193,8 @@ namespace fwdpp
     data_matrix
     genotype_matrix(const poptype &pop, const std::vector<std::size_t> &individuals,
                     const std::vector<std::pair<std::size_t, uint_t>> &neutral_keys,
-                    const std::vector<std::pair<std::size_t, uint_t>> &selected_keys)
+                    const std::vector<std::pair<std::size_t, uint_t>> &selected_keys,
+                    const unsigned num_threads = 1)
     /*!
      * Calculate a fwdpp::data_matrix representing genotypes encoded as
      * 0,1, or 2 copies of the derived mutation.
@@ -200,22 +204,26 @@ namespace fwdpp
      * sample.
      * \param neutral_keys See documentation of fwdpp::mutation_keys
      * \param selected_keys See documentation of fwdpp::mutation_keys
+     * \param num_threads Number of threads over which to divide individuals
      *
      * \return fwdpp::data_matrix
      *
      * \ingroup samplingPops
+     * \version 0.10.0 Each haploid genome is read once, rather than
+     * searched for each mutation.  Added \a num_threads.
      */
     {
         return data_matrix_details::fill_matrix(
             pop, individuals, neutral_keys, selected_keys,
-            data_matrix_details::matrix_type::genotype);
+            data_matrix_details::matrix_type::genotype, num_threads);
     }
 
     template <typename poptype>
     data_matrix
     haplotype_matrix(const poptype &pop, const std::vector<std::size_t> &individuals,
                      const std::vector<std::pair<std::size_t, uint_t>> &neutral_keys,
-                     const std::vector<std::pair<std::size_t, uint_t>> &selected_keys)
+                     const std::vector<std::pair<std::size_t, uint_t>> &selected_keys,
+                     const unsigned num_threads = 1)
     /*!
      * Calculate a fwdpp::data_matrix representing haplotypes encoded as
      * 0 or 1 copies of the derived mutation.
@@ -225,15 +233,18 @@ namespace fwdpp
      * sample.
      * \param neutral_keys See documentation of fwdpp::mutation_keys
      * \param selected_keys See documentation of fwdpp::mutation_keys
+     * \param num_threads Number of threads over which to divide individuals
      *
      * \return fwdpp::data_matrix
      *
      * \ingroup samplingPops
+     * \version 0.10.0 Each haploid genome is read once, rather than
+     * searched for each mutation.  Added \a num_threads.
      */
     {
         return data_matrix_details::fill_matrix(
             pop, individuals, neutral_keys, selected_keys,
-            data_matrix_details::matrix_type::haplotype);
+            data_matrix_details::matrix_type::haplotype, num_threads);
     }
 
     inline std::pair<std::vector<std::uint32_t>, std::vector<std::uint32_t>>
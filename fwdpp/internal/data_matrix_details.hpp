@@ -6,9 +6,11 @@
 #include <iterator>
 #include <numeric>
 #include <vector>
-#include <unordered_map>
+#include <limits>
+#include <algorithm>
 #include <fwdpp/fundamental_types/typedefs.hpp>
 #include <fwdpp/debug.hpp>
+#include <fwdpp/internal/run_in_threads.hpp>
 
 /*
  * This header is not meant to be included directly.
@@ -26,22 +28,20 @@ namespace fwdpp
 
         template <typename mutation_key_container>
         void
-        update_mutation_keys(std::unordered_map<std::size_t, uint_t> &keys,
+        update_mutation_keys(std::vector<uint_t> &counts,
+                             std::vector<std::pair<std::size_t, uint_t>> &keys,
                              const mutation_key_container &a,
                              const std::vector<uint_t> &mcounts)
+        // counts is indexed by mutation key.  A key is added to keys
+        // the first time that it is seen.
         {
             for (auto &&ai : a)
                 {
                     if (mcounts[ai])
                         {
-                            auto k = keys.find(ai);
-                            if (k == keys.end())
+                            if (counts[ai]++ == 0)
                                 {
-                                    keys.emplace(ai, 1);
-                                }
-                            else
-                                {
-                                    k->second++;
+                                    keys.emplace_back(ai, 0);
                                 }
                         }
                 }
@@ -56,28 +56,40 @@ namespace fwdpp
                       const std::vector<uint_t> &mcounts, const bool include_neutral,
                       const bool include_selected, poptypes::DIPLOID_TAG)
         {
-            std::unordered_map<std::size_t, uint_t> n, s;
+            std::vector<uint_t> n(include_neutral ? mcounts.size() : 0, 0),
+                s(include_selected ? mcounts.size() : 0, 0);
+            std::vector<std::pair<std::size_t, uint_t>> neutral, selected;
             for (auto &&ind : individuals)
                 {
                     auto &dip = diploids[ind];
                     if (include_neutral)
                         {
-                            update_mutation_keys(n, haploid_genomes[dip.first].mutations,
+                            update_mutation_keys(n, neutral,
+                                                 haploid_genomes[dip.first].mutations,
+                                                 mcounts);
+                            update_mutation_keys(n, neutral,
+                                                 haploid_genomes[dip.second].mutations,
                                                  mcounts);
-                            update_mutation_keys(
-                                n, haploid_genomes[dip.second].mutations, mcounts);
                         }
                     if (include_selected)
                         {
-                            update_mutation_keys(
-                                s, haploid_genomes[dip.first].smutations, mcounts);
-                            update_mutation_keys(
-                                s, haploid_genomes[dip.second].smutations, mcounts);
+                            update_mutation_keys(s, selected,
+                                                 haploid_genomes[dip.first].smutations,
+                                                 mcounts);
+                            update_mutation_keys(s, selected,
+                                                 haploid_genomes[dip.second].smutations,
+                                                 mcounts);
                         }
                 }
-            return std::make_pair(
-                std::vector<std::pair<std::size_t, uint_t>>(n.begin(), n.end()),
-                std::vector<std::pair<std::size_t, uint_t>>(s.begin(), s.end()));
+            for (auto &k : neutral)
+                {
+                    k.second = n[k.first];
+                }
+            for (auto &k : selected)
+                {
+                    k.second = s[k.first];
+                }
+            return std::make_pair(std::move(neutral), std::move(selected));
         }
 
         template <typename MutationContainerType, typename key_container>
@@ -91,26 +103,136 @@ namespace fwdpp
                 }
         }
 
-        template <typename mutation_key_container>
+        template <typename F>
+        inline void
+        run_over_individuals(const std::size_t nind, unsigned num_threads,
+                             const std::size_t alignment, const F &f)
+        // Call f(first, last) for ranges of individuals, in parallel.
+        // The first exception thrown by f is rethrown here.
+        // All ranges but the last have a multiple of alignment individuals,
+        // so that no two threads write to the same word of a packed matrix.
+        {
+            const auto nblocks = (nind + alignment - 1) / alignment;
+            num_threads = static_cast<unsigned>(
+                std::max<std::size_t>(1, std::min<std::size_t>(num_threads, nblocks)));
+            const auto boundary = [nind, nblocks, num_threads, alignment](unsigned t) {
+                return std::min(nind, nblocks * t / num_threads * alignment);
+            };
+            fwdpp_internal::run_in_threads(num_threads, [&f, &boundary](unsigned t) {
+                f(boundary(t), boundary(t + 1));
+            });
+        }
+
+        template <typename poptype, typename GenomeKeys, typename SetEntry>
+        void
+        fill_rows(const poptype &pop, const std::vector<std::size_t> &individuals,
+                  const std::vector<std::pair<std::size_t, uint_t>> &keys,
+                  GenomeKeys genome_keys,
+                  unsigned num_threads, std::size_t alignment, const SetEntry &set_entry)
+        // Rather than searching each haploid genome for each key, look
+        // up the row of each mutation in each haploid genome.  set_entry(row,
+        // individual, haplotype) is called for each (individual, mutation)
+        // pair, with haplotype 0 or 1.
+        {
+            constexpr auto not_sampled = std::numeric_limits<std::size_t>::max();
+            std::vector<std::size_t> row_of_key(pop.mutations.size(), not_sampled);
+            for (std::size_t r = 0; r < keys.size(); ++r)
+                {
+                    if (keys[r].first >= row_of_key.size())
+                        {
+                            throw std::out_of_range("mutation key out of range");
+                        }
+                    if (row_of_key[keys[r].first] == not_sampled)
+                        {
+                            row_of_key[keys[r].first] = r;
+                        }
+                }
+            run_over_individuals(
+                individuals.size(), num_threads, alignment,
+                [&](std::size_t first, std::size_t last) {
+                    for (auto i = first; i < last; ++i)
+                        {
+                            const auto &dip = pop.diploids[individuals[i]];
+                            for (int h = 0; h < 2; ++h)
+                                {
+                                    const auto &g
+                                        = pop.haploid_genomes[h == 0 ? dip.first
+                                                                     : dip.second];
+                                    for (auto key : g.*genome_keys)
+                                        {
+                                            const auto r = row_of_key[key];
+                                            if (r != not_sampled)
+                                                {
+                                                    set_entry(r, i, h);
+                                                }
+                                        }
+                                }
+                        }
+                });
+        }
+
+        template <typename T>
+        void
+        copy_repeated_rows(const std::vector<std::pair<std::size_t, uint_t>> &keys,
+                           const std::size_t row_length, std::vector<T> &data)
+        // fill_rows only fills the first row for each key.  A key
+        // listed more than once gets copies of that row.
+        {
+            if (keys.size() < 2)
+                {
+                    return;
+                }
+            std::size_t max_key = 0;
+            for (auto &k : keys)
+                {
+                    max_key = std::max(max_key, k.first);
+                }
+            constexpr auto not_seen = std::numeric_limits<std::size_t>::max();
+            std::vector<std::size_t> first_row(max_key + 1, not_seen);
+            for (std::size_t r = 0; r < keys.size(); ++r)
+                {
+                    auto &q = first_row[keys[r].first];
+                    if (q == not_seen)
+                        {
+                            q = r;
+                        }
+                    else
+                        {
+                            std::copy(data.begin() + q * row_length,
+                                      data.begin() + (q + 1) * row_length,
+                                      data.begin() + r * row_length);
+                        }
+                }
+        }
+
+        template <typename poptype, typename GenomeKeys>
         void
-        update_site(const mutation_key_container &first,
-                    const mutation_key_container &second, std::vector<std::int8_t> &site,
-                    const std::pair<std::size_t, uint_t> &mutation_record,
-                    const matrix_type mtype)
+        fill_state_matrix(const poptype &pop, const std::vector<std::size_t> &individuals,
+                          const std::vector<std::pair<std::size_t, uint_t>> &keys,
+                          GenomeKeys genome_keys,
+                          const std::size_t ncol, const matrix_type mtype,
+                          const unsigned num_threads, std::vector<std::int8_t> &data,
+                          std::vector<std::size_t> &matrix_keys)
         {
-            int onfirst = (std::find(first.begin(), first.end(), mutation_record.first)
-                           != first.end());
-            int onsecond
-                = (std::find(second.begin(), second.end(), mutation_record.first)
-                   != second.end());
+            data.assign(keys.size() * ncol, 0);
             if (mtype == matrix_type::genotype)
                 {
-                    site.push_back(onfirst + onsecond);
+                    fill_rows(pop, individuals, keys, genome_keys, num_threads, 1,
+                              [&data, ncol](std::size_t r, std::size_t i, int) {
+                                  ++data[r * ncol + i];
+                              });
                 }
             else
                 {
-                    site.push_back(onfirst);
-                    site.push_back(onsecond);
+                    fill_rows(pop, individuals, keys, genome_keys, num_threads, 1,
+                              [&data, ncol](std::size_t r, std::size_t i, int h) {
+                                  data[r * ncol + 2 * i + h] = 1;
+                              });
+                }
+            copy_repeated_rows(keys, ncol, data);
+            for (auto &k : keys)
+                {
+                    matrix_keys.push_back(k.first);
                 }
         }
 
@@ -120,30 +242,15 @@ namespace fwdpp
                     const std::vector<std::size_t> &individuals,
                     const std::vector<std::pair<std::size_t, uint_t>> &neutral_keys,
                     const std::vector<std::pair<std::size_t, uint_t>> &selected_keys,
-                    poptypes::DIPLOID_TAG, matrix_type mtype)
+                    poptypes::DIPLOID_TAG, matrix_type mtype, unsigned num_threads)
         {
-            for (auto &&mkey : neutral_keys)
-                {
-                    for (auto &ind : individuals)
-                        {
-                            update_site(
-                                pop.haploid_genomes[pop.diploids[ind].first].mutations,
-                                pop.haploid_genomes[pop.diploids[ind].second].mutations,
-                                m.neutral.data, mkey, mtype);
-                        }
-                    m.neutral_keys.push_back(mkey.first);
-                }
-            for (auto &&mkey : selected_keys)
-                {
-                    for (auto &ind : individuals)
-                        {
-                            update_site(
-                                pop.haploid_genomes[pop.diploids[ind].first].smutations,
-                                pop.haploid_genomes[pop.diploids[ind].second].smutations,
-                                m.selected.data, mkey, mtype);
-                        }
-                    m.selected_keys.push_back(mkey.first);
-                }
+            using genome_type = typename poptype::haploid_genome_type;
+            fill_state_matrix(pop, individuals, neutral_keys, &genome_type::mutations,
+                              m.ncol, mtype, num_threads, m.neutral.data,
+                              m.neutral_keys);
+            fill_state_matrix(pop, individuals, selected_keys, &genome_type::smutations,
+                              m.ncol, mtype, num_threads, m.selected.data,
+                              m.selected_keys);
             // fill out other data fields
             update_pos(pop.mutations, neutral_keys, m.neutral);
             update_pos(pop.mutations, selected_keys, m.selected);
@@ -154,13 +261,13 @@ namespace fwdpp
         fill_matrix(const poptype &pop, const std::vector<std::size_t> &individuals,
                     const std::vector<std::pair<std::size_t, uint_t>> &neutral_keys,
                     const std::vector<std::pair<std::size_t, uint_t>> &selected_keys,
-                    const matrix_type mtype)
+                    const matrix_type mtype, const unsigned num_threads)
         {
             data_matrix rv((mtype == matrix_type::genotype) ? individuals.size()
                                                             : 2 * individuals.size());
             // dispatch details out depending on population type
             fill_matrix(pop, rv, individuals, neutral_keys, selected_keys,
-                        typename poptype::popmodel_t(), mtype);
+                        typename poptype::popmodel_t(), mtype, num_threads);
             return rv;
         }
 
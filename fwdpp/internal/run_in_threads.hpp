@@ -0,0 +1,85 @@
+#ifndef FWDPP_INTERNAL_RUN_IN_THREADS_HPP
+#define FWDPP_INTERNAL_RUN_IN_THREADS_HPP
+
+#include <vector>
+#include <thread>
+#include <exception>
+
+namespace fwdpp
+{
+    namespace fwdpp_internal
+    {
+        struct thread_join_guard
+        /// Join threads on destruction, so that an exception
+        /// thrown while starting threads does not destroy
+        /// joinable std::thread objects.
+        {
+            std::vector<std::thread> threads;
+
+            thread_join_guard() : threads{}
+            {
+            }
+
+            thread_join_guard(const thread_join_guard&) = delete;
+            thread_join_guard& operator=(const thread_join_guard&) = delete;
+
+            void
+            join()
+            {
+                for (auto& t : threads)
+                    {
+                        if (t.joinable())
+                            {
+                                t.join();
+                            }
+                    }
+            }
+
+            ~thread_join_guard()
+            {
+                join();
+            }
+        };
+
+        template <typename F>
+        inline void
+        run_in_threads(unsigned num_threads, const F& f)
+        /// Call f(0), ..., f(num_threads - 1), with
+        /// all but the first on separate threads.
+        /// The first exception thrown by any call is
+        /// rethrown after all threads have finished.
+        /// If a thread cannot be started, the threads
+        /// already started are joined before the
+        /// exception propagates.
+        {
+            std::vector<std::exception_ptr> errors(num_threads);
+            auto call = [&f, &errors](unsigned t) {
+                try
+                    {
+                        f(t);
+                    }
+                catch (...)
+                    {
+                        errors[t] = std::current_exception();
+                    }
+            };
+            thread_join_guard guard;
+            guard.threads.reserve(num_threads);
+            for (unsigned t = 1; t < num_threads; ++t)
+                {
+                    guard.threads.emplace_back(call, t);
+                }
+            call(0);
+            guard.join();
+            for (auto& e : errors)
+                {
+                    if (e)
+                        {
+                            std::rethrow_exception(e);
+                        }
+                }
+        }
+    } // namespace fwdpp_internal
+} // namespace fwdpp
+
+#endif
@@ -0,0 +1,331 @@
+#ifndef FWDPP_PACKED_DATA_MATRIX_HPP_
+#define FWDPP_PACKED_DATA_MATRIX_HPP_
+
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include <fwdpp/forward_types.hpp>
+#include <fwdpp/data_matrix.hpp>
+
+namespace fwdpp
+{
+    namespace data_matrix_details
+    {
+        inline unsigned
+        popcount(std::uint64_t x)
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return static_cast<unsigned>(__builtin_popcountll(x));
+#else
+            x = x - ((x >> 1) & 0x5555555555555555ULL);
+            x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+            x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+            return static_cast<unsigned>((x * 0x0101010101010101ULL) >> 56);
+#endif
+        }
+    } // namespace data_matrix_details
+
+    struct packed_state_matrix
+    /*! \brief Bit-packed haplotype matrix
+     *
+     * Like fwdpp::state_matrix, rows are sites and columns are
+     * haplotypes, but each entry is a single bit: 0 for the ancestral
+     * state and 1 otherwise.  Each row is stored as words_per_row()
+     * 64-bit words, with column j in bit j % 64 of word j / 64.
+     * Unused bits at the end of a row are always 0.
+     *
+     * This takes one eighth of the memory of fwdpp::state_matrix,
+     * and allele counts and linkage disequilibrium reduce to
+     * population counts of words.  See fwdpp::allele_counts
+     * and fwdpp::pairwise_ld.
+     *
+     * \note This type is not constructed directly, but rather returned
+     * by other functions.
+     *
+     * \ingroup samplingPops
+     * \version 0.10.0 Added to library
+     */
+    {
+        //! The state data
+        std::vector<std::uint64_t> data;
+        //! Positions of variable sites
+        std::vector<double> positions;
+        //! Number of columns in the matrix
+        std::size_t ncol;
+
+        explicit packed_state_matrix(const std::size_t ncol_)
+            : data(), positions(), ncol(ncol_)
+        {
+        }
+
+        std::size_t
+        words_per_row() const
+        {
+            return (ncol + 63) / 64;
+        }
+
+        std::size_t
+        nrow() const
+        {
+            return positions.size();
+        }
+
+        const std::uint64_t *
+        row(const std::size_t i) const
+        {
+            return data.data() + i * words_per_row();
+        }
+
+        bool
+        get(const std::size_t i, const std::size_t j) const
+        {
+            return (row(i)[j / 64] >> (j % 64)) & 1;
+        }
+
+        template <typename Iterator, typename F>
+        void
+        push_back_row(const double position, Iterator first, Iterator last, F is_set)
+        /// Append a row for the site at \a position, with column j set
+        /// if is_set is true for element j of [first, last).
+        {
+            if (static_cast<std::size_t>(std::distance(first, last)) != ncol)
+                {
+                    throw std::invalid_argument("row length does not equal ncol");
+                }
+            while (first != last)
+                {
+                    std::uint64_t word = 0;
+                    for (std::size_t bit = 0; bit < 64 && first != last; ++bit, ++first)
+                        {
+                            word |= static_cast<std::uint64_t>(is_set(*first) ? 1 : 0)
+                                    << bit;
+                        }
+                    data.push_back(word);
+                }
+            positions.push_back(position);
+        }
+    };
+
+    struct packed_data_matrix
+    /*!
+     * \brief Bit-packed haplotype matrix.
+     *
+     * The packed counterpart of fwdpp::data_matrix.  Data for
+     * neutral and selected variants, respectively are stored as
+     * packed_state_matrix objects.
+     *
+     * \ingroup samplingPops
+     * \version 0.10.0 Added to library
+     */
+    {
+        //! Data for neutral mutations.
+        packed_state_matrix neutral;
+        //! Data for selected mutations.
+        packed_state_matrix selected;
+        //! Locations of neutral mutations from mutation vector.  Same order
+        //! as matrix row order
+        std::vector<std::size_t> neutral_keys;
+        //! Locations of selected mutations from mutation vector.  Same order
+        //! as matrix row order
+        std::vector<std::size_t> selected_keys;
+        //! Number of columns in the matrix
+        std::size_t ncol;
+        explicit packed_data_matrix(const std::size_t ncol_)
+            : neutral(ncol_), selected(ncol_), neutral_keys{}, selected_keys{},
+              ncol{ncol_}
+        {
+        }
+    };
+
+    struct linkage_disequilibrium
+    /// Return value of fwdpp::pairwise_ld
+    /// \version 0.10.0 Added to library
+    {
+        //! p_AB - p_A * p_B
+        double D;
+        //! D^2 / (p_A * (1 - p_A) * p_B * (1 - p_B)).  NaN if either site is fixed.
+        double rsq;
+    };
+
+    inline std::vector<std::uint32_t>
+    allele_counts(const packed_state_matrix &m)
+    /*!
+     * The number of derived states at each site, which are
+     * the row sums of the matrix.
+     *
+     * \ingroup samplingPops
+     * \version 0.10.0 Added to library
+     */
+    {
+        std::vector<std::uint32_t> rv(m.nrow());
+        const auto W = m.words_per_row();
+        for (std::size_t i = 0; i < rv.size(); ++i)
+            {
+                const auto *r = m.row(i);
+                std::uint32_t sum = 0;
+                for (std::size_t w = 0; w < W; ++w)
+                    {
+                        sum += data_matrix_details::popcount(r[w]);
+                    }
+                rv[i] = sum;
+            }
+        return rv;
+    }
+
+    inline std::pair<std::vector<std::uint32_t>, std::vector<std::uint32_t>>
+    row_sums(const packed_data_matrix &m)
+    /*!
+     * Calculate the row sums of a fwdpp::packed_data_matrix
+     *
+     * \return A pair of vectors of unsigned integers representing row sums
+     * for neutral and selected sites in the matrix, respectively.
+     *
+     * \ingroup samplingPops
+     * \version 0.10.0 Added to library
+     */
+    {
+        return std::make_pair(allele_counts(m.neutral), allele_counts(m.selected));
+    }
+
+    inline linkage_disequilibrium
+    pairwise_ld(const packed_state_matrix &m, const std::size_t i, const std::size_t j)
+    /*!
+     * Linkage disequilibrium between the sites in rows \a i and \a j,
+     * from the counts of derived states at each site and at both.
+     *
+     * \ingroup samplingPops
+     * \version 0.10.0 Added to library
+     */
+    {
+        if (i >= m.nrow() || j >= m.nrow())
+            {
+                throw std::out_of_range("row index out of range");
+            }
+        if (m.ncol == 0)
+            {
+                throw std::invalid_argument("matrix has no columns");
+            }
+        const auto W = m.words_per_row();
+        const auto *a = m.row(i);
+        const auto *b = m.row(j);
+        unsigned na = 0, nb = 0, nab = 0;
+        for (std::size_t w = 0; w < W; ++w)
+            {
+                na += data_matrix_details::popcount(a[w]);
+                nb += data_matrix_details::popcount(b[w]);
+                nab += data_matrix_details::popcount(a[w] & b[w]);
+            }
+        const double n = static_cast<double>(m.ncol);
+        const double pa = na / n, pb = nb / n;
+        const double D = nab / n - pa * pb;
+        const double denom = pa * (1. - pa) * pb * (1. - pb);
+        return linkage_disequilibrium{D, denom > 0. ? D * D / denom : std::nan("")};
+    }
+
+    inline state_matrix
+    unpack(const packed_state_matrix &m)
+    /*!
+     * Convert to a fwdpp::state_matrix with a 0/1 encoding.
+     *
+     * \ingroup samplingPops
+     * \version 0.10.0 Added to library
+     */
+    {
+        std::vector<std::int8_t> data;
+        data.reserve(m.nrow() * m.ncol);
+        for (std::size_t i = 0; i < m.nrow(); ++i)
+            {
+                for (std::size_t j = 0; j < m.ncol; ++j)
+                    {
+                        data.push_back(m.get(i, j));
+                    }
+            }
+        return state_matrix(std::move(data), m.positions);
+    }
+
+    namespace data_matrix_details
+    {
+        template <typename poptype, typename GenomeKeys>
+        void
+        fill_packed_state_matrix(const poptype &pop,
+                                 const std::vector<std::size_t> &individuals,
+                                 const std::vector<std::pair<std::size_t, uint_t>> &keys,
+                                 GenomeKeys genome_keys, const unsigned num_threads,
+                                 packed_state_matrix &sm,
+                                 std::vector<std::size_t> &matrix_keys)
+        {
+            const auto W = sm.words_per_row();
+            sm.data.assign(keys.size() * W, 0);
+            // Threads get multiples of 32 individuals, which are
+            // whole words, so that no two threads write to one word.
+            fill_rows(pop, individuals, keys, genome_keys, num_threads, 32,
+                      [&sm, W](std::size_t r, std::size_t i, int h) {
+                          const auto j = 2 * i + h;
+                          sm.data[r * W + j / 64] |= std::uint64_t{1} << (j % 64);
+                      });
+            copy_repeated_rows(keys, W, sm.data);
+            for (auto &k : keys)
+                {
+                    sm.positions.push_back(pop.mutations[k.first].pos);
+                    matrix_keys.push_back(k.first);
+                }
+        }
+
+        template <typename poptype>
+        void
+        fill_packed_matrix(const poptype &pop, packed_data_matrix &m,
+                           const std::vector<std::size_t> &individuals,
+                           const std::vector<std::pair<std::size_t, uint_t>> &neutral_keys,
+                           const std::vector<std::pair<std::size_t, uint_t>> &selected_keys,
+                           poptypes::DIPLOID_TAG, const unsigned num_threads)
+        {
+            using genome_type = typename poptype::haploid_genome_type;
+            fill_packed_state_matrix(pop, individuals, neutral_keys,
+                                     &genome_type::mutations, num_threads, m.neutral,
+                                     m.neutral_keys);
+            fill_packed_state_matrix(pop, individuals, selected_keys,
+                                     &genome_type::smutations, num_threads, m.selected,
+                                     m.selected_keys);
+        }
+    } // namespace data_matrix_details
+
+    template <typename poptype>
+    packed_data_matrix
+    packed_haplotype_matrix(
+        const poptype &pop, const std::vector<std::size_t> &individuals,
+        const std::vector<std::pair<std::size_t, uint_t>> &neutral_keys,
+        const std::vector<std::pair<std::size_t, uint_t>> &selected_keys,
+        const unsigned num_threads = 1)
+    /*!
+     * Calculate a fwdpp::packed_data_matrix representing haplotypes.
+     * The matrix has the same rows and columns as that returned by
+     * fwdpp::haplotype_matrix.
+     *
+     * \param pop The population
+     * \param individuals The indexes of individuals in \a pop forming the
+     * sample.
+     * \param neutral_keys See documentation of fwdpp::mutation_keys
+     * \param selected_keys See documentation of fwdpp::mutation_keys
+     * \param num_threads Number of threads over which to divide individuals
+     *
+     * \return fwdpp::packed_data_matrix
+     *
+     * \ingroup samplingPops
+     * \version 0.10.0 Added to library
+     */
+    {
+        packed_data_matrix rv(2 * individuals.size());
+        data_matrix_details::fill_packed_matrix(pop, rv, individuals, neutral_keys,
+                                                selected_keys,
+                                                typename poptype::popmodel_t(),
+                                                num_threads);
+        return rv;
+    }
+} // namespace fwdpp
+
+#endif
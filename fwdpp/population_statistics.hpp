@@ -0,0 +1,144 @@
+#ifndef FWDPP_POPULATION_STATISTICS_HPP_
+#define FWDPP_POPULATION_STATISTICS_HPP_
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <stdexcept>
+#include <fwdpp/fundamental_types/typedefs.hpp>
+#include <fwdpp/poptypes/tags.hpp>
+
+namespace fwdpp
+{
+    struct summary_statistics
+    /*! \brief Summary statistics of one class of mutations
+     *
+     * \ingroup samplingPops
+     * \version 0.10.0 Added to library
+     */
+    {
+        //! Element i is the number of mutations present in i
+        //! haploid genomes, for i = 0, ..., n.  Element 0 is always 0.
+        std::vector<std::uint32_t> sfs;
+        //! Sum over segregating mutations of 2c(n - c)/(n(n - 1)),
+        //! where c is the number of copies of a mutation.
+        double theta_pi;
+        //! Number of mutations with 0 < c < n
+        std::uint32_t segregating_sites;
+
+        summary_statistics() : sfs{}, theta_pi{0.}, segregating_sites{0} {}
+    };
+
+    struct population_summary
+    /*! \brief Summary statistics of an entire population
+     *
+     * Filled by fwdpp::population_summary_statistics.  Objects of
+     * this type are meant to be reused, so that no memory is
+     * allocated after the first call for a population whose size
+     * does not change.
+     *
+     * \ingroup samplingPops
+     * \version 0.10.0 Added to library
+     */
+    {
+        //! Number of haploid genomes in the population, n
+        std::size_t sample_size;
+        //! Statistics for neutral mutations
+        summary_statistics neutral;
+        //! Statistics for selected mutations
+        summary_statistics selected;
+
+        population_summary() : sample_size{0}, neutral{}, selected{} {}
+    };
+
+    namespace fwdpp_internal
+    {
+        template <typename poptype>
+        inline std::size_t
+        num_haploid_genomes(const poptype &pop, poptypes::DIPLOID_TAG)
+        {
+            return 2 * pop.diploids.size();
+        }
+    } // namespace fwdpp_internal
+
+    template <typename poptype>
+    void
+    population_summary_statistics(const poptype &pop, population_summary &summary)
+    /*!
+     * \brief Site frequency spectrum, theta_pi and number of segregating
+     * sites for the entire population.
+     *
+     * The statistics are calculated from pop.mcounts in a single pass
+     * over the mutations, without building a fwdpp::data_matrix.
+     * Mutations with a count of 0, such as those waiting to be
+     * recycled, are ignored.  Fixed mutations still in
+     * pop.mutations are counted in the last element of each
+     * spectrum, but are not segregating.
+     *
+     * \param pop A population
+     * \param summary Output.  Previous contents are overwritten.
+     *
+     * \throw std::invalid_argument if pop.mcounts and pop.mutations
+     * differ in size or if a count exceeds the number of haploid
+     * genomes.
+     *
+     * \ingroup samplingPops
+     * \version 0.10.0 Added to library
+     */
+    {
+        if (pop.mcounts.size() != pop.mutations.size())
+            {
+                throw std::invalid_argument(
+                    "mutation counts size must equal mutation container size");
+            }
+        const auto n = fwdpp_internal::num_haploid_genomes(
+            pop, typename poptype::popmodel_t());
+        summary.sample_size = n;
+        for (auto s : {&summary.neutral, &summary.selected})
+            {
+                s->sfs.assign(n + 1, 0);
+                s->theta_pi = 0.;
+                s->segregating_sites = 0;
+            }
+        // Only used when 0 < c < n, which means that n > 1
+        const double denom = static_cast<double>(n) * static_cast<double>(n - 1);
+        for (std::size_t i = 0; i < pop.mcounts.size(); ++i)
+            {
+                const auto c = pop.mcounts[i];
+                if (c == 0)
+                    {
+                        continue;
+                    }
+                if (c > n)
+                    {
+                        throw std::invalid_argument("mutation count out of range");
+                    }
+                auto &s = pop.mutations[i].neutral ? summary.neutral : summary.selected;
+                ++s.sfs[c];
+                if (c < n)
+                    {
+                        ++s.segregating_sites;
+                        s.theta_pi += 2. * static_cast<double>(c)
+                                      * static_cast<double>(n - c) / denom;
+                    }
+            }
+    }
+
+    template <typename poptype>
+    population_summary
+    population_summary_statistics(const poptype &pop)
+    /*!
+     * \brief Convenience overload returning a new
+     * fwdpp::population_summary.
+     *
+     * \ingroup samplingPops
+     * \version 0.10.0 Added to library
+     */
+    {
+        population_summary rv;
+        population_summary_statistics(pop, rv);
+        return rv;
+    }
+} // namespace fwdpp
+
+#endif
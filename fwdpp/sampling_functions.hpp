@@ -12,6 +12,7 @@
 #include <gsl/gsl_randist.h>
 #include <fwdpp/type_traits.hpp>
 #include <fwdpp/data_matrix.hpp>
+#include <fwdpp/packed_data_matrix.hpp>
 #include "internal/sampling_functions_details.hpp"
 
 /*! @defgroup samplingPops Functions related to taking samples from simulated
@@ -25,7 +26,7 @@ namespace fwdpp
     sample_individuals(const poptype &pop,
                        const std::vector<std::size_t> &individuals,
                        const bool include_neutral, const bool include_selected,
-                       const bool remove_fixed)
+                       const bool remove_fixed, const unsigned num_threads = 1)
     /*!
      * \brief Create a fwdpp::data_matrix for a set of individuals.
      *
@@ -34,17 +35,42 @@ namespace fwdpp
      * \param include_neutral If true, populate fwdpp::data_matrix::neutral
      * \param include_selected If true, populate fwdpp::data_matrix::selected
      * \param remove_fixed If true, remove variants that are fixed in the sample.
+     * \param num_threads Number of threads over which to divide individuals
      *
      * \return fwdpp::data_matrix
      *
      * \note The return value is a haplotype matrix.
      *
      * \ingroup samplingPops
+     * \version 0.10.0 Added \a num_threads
      */
     {
         auto keys = fwdpp_internal::generate_filter_sort_keys(
             pop, individuals, include_neutral, include_selected, remove_fixed);
-        return haplotype_matrix(pop, individuals, keys.first, keys.second);
+        return haplotype_matrix(pop, individuals, keys.first, keys.second,
+                                num_threads);
+    }
+
+    template <typename poptype>
+    packed_data_matrix
+    sample_individuals_packed(const poptype &pop,
+                              const std::vector<std::size_t> &individuals,
+                              const bool include_neutral, const bool include_selected,
+                              const bool remove_fixed, const unsigned num_threads = 1)
+    /*!
+     * \brief Create a fwdpp::packed_data_matrix for a set of individuals.
+     *
+     * The parameters and the rows and columns of the return value are
+     * the same as for fwdpp::sample_individuals.
+     *
+     * \ingroup samplingPops
+     * \version 0.10.0 Added to library
+     */
+    {
+        auto keys = fwdpp_internal::generate_filter_sort_keys(
+            pop, individuals, include_neutral, include_selected, remove_fixed);
+        return packed_haplotype_matrix(pop, individuals, keys.first, keys.second,
+                                       num_threads);
     }
 }
 #endif
@@ -0,0 +1,169 @@
+#ifndef FWDPP_SPARSE_DATA_MATRIX_HPP_
+#define FWDPP_SPARSE_DATA_MATRIX_HPP_
+
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <fwdpp/data_matrix.hpp>
+
+namespace fwdpp
+{
+    struct sparse_state_matrix
+    /*! \brief Compressed sparse row (CSR) matrix of mutations
+     *
+     * Rows are sites and columns are samples, as for fwdpp::state_matrix,
+     * but only entries that differ from the ancestral state are stored.
+     * The entries of row i are columns[k] and states[k] for k in
+     * [row_offsets[i], row_offsets[i + 1]), with columns in increasing
+     * order.  row_offsets has one more element than there are rows.
+     *
+     * Memory use is proportional to the number of derived alleles
+     * rather than to the number of sites times the number of samples,
+     * which suits samples in which most variants are rare.
+     *
+     * \note This type is not constructed directly, but rather returned
+     * by other functions.
+     *
+     * \ingroup samplingPops
+     * \version 0.10.0 Added to library
+     */
+    {
+        //! Start of each row in columns and states, plus the end of the last row
+        std::vector<std::size_t> row_offsets;
+        //! Column (sample) index of each entry
+        std::vector<std::uint32_t> columns;
+        //! State of each entry
+        std::vector<std::int8_t> states;
+        //! Positions of variable sites
+        std::vector<double> positions;
+        //! Number of columns in the matrix
+        std::size_t ncol;
+
+        explicit sparse_state_matrix(const std::size_t ncol_)
+            : row_offsets(1, 0), columns(), states(), positions(), ncol(ncol_)
+        {
+        }
+
+        std::size_t
+        nrow() const
+        {
+            return positions.size();
+        }
+
+        std::size_t
+        row_size(const std::size_t i) const
+        {
+            return row_offsets[i + 1] - row_offsets[i];
+        }
+
+        void
+        push_back_row(const double position,
+                      const std::vector<std::pair<std::uint32_t, std::int8_t>> &entries)
+        /// Append a row for the site at \a position.  \a entries are
+        /// (column, state) pairs, sorted by column.
+        {
+            for (auto &e : entries)
+                {
+                    if (e.first >= ncol)
+                        {
+                            throw std::out_of_range("column index out of range");
+                        }
+                    columns.push_back(e.first);
+                    states.push_back(e.second);
+                }
+            row_offsets.push_back(columns.size());
+            positions.push_back(position);
+        }
+    };
+
+    struct sparse_data_matrix
+    /*!
+     * \brief Sparse genotype or haplotype matrix.
+     *
+     * The sparse counterpart of fwdpp::data_matrix.  Data for
+     * neutral and selected variants, respectively are stored as
+     * sparse_state_matrix objects.
+     *
+     * \ingroup samplingPops
+     * \version 0.10.0 Added to library
+     */
+    {
+        //! Data for neutral mutations.
+        sparse_state_matrix neutral;
+        //! Data for selected mutations.
+        sparse_state_matrix selected;
+        //! Locations of neutral mutations from mutation vector.  Same order
+        //! as matrix row order
+        std::vector<std::size_t> neutral_keys;
+        //! Locations of selected mutations from mutation vector.  Same order
+        //! as matrix row order
+        std::vector<std::size_t> selected_keys;
+        //! Number of columns in the matrix
+        std::size_t ncol;
+        explicit sparse_data_matrix(const std::size_t ncol_)
+            : neutral(ncol_), selected(ncol_), neutral_keys{}, selected_keys{},
+              ncol{ncol_}
+        {
+        }
+    };
+
+    inline std::vector<std::uint32_t>
+    allele_counts(const sparse_state_matrix &m)
+    /*!
+     * The number of entries that differ from the ancestral
+     * state at each site.
+     *
+     * \ingroup samplingPops
+     * \version 0.10.0 Added to library
+     */
+    {
+        std::vector<std::uint32_t> rv(m.nrow());
+        for (std::size_t i = 0; i < rv.size(); ++i)
+            {
+                rv[i] = static_cast<std::uint32_t>(m.row_size(i));
+            }
+        return rv;
+    }
+
+    inline std::pair<std::vector<std::uint32_t>, std::vector<std::uint32_t>>
+    row_sums(const sparse_data_matrix &m)
+    /*!
+     * Calculate the row sums of a fwdpp::sparse_data_matrix,
+     * which are the numbers of non-ancestral entries.
+     *
+     * \return A pair of vectors of unsigned integers representing row sums
+     * for neutral and selected sites in the matrix, respectively.
+     *
+     * \ingroup samplingPops
+     * \version 0.10.0 Added to library
+     */
+    {
+        return std::make_pair(allele_counts(m.neutral), allele_counts(m.selected));
+    }
+
+    inline state_matrix
+    unpack(const sparse_state_matrix &m, const std::int8_t ancestral_state = 0)
+    /*!
+     * Convert to a fwdpp::state_matrix.  Entries that are not stored
+     * are set to \a ancestral_state.
+     *
+     * \ingroup samplingPops
+     * \version 0.10.0 Added to library
+     */
+    {
+        std::vector<std::int8_t> data(m.nrow() * m.ncol, ancestral_state);
+        for (std::size_t i = 0; i < m.nrow(); ++i)
+            {
+                for (auto k = m.row_offsets[i]; k < m.row_offsets[i + 1]; ++k)
+                    {
+                        data[i * m.ncol + m.columns[k]] = m.states[k];
+                    }
+            }
+        return state_matrix(std::move(data), m.positions);
+    }
+} // namespace fwdpp
+
+#endif
@@ -0,0 +1,381 @@
+#ifndef FWDPP_TS_CHECKPOINT_HPP
+#define FWDPP_TS_CHECKPOINT_HPP
+
+#include <array>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include <fwdpp/io/scalar_serialization.hpp>
+#include "serialization.hpp"
+
+namespace fwdpp
+{
+    namespace ts
+    {
+        namespace io
+        {
+            /// Current version number of the checkpoint format
+            /// \version 0.10.0 Added to library
+            constexpr const std::uint32_t TS_CHECKPOINT_VERSION = 1;
+
+            namespace detail
+            {
+                // Written at the start of each checkpoint
+                constexpr std::uint32_t checkpoint_marker = 0x54504b43;
+
+                template <typename TableType> class table_tail
+                /// The rows of a table from an offset to the end,
+                /// with the interface that write_columns needs.
+                {
+                  private:
+                    const TableType& table;
+                    std::size_t offset;
+
+                  public:
+                    table_tail(const TableType& t, std::size_t o) : table(t), offset(o)
+                    {
+                    }
+
+                    std::size_t
+                    size() const
+                    {
+                        return table.size() - offset;
+                    }
+
+                    auto operator[](std::size_t i) const -> decltype(table[i])
+                    {
+                        return table[offset + i];
+                    }
+                };
+
+                class table_checkpoint_state
+                /// Rows of a table that are known to be the same
+                /// as at the previous checkpoint
+                {
+                  private:
+                    std::size_t clean_rows;
+
+                  public:
+                    table_checkpoint_state() : clean_rows(0)
+                    {
+                    }
+
+                    std::size_t
+                    unchanged_rows(std::size_t table_size) const
+                    /// Number of leading rows of a table of \a table_size
+                    /// rows that need not be written.  A table that shrank
+                    /// has been rewritten, for example by simplification.
+                    {
+                        return table_size < clean_rows ? 0 : clean_rows;
+                    }
+
+                    void
+                    mark_changed(std::size_t first_row)
+                    {
+                        clean_rows = std::min(clean_rows, first_row);
+                    }
+
+                    void
+                    update(std::size_t table_size)
+                    {
+                        clean_rows = table_size;
+                    }
+                };
+
+                template <typename Record, typename TableType, typename ostreamtype>
+                inline void
+                write_table_checkpoint(ostreamtype& o, const TableType& table,
+                                       table_checkpoint_state& state)
+                {
+                    const std::uint64_t keep = state.unchanged_rows(table.size());
+                    fwdpp::io::scalar_writer sw;
+                    sw(o, &keep);
+                    write_columns<Record>(
+                        o, table_tail<TableType>(table, static_cast<std::size_t>(keep)));
+                    state.update(table.size());
+                }
+
+                template <typename Record, typename TableType, typename istreamtype>
+                inline void
+                read_table_checkpoint(istreamtype& i, TableType& table)
+                {
+                    fwdpp::io::scalar_reader sr;
+                    std::uint64_t keep;
+                    sr(i, &keep);
+                    if (!i || keep > table.size())
+                        {
+                            throw std::runtime_error("invalid checkpoint");
+                        }
+                    table.resize(static_cast<std::size_t>(keep));
+                    append_columns<Record>(i, table);
+                }
+            } // namespace detail
+
+            enum class checkpoint_table
+            /// Tables of a checkpoint.  See
+            /// fwdpp::ts::io::checkpoint_writer::mark_changed.
+            /// \version 0.10.0 Added to library
+            {
+                edges,
+                nodes,
+                mutations,
+                sites
+            };
+
+            class checkpoint_writer
+            /*! \brief Append checkpoints of a fwdpp::ts::table_collection to a stream
+             *
+             *  The first call to write() writes a header and then the
+             *  entire table collection.  Each later call writes only the
+             *  rows added since the previous checkpoint.  Between
+             *  simplifications, tables only grow, so a checkpoint holds
+             *  the new nodes, edges, sites, and mutations.
+             *
+             *  Existing rows are not read.  A table with fewer rows than
+             *  at the previous checkpoint, as after a simplification, is
+             *  rewritten in full.  Any other change to existing rows must
+             *  be reported with mark_changed() or mark_all_changed()
+             *  before the next call to write().
+             *
+             *  All checkpoints from one writer must go to the same
+             *  stream, for example a std::ofstream opened once for the
+             *  whole run.  Read them with fwdpp::ts::io::checkpoint_reader.
+             *
+             *  \version 0.10.0 Added to library
+             */
+            {
+              private:
+                std::size_t num_checkpoints;
+                std::array<detail::table_checkpoint_state, 4> states;
+
+                detail::table_checkpoint_state&
+                state(checkpoint_table table)
+                {
+                    return states[static_cast<std::size_t>(table)];
+                }
+
+              public:
+                checkpoint_writer() : num_checkpoints(0), states{}
+                {
+                }
+
+                template <typename TableCollectionType, typename ostreamtype>
+                void
+                write(ostreamtype& o, const TableCollectionType& tables)
+                /// Append a checkpoint of \a tables to \a o.
+                ///
+                /// \throw std::runtime_error on a stream error
+                {
+                    fwdpp::io::scalar_writer sw;
+                    if (num_checkpoints == 0)
+                        {
+                            o << "fwdpptc";
+                            sw(o, &TS_CHECKPOINT_VERSION);
+                            auto L = tables.genome_length();
+                            sw(o, &L);
+                        }
+                    sw(o, &detail::checkpoint_marker);
+                    const std::int64_t edge_offset = tables.edge_offset;
+                    sw(o, &edge_offset);
+                    detail::write_table_checkpoint<edge>(
+                        o, tables.edges, state(checkpoint_table::edges));
+                    detail::write_table_checkpoint<node>(
+                        o, tables.nodes, state(checkpoint_table::nodes));
+                    detail::write_table_checkpoint<mutation_record>(
+                        o, tables.mutations, state(checkpoint_table::mutations));
+                    detail::write_table_checkpoint<site>(
+                        o, tables.sites, state(checkpoint_table::sites));
+                    const std::uint64_t num_preserved_nodes
+                        = tables.preserved_nodes.size();
+                    sw(o, &num_preserved_nodes);
+                    if (num_preserved_nodes)
+                        {
+                            sw(o, tables.preserved_nodes.data(),
+                               tables.preserved_nodes.size());
+                        }
+                    o.flush();
+                    if (!o)
+                        {
+                            throw std::runtime_error("error writing checkpoint");
+                        }
+                    ++num_checkpoints;
+                }
+
+                void
+                mark_changed(checkpoint_table table, std::size_t first_row = 0)
+                /// Rewrite \a table from \a first_row onwards at
+                /// the next checkpoint.
+                {
+                    states[static_cast<std::size_t>(table)].mark_changed(first_row);
+                }
+
+                void
+                mark_all_changed()
+                /// Rewrite all tables at the next checkpoint.
+                {
+                    for (auto& s : states)
+                        {
+                            s.mark_changed(0);
+                        }
+                }
+
+                std::size_t
+                checkpoints_written() const
+                {
+                    return num_checkpoints;
+                }
+            };
+
+            template <typename TableCollectionType> class checkpoint_reader
+            /*! \brief Read checkpoints written by fwdpp::ts::io::checkpoint_writer
+             *
+             *  Each call to next() applies one checkpoint to tables().
+             *
+             *  \code
+             *  fwdpp::ts::io::checkpoint_reader<fwdpp::ts::std_table_collection> reader;
+             *  while (reader.next(in))
+             *  {
+             *      // reader.tables() is the state at this checkpoint
+             *  }
+             *  \endcode
+             *
+             *  \version 0.10.0 Added to library
+             */
+            {
+              private:
+                TableCollectionType tables_;
+                std::size_t num_checkpoints;
+                bool indexed;
+
+                template <typename istreamtype>
+                void
+                read_header(istreamtype& i)
+                {
+                    char magic[7];
+                    i.read(magic, 7);
+                    if (!i || std::string(magic, magic + 7) != "fwdpptc")
+                        {
+                            throw std::runtime_error(
+                                "input stream is not at the beginning of a "
+                                "checkpoint file");
+                        }
+                    fwdpp::io::scalar_reader sr;
+                    std::uint32_t format;
+                    sr(i, &format);
+                    if (!i || format != TS_CHECKPOINT_VERSION)
+                        {
+                            throw std::runtime_error(
+                                "invalid serialization version detected");
+                        }
+                    double L;
+                    sr(i, &L);
+                    tables_ = TableCollectionType(L);
+                }
+
+              public:
+                checkpoint_reader() : tables_(1.), num_checkpoints(0), indexed(false)
+                {
+                }
+
+                template <typename istreamtype>
+                bool
+                next(istreamtype& i)
+                /// Apply the next checkpoint in \a i.
+                ///
+                /// \return false if there are no more checkpoints
+                /// \throw std::runtime_error if the input is invalid
+                {
+                    if (num_checkpoints == 0)
+                        {
+                            read_header(i);
+                        }
+                    std::uint32_t marker;
+                    i.read(reinterpret_cast<char*>(&marker), sizeof(marker));
+                    if (i.gcount() == 0 && i.eof())
+                        {
+                            return false;
+                        }
+                    if (!i || marker != detail::checkpoint_marker)
+                        {
+                            throw std::runtime_error("invalid checkpoint");
+                        }
+                    fwdpp::io::scalar_reader sr;
+                    std::int64_t edge_offset;
+                    sr(i, &edge_offset);
+                    tables_.edge_offset = static_cast<std::ptrdiff_t>(edge_offset);
+                    detail::read_table_checkpoint<edge>(i, tables_.edges);
+                    detail::read_table_checkpoint<node>(i, tables_.nodes);
+                    detail::read_table_checkpoint<mutation_record>(i, tables_.mutations);
+                    detail::read_table_checkpoint<site>(i, tables_.sites);
+                    std::uint64_t num_preserved_nodes;
+                    sr(i, &num_preserved_nodes);
+                    if (!i)
+                        {
+                            throw std::runtime_error("unexpected end of input");
+                        }
+                    tables_.preserved_nodes.resize(
+                        static_cast<std::size_t>(num_preserved_nodes));
+                    if (num_preserved_nodes)
+                        {
+                            sr(i, tables_.preserved_nodes.data(),
+                               tables_.preserved_nodes.size());
+                        }
+                    if (!i)
+                        {
+                            throw std::runtime_error("unexpected end of input");
+                        }
+                    indexed = false;
+                    ++num_checkpoints;
+                    return true;
+                }
+
+                const TableCollectionType&
+                tables()
+                /// The tables as of the last checkpoint read.
+                /// The index vectors are built here, rather than
+                /// by next(), so that skipping over checkpoints
+                /// does not build them for each one.
+                {
+                    if (!indexed)
+                        {
+                            tables_.build_indexes();
+                            indexed = true;
+                        }
+                    return tables_;
+                }
+
+                std::size_t
+                checkpoints_read() const
+                {
+                    return num_checkpoints;
+                }
+            };
+
+            template <typename TableCollectionType, typename istreamtype>
+            inline TableCollectionType
+            read_checkpoint(istreamtype& i, std::size_t checkpoint)
+            /// Return the tables at checkpoint number \a checkpoint,
+            /// counting from zero, of the checkpoints in \a i.
+            ///
+            /// \throw std::out_of_range if there are too few checkpoints
+            /// \version 0.10.0 Added to library
+            {
+                checkpoint_reader<TableCollectionType> reader;
+                while (reader.checkpoints_read() <= checkpoint)
+                    {
+                        if (!reader.next(i))
+                            {
+                                throw std::out_of_range("checkpoint not found");
+                            }
+                    }
+                return reader.tables();
+            }
+        } // namespace io
+    }     // namespace ts
+} // namespace fwdpp
+
+#endif
@@ -0,0 +1,673 @@
+#ifndef FWDPP_TS_COLUMN_TABLE_HPP
+#define FWDPP_TS_COLUMN_TABLE_HPP
+
+#include <tuple>
+#include <vector>
+#include <cstddef>
+#include <utility>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include "detail/memory_usage.hpp"
+
+namespace fwdpp
+{
+    namespace ts
+    {
+        namespace detail
+        {
+            template <typename T> struct arrow_proxy
+            /// Returned by column_table iterators in place of a pointer.
+            /// Holds a (proxy) reference so that it->field works.
+            {
+                T ref;
+                T*
+                operator->()
+                {
+                    return &ref;
+                }
+            };
+
+            template <typename ValueType, typename Arg>
+            inline ValueType
+            make_record(std::true_type, Arg&& arg)
+            {
+                return static_cast<ValueType>(std::forward<Arg>(arg));
+            }
+
+            template <typename ValueType, typename Arg>
+            inline ValueType
+            make_record(std::false_type, Arg&& arg)
+            {
+                return ValueType{std::forward<Arg>(arg)};
+            }
+
+            template <typename ValueType, typename Arg>
+            inline ValueType
+            make_record(Arg&& arg)
+            // One argument that is already a record, or a proxy
+            // to one, is converted. Otherwise, we aggregate-initialize.
+            {
+                return make_record<ValueType>(
+                    typename std::is_convertible<Arg, ValueType>::type{},
+                    std::forward<Arg>(arg));
+            }
+
+            template <typename ValueType, typename Arg0, typename Arg1,
+                      typename... Args>
+            inline ValueType
+            make_record(Arg0&& arg0, Arg1&& arg1, Args&&... args)
+            {
+                return ValueType{std::forward<Arg0>(arg0), std::forward<Arg1>(arg1),
+                                 std::forward<Args>(args)...};
+            }
+        } // namespace detail
+
+        template <typename Table, bool Const> class column_table_iterator
+        /// \brief Random-access iterator over a fwdpp::ts::column_table
+        ///
+        /// Dereferencing returns a proxy reference rather than
+        /// a reference to a stored record.
+        ///
+        /// \version 0.10.0 Added to library
+        {
+          private:
+            using table_ptr = typename std::conditional<Const, const Table*, Table*>::type;
+            table_ptr table_;
+            std::ptrdiff_t index_;
+
+            template <typename T, bool C> friend class column_table_iterator;
+
+          public:
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = typename Table::value_type;
+            using difference_type = std::ptrdiff_t;
+            using reference =
+                typename std::conditional<Const, typename Table::const_reference,
+                                          typename Table::reference>::type;
+            using pointer = detail::arrow_proxy<reference>;
+
+            column_table_iterator() : table_{nullptr}, index_{0}
+            {
+            }
+
+            column_table_iterator(table_ptr t, std::ptrdiff_t i) : table_{t}, index_{i}
+            {
+            }
+
+            template <bool C, typename = typename std::enable_if<Const && !C>::type>
+            column_table_iterator(const column_table_iterator<Table, C>& other)
+                /// Conversion from mutable to const iterator
+                : table_{other.table_}, index_{other.index_}
+            {
+            }
+
+            reference operator*() const
+            {
+                return (*table_)[static_cast<std::size_t>(index_)];
+            }
+
+            pointer operator->() const
+            {
+                return pointer{**this};
+            }
+
+            reference operator[](difference_type n) const
+            {
+                return (*table_)[static_cast<std::size_t>(index_ + n)];
+            }
+
+            column_table_iterator&
+            operator++()
+            {
+                ++index_;
+                return *this;
+            }
+
+            column_table_iterator
+            operator++(int)
+            {
+                auto rv = *this;
+                ++index_;
+                return rv;
+            }
+
+            column_table_iterator&
+            operator--()
+            {
+                --index_;
+                return *this;
+            }
+
+            column_table_iterator
+            operator--(int)
+            {
+                auto rv = *this;
+                --index_;
+                return rv;
+            }
+
+            column_table_iterator&
+            operator+=(difference_type n)
+            {
+                index_ += n;
+                return *this;
+            }
+
+            column_table_iterator&
+            operator-=(difference_type n)
+            {
+                index_ -= n;
+                return *this;
+            }
+
+            friend column_table_iterator
+            operator+(column_table_iterator i, difference_type n)
+            {
+                return i += n;
+            }
+
+            friend column_table_iterator
+            operator+(difference_type n, column_table_iterator i)
+            {
+                return i += n;
+            }
+
+            friend column_table_iterator
+            operator-(column_table_iterator i, difference_type n)
+            {
+                return i -= n;
+            }
+
+            std::ptrdiff_t
+            index() const
+            /// Row in the table referred to by this iterator
+            {
+                return index_;
+            }
+        };
+
+        template <typename Table, bool A, bool B>
+        inline std::ptrdiff_t
+        operator-(const column_table_iterator<Table, A>& a,
+                  const column_table_iterator<Table, B>& b)
+        {
+            return a.index() - b.index();
+        }
+
+        template <typename Table, bool A, bool B>
+        inline bool
+        operator==(const column_table_iterator<Table, A>& a,
+                   const column_table_iterator<Table, B>& b)
+        {
+            return a.index() == b.index();
+        }
+
+        template <typename Table, bool A, bool B>
+        inline bool
+        operator!=(const column_table_iterator<Table, A>& a,
+                   const column_table_iterator<Table, B>& b)
+        {
+            return !(a == b);
+        }
+
+        template <typename Table, bool A, bool B>
+        inline bool
+        operator<(const column_table_iterator<Table, A>& a,
+                  const column_table_iterator<Table, B>& b)
+        {
+            return a.index() < b.index();
+        }
+
+        template <typename Table, bool A, bool B>
+        inline bool
+        operator>(const column_table_iterator<Table, A>& a,
+                  const column_table_iterator<Table, B>& b)
+        {
+            return b < a;
+        }
+
+        template <typename Table, bool A, bool B>
+        inline bool
+        operator<=(const column_table_iterator<Table, A>& a,
+                   const column_table_iterator<Table, B>& b)
+        {
+            return !(b < a);
+        }
+
+        template <typename Table, bool A, bool B>
+        inline bool
+        operator>=(const column_table_iterator<Table, A>& a,
+                   const column_table_iterator<Table, B>& b)
+        {
+            return !(a < b);
+        }
+
+        template <typename ColumnTraits> class column_table
+        /*! \brief A table stored as one std::vector per field ("structure of arrays")
+         *
+         * The interface follows std::vector closely enough for the type to be
+         * used as a container parameter of fwdpp::ts::table_collection.
+         * Element access returns proxy objects whose data members are references
+         * into the columns, so that code like tables.edges[i].left only reads
+         * the left column.
+         *
+         * \a ColumnTraits must define:
+         *
+         * 1. value_type, an aggregate record type such as fwdpp::ts::edge
+         * 2. reference and const_reference, aggregates of (const) references to
+         *    the fields of value_type, in column order.
+         * 3. columns_type, a std::tuple of std::vector, one per field.
+         * 4. static auto tie(const value_type&), returning a tuple of references
+         *    to the fields of a record, in column order.
+         *
+         * See fwdpp/ts/columnar_table_collection.hpp for examples.
+         *
+         * \version 0.10.0 Added to library
+         */
+        {
+          public:
+            using traits_type = ColumnTraits;
+            using value_type = typename ColumnTraits::value_type;
+            using reference = typename ColumnTraits::reference;
+            using const_reference = typename ColumnTraits::const_reference;
+            using columns_type = typename ColumnTraits::columns_type;
+            using size_type = std::size_t;
+            using difference_type = std::ptrdiff_t;
+            using iterator = column_table_iterator<column_table, false>;
+            using const_iterator = column_table_iterator<column_table, true>;
+            using reverse_iterator = std::reverse_iterator<iterator>;
+            using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+          private:
+            static constexpr std::size_t ncols = std::tuple_size<columns_type>::value;
+            using column_indexes = std::make_index_sequence<ncols>;
+            columns_type columns_;
+
+            template <std::size_t... I>
+            reference
+            get_reference(std::size_t i, std::index_sequence<I...>)
+            {
+                return reference{std::get<I>(columns_)[i]...};
+            }
+
+            template <std::size_t... I>
+            const_reference
+            get_reference(std::size_t i, std::index_sequence<I...>) const
+            {
+                return const_reference{std::get<I>(columns_)[i]...};
+            }
+
+            template <std::size_t... I>
+            void
+            push_back_details(const value_type& v, std::index_sequence<I...>)
+            {
+                auto fields = ColumnTraits::tie(v);
+                (void)std::initializer_list<int>{
+                    (std::get<I>(columns_).push_back(std::get<I>(fields)), 0)...};
+            }
+
+            template <typename F, std::size_t... I>
+            void
+            apply_details(const F& f, std::index_sequence<I...>)
+            {
+                (void)std::initializer_list<int>{(f(std::get<I>(columns_)), 0)...};
+            }
+
+            template <typename F, std::size_t... I>
+            void
+            apply_details(const F& f, std::index_sequence<I...>) const
+            {
+                (void)std::initializer_list<int>{(f(std::get<I>(columns_)), 0)...};
+            }
+
+            template <typename F>
+            void
+            apply(const F& f)
+            // Apply f to each column
+            {
+                apply_details(f, column_indexes{});
+            }
+
+            template <typename F>
+            void
+            apply(const F& f) const
+            {
+                apply_details(f, column_indexes{});
+            }
+
+          public:
+            column_table() : columns_{}
+            {
+            }
+
+            explicit column_table(size_type n, const value_type& v = value_type{})
+                : columns_{}
+            {
+                resize(n, v);
+            }
+
+            template <typename Iterator,
+                      typename = typename std::iterator_traits<Iterator>::iterator_category>
+            column_table(Iterator first, Iterator last) : columns_{}
+            {
+                assign(first, last);
+            }
+
+            column_table(std::initializer_list<value_type> l) : columns_{}
+            {
+                assign(l.begin(), l.end());
+            }
+
+            reference operator[](size_type i)
+            {
+                return get_reference(i, column_indexes{});
+            }
+
+            const_reference operator[](size_type i) const
+            {
+                return get_reference(i, column_indexes{});
+            }
+
+            reference
+            at(size_type i)
+            {
+                if (i >= size())
+                    {
+                        throw std::out_of_range("column_table index out of range");
+                    }
+                return (*this)[i];
+            }
+
+            const_reference
+            at(size_type i) const
+            {
+                if (i >= size())
+                    {
+                        throw std::out_of_range("column_table index out of range");
+                    }
+                return (*this)[i];
+            }
+
+            reference
+            front()
+            {
+                return (*this)[0];
+            }
+
+            const_reference
+            front() const
+            {
+                return (*this)[0];
+            }
+
+            reference
+            back()
+            {
+                return (*this)[size() - 1];
+            }
+
+            const_reference
+            back() const
+            {
+                return (*this)[size() - 1];
+            }
+
+            size_type
+            size() const
+            {
+                return std::get<0>(columns_).size();
+            }
+
+            bool
+            empty() const
+            {
+                return std::get<0>(columns_).empty();
+            }
+
+            size_type
+            capacity() const
+            {
+                return std::get<0>(columns_).capacity();
+            }
+
+            std::size_t
+            memory_usage() const
+            /// Bytes allocated by all columns
+            {
+                std::size_t rv = 0;
+                apply([&rv](const auto& c) { rv += detail::memory_usage(c); });
+                return rv;
+            }
+
+            void
+            reserve(size_type n)
+            {
+                apply([n](auto& c) { c.reserve(n); });
+            }
+
+            void
+            shrink_to_fit()
+            {
+                apply([](auto& c) { c.shrink_to_fit(); });
+            }
+
+            void
+            clear()
+            {
+                apply([](auto& c) { c.clear(); });
+            }
+
+            void
+            resize(size_type n, const value_type& v = value_type{})
+            {
+                if (n <= size())
+                    {
+                        apply([n](auto& c) { c.resize(n); });
+                        return;
+                    }
+                reserve(n);
+                while (size() < n)
+                    {
+                        push_back(v);
+                    }
+            }
+
+            void
+            push_back(const value_type& v)
+            {
+                push_back_details(v, column_indexes{});
+            }
+
+            template <typename... Args>
+            void
+            emplace_back(Args&&... args)
+            {
+                push_back(detail::make_record<value_type>(std::forward<Args>(args)...));
+            }
+
+            void
+            pop_back()
+            {
+                apply([](auto& c) { c.pop_back(); });
+            }
+
+            template <typename Iterator>
+            void
+            assign(Iterator first, Iterator last)
+            {
+                clear();
+                insert(end(), first, last);
+            }
+
+            template <typename Iterator>
+            iterator
+            insert(const_iterator pos, Iterator first, Iterator last)
+            {
+                auto offset = pos.index();
+                if (static_cast<size_type>(offset) == size())
+                    {
+                        for (; first != last; ++first)
+                            {
+                                push_back(*first);
+                            }
+                        return iterator(this, offset);
+                    }
+                column_table temp(first, last);
+                auto ins = [offset](auto& c, const auto& t) {
+                    c.insert(c.begin() + offset, t.begin(), t.end());
+                };
+                insert_columns(ins, temp, column_indexes{});
+                return iterator(this, offset);
+            }
+
+            iterator
+            insert(const_iterator pos, const value_type& v)
+            {
+                return insert(pos, &v, &v + 1);
+            }
+
+            iterator
+            erase(const_iterator first, const_iterator last)
+            {
+                auto a = first.index(), b = last.index();
+                apply([a, b](auto& c) { c.erase(c.begin() + a, c.begin() + b); });
+                return iterator(this, a);
+            }
+
+            iterator
+            erase(const_iterator pos)
+            {
+                return erase(pos, pos + 1);
+            }
+
+            void
+            swap(column_table& other)
+            {
+                columns_.swap(other.columns_);
+            }
+
+            iterator
+            begin()
+            {
+                return iterator(this, 0);
+            }
+
+            iterator
+            end()
+            {
+                return iterator(this, static_cast<std::ptrdiff_t>(size()));
+            }
+
+            const_iterator
+            begin() const
+            {
+                return const_iterator(this, 0);
+            }
+
+            const_iterator
+            end() const
+            {
+                return const_iterator(this, static_cast<std::ptrdiff_t>(size()));
+            }
+
+            const_iterator
+            cbegin() const
+            {
+                return begin();
+            }
+
+            const_iterator
+            cend() const
+            {
+                return end();
+            }
+
+            reverse_iterator
+            rbegin()
+            {
+                return reverse_iterator(end());
+            }
+
+            reverse_iterator
+            rend()
+            {
+                return reverse_iterator(begin());
+            }
+
+            const_reverse_iterator
+            rbegin() const
+            {
+                return const_reverse_iterator(end());
+            }
+
+            const_reverse_iterator
+            rend() const
+            {
+                return const_reverse_iterator(begin());
+            }
+
+            template <std::size_t I>
+            const typename std::tuple_element<I, columns_type>::type&
+            column() const
+            /// Read-only access to a column.
+            /// The ColumnTraits type names the column indexes.
+            {
+                return std::get<I>(columns_);
+            }
+
+            const columns_type&
+            columns() const
+            {
+                return columns_;
+            }
+
+            bool
+            operator==(const column_table& other) const
+            {
+                return columns_ == other.columns_;
+            }
+
+            bool
+            operator!=(const column_table& other) const
+            {
+                return !(*this == other);
+            }
+
+            friend iterator
+            begin(column_table& t)
+            {
+                return t.begin();
+            }
+
+            friend iterator
+            end(column_table& t)
+            {
+                return t.end();
+            }
+
+            friend const_iterator
+            begin(const column_table& t)
+            {
+                return t.begin();
+            }
+
+            friend const_iterator
+            end(const column_table& t)
+            {
+                return t.end();
+            }
+
+          private:
+            template <typename F, std::size_t... I>
+            void
+            insert_columns(const F& f, const column_table& t, std::index_sequence<I...>)
+            {
+                (void)std::initializer_list<int>{
+                    (f(std::get<I>(columns_), std::get<I>(t.columns_)), 0)...};
+            }
+        };
+    } // namespace ts
+} // namespace fwdpp
+
+#endif
@@ -0,0 +1,258 @@
+#ifndef FWDPP_TS_COLUMNAR_TABLE_COLLECTION_HPP
+#define FWDPP_TS_COLUMNAR_TABLE_COLLECTION_HPP
+
+#include <tuple>
+#include <vector>
+#include <cstdint>
+#include "definitions.hpp"
+#include "node.hpp"
+#include "edge.hpp"
+#include "site.hpp"
+#include "mutation_record.hpp"
+#include "column_table.hpp"
+#include "table_collection.hpp"
+
+namespace fwdpp
+{
+    namespace ts
+    {
+        struct node_reference
+        /// Proxy reference to a row of a node_column_table
+        /// \version 0.10.0 Added to library
+        {
+            std::int32_t& deme;
+            double& time;
+
+            operator node() const
+            {
+                return node{deme, time};
+            }
+
+            node_reference&
+            operator=(const node& n)
+            {
+                deme = n.deme;
+                time = n.time;
+                return *this;
+            }
+
+            node_reference&
+            operator=(const node_reference& n)
+            {
+                return *this = static_cast<node>(n);
+            }
+        };
+
+        struct node_const_reference
+        /// Proxy reference to a row of a const node_column_table
+        /// \version 0.10.0 Added to library
+        {
+            const std::int32_t& deme;
+            const double& time;
+
+            operator node() const
+            {
+                return node{deme, time};
+            }
+        };
+
+        inline void
+        swap(node_reference a, node_reference b)
+        {
+            node t = a;
+            a = b;
+            b = t;
+        }
+
+        struct node_column_traits
+        /// Column layout of fwdpp::ts::node_column_table
+        /// \version 0.10.0 Added to library
+        {
+            enum : std::size_t
+            {
+                deme,
+                time
+            };
+            using value_type = node;
+            using reference = node_reference;
+            using const_reference = node_const_reference;
+            using columns_type = std::tuple<std::vector<std::int32_t>, std::vector<double>>;
+
+            static inline auto
+            tie(const node& n)
+            {
+                return std::tie(n.deme, n.time);
+            }
+        };
+
+        struct edge_reference
+        /// Proxy reference to a row of an edge_column_table
+        /// \version 0.10.0 Added to library
+        {
+            double& left;
+            double& right;
+            table_index_t& parent;
+            table_index_t& child;
+
+            operator edge() const
+            {
+                return edge{left, right, parent, child};
+            }
+
+            edge_reference&
+            operator=(const edge& e)
+            {
+                left = e.left;
+                right = e.right;
+                parent = e.parent;
+                child = e.child;
+                return *this;
+            }
+
+            edge_reference&
+            operator=(const edge_reference& e)
+            {
+                return *this = static_cast<edge>(e);
+            }
+        };
+
+        struct edge_const_reference
+        /// Proxy reference to a row of a const edge_column_table
+        /// \version 0.10.0 Added to library
+        {
+            const double& left;
+            const double& right;
+            const table_index_t& parent;
+            const table_index_t& child;
+
+            operator edge() const
+            {
+                return edge{left, right, parent, child};
+            }
+        };
+
+        inline void
+        swap(edge_reference a, edge_reference b)
+        {
+            edge t = a;
+            a = b;
+            b = t;
+        }
+
+        struct edge_column_traits
+        /// Column layout of fwdpp::ts::edge_column_table
+        /// \version 0.10.0 Added to library
+        {
+            enum : std::size_t
+            {
+                left,
+                right,
+                parent,
+                child
+            };
+            using value_type = edge;
+            using reference = edge_reference;
+            using const_reference = edge_const_reference;
+            using columns_type
+                = std::tuple<std::vector<double>, std::vector<double>,
+                             std::vector<table_index_t>, std::vector<table_index_t>>;
+
+            static inline auto
+            tie(const edge& e)
+            {
+                return std::tie(e.left, e.right, e.parent, e.child);
+            }
+        };
+
+        struct site_reference
+        /// Proxy reference to a row of a site_column_table
+        /// \version 0.10.0 Added to library
+        {
+            double& position;
+            std::int8_t& ancestral_state;
+
+            operator site() const
+            {
+                return site{position, ancestral_state};
+            }
+
+            site_reference&
+            operator=(const site& s)
+            {
+                position = s.position;
+                ancestral_state = s.ancestral_state;
+                return *this;
+            }
+
+            site_reference&
+            operator=(const site_reference& s)
+            {
+                return *this = static_cast<site>(s);
+            }
+        };
+
+        struct site_const_reference
+        /// Proxy reference to a row of a const site_column_table
+        /// \version 0.10.0 Added to library
+        {
+            const double& position;
+            const std::int8_t& ancestral_state;
+
+            operator site() const
+            {
+                return site{position, ancestral_state};
+            }
+        };
+
+        inline void
+        swap(site_reference a, site_reference b)
+        {
+            site t = a;
+            a = b;
+            b = t;
+        }
+
+        struct site_column_traits
+        /// Column layout of fwdpp::ts::site_column_table
+        /// \version 0.10.0 Added to library
+        {
+            enum : std::size_t
+            {
+                position,
+                ancestral_state
+            };
+            using value_type = site;
+            using reference = site_reference;
+            using const_reference = site_const_reference;
+            using columns_type
+                = std::tuple<std::vector<double>, std::vector<std::int8_t>>;
+
+            static inline auto
+            tie(const site& s)
+            {
+                return std::tie(s.position, s.ancestral_state);
+            }
+        };
+
+        /// Node table stored as separate deme and time columns
+        /// \version 0.10.0 Added to library
+        using node_column_table = column_table<node_column_traits>;
+        /// Edge table stored as separate left, right, parent, and child columns
+        /// \version 0.10.0 Added to library
+        using edge_column_table = column_table<edge_column_traits>;
+        /// Site table stored as separate position and ancestral state columns
+        /// \version 0.10.0 Added to library
+        using site_column_table = column_table<site_column_traits>;
+
+        /// Alias for a column-oriented ("structure of arrays") table collection.
+        /// Sorting, index building, and tree traversal only touch the columns
+        /// that they need.  The mutation table is a std::vector, as most
+        /// operations on it use all fields.
+        /// \version 0.10.0 Added to library
+        using columnar_table_collection
+            = table_collection<node_column_table, edge_column_table, site_column_table,
+                               std::vector<mutation_record>>;
+    } // namespace ts
+} // namespace fwdpp
+
+#endif
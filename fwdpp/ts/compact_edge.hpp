@@ -0,0 +1,65 @@
+#ifndef FWDPP_TS_COMPACT_EDGE_HPP
+#define FWDPP_TS_COMPACT_EDGE_HPP
+
+#include <tuple>
+#include <cstdint>
+#include "definitions.hpp"
+#include "edge.hpp"
+#include "detail/compact_value.hpp"
+
+namespace fwdpp
+{
+    namespace ts
+    {
+        struct compact_edge
+        /*! An edge whose genomic coordinates are integers
+         * @version 0.10.0 Added to library
+         *
+         * Alternative to fwdpp::ts::edge for simulations
+         * of discrete genomes.  Takes two-thirds of the memory.
+         */
+        {
+            /// Left (inclusive) edge of genomic segment
+            std::int32_t left;
+            /// Right (exclusive) edge of genomic segment
+            std::int32_t right;
+            /// Parent ID
+            table_index_t parent;
+            /// Child ID
+            table_index_t child;
+
+            compact_edge() : left{0}, right{0}, parent{NULL_INDEX}, child{NULL_INDEX}
+            {
+            }
+
+            compact_edge(double l, double r, table_index_t p, table_index_t c)
+                : left{detail::compact_value<std::int32_t>(l, "edge left")},
+                  right{detail::compact_value<std::int32_t>(r, "edge right")},
+                  parent{p}, child{c}
+            /// Throws std::invalid_argument if \a l or \a r
+            /// is not an integer that fits in 32 bits.
+            {
+            }
+
+            explicit compact_edge(const edge& e)
+                : compact_edge(e.left, e.right, e.parent, e.child)
+            {
+            }
+
+            operator edge() const
+            {
+                return edge{static_cast<double>(left), static_cast<double>(right),
+                            parent, child};
+            }
+        };
+
+        inline bool
+        operator==(const compact_edge& a, const compact_edge& b)
+        {
+            return std::tie(a.parent, a.child, a.left, a.right)
+                   == std::tie(b.parent, b.child, b.left, b.right);
+        }
+    } // namespace ts
+} // namespace fwdpp
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef FWDPP_TS_COMPACT_MUTATION_RECORD_HPP
+#define FWDPP_TS_COMPACT_MUTATION_RECORD_HPP
+
+#include <tuple>
+#include <cstdint>
+#include <cstddef>
+#include "definitions.hpp"
+#include "mutation_record.hpp"
+#include "detail/compact_value.hpp"
+
+namespace fwdpp
+{
+    namespace ts
+    {
+        struct compact_mutation_record
+        /// \brief Tracks mutations on tree sequences using 32-bit indexes.
+        ///
+        /// Alternative to fwdpp::ts::mutation_record that
+        /// takes half the memory.
+        ///
+        /// \version 0.10.0 Added to library
+        {
+            /// The node to which the mutation is
+            /// currently simplified
+            std::int32_t node;
+            /// The index of the mutation in the
+            /// population's mutation container
+            std::uint32_t key;
+            /// Row in the site table.
+            std::uint32_t site;
+            /// Character state of the mutation
+            std::int8_t derived_state;
+            /// True if mutation affects fitness, otherwise false.
+            bool neutral;
+
+            compact_mutation_record()
+                : node{NULL_INDEX}, key{0}, site{0},
+                  derived_state{default_derived_state}, neutral{true}
+            {
+            }
+
+            compact_mutation_record(std::int32_t n, std::size_t k, std::size_t s,
+                                    std::int8_t d, bool neut)
+                : node{n}, key{detail::compact_value<std::uint32_t>(k, "mutation key")},
+                  site{detail::compact_value<std::uint32_t>(s, "mutation site")},
+                  derived_state{d}, neutral{neut}
+            /// Throws std::invalid_argument if \a k or \a s
+            /// does not fit in 32 bits.
+            {
+            }
+
+            explicit compact_mutation_record(const mutation_record& m)
+                : compact_mutation_record(m.node, m.key, m.site, m.derived_state,
+                                          m.neutral)
+            {
+            }
+
+            operator mutation_record() const
+            {
+                return mutation_record{node, key, site, derived_state, neutral};
+            }
+        };
+
+        inline bool
+        operator==(const compact_mutation_record& a, const compact_mutation_record& b)
+        {
+            return a.site == b.site
+                   && std::tie(a.node, a.key, a.derived_state, a.neutral)
+                          == std::tie(b.node, b.key, b.derived_state, b.neutral);
+        }
+    } // namespace ts
+} // namespace fwdpp
+
+#endif
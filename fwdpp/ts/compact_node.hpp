@@ -0,0 +1,57 @@
+#ifndef FWDPP_TS_COMPACT_NODE_HPP
+#define FWDPP_TS_COMPACT_NODE_HPP
+
+#include <tuple>
+#include <cstdint>
+#include "node.hpp"
+#include "detail/compact_value.hpp"
+
+namespace fwdpp
+{
+    namespace ts
+    {
+        struct compact_node
+        /// \brief A node whose birth time is an integer
+        ///
+        /// Alternative to fwdpp::ts::node for simulations
+        /// with discrete generations.  Takes half the memory.
+        ///
+        /// \version 0.10.0 Added to library
+        {
+            /// Location of the node.
+            std::int32_t deme;
+            /// Birth time of the node.
+            std::int32_t time;
+
+            compact_node() : deme{0}, time{0}
+            {
+            }
+
+            compact_node(std::int32_t d, double t)
+                : deme{d}, time{detail::compact_value<std::int32_t>(t, "node time")}
+            /// \param d The deme
+            /// \param t Birth time
+            ///
+            /// Throws std::invalid_argument if \a t is not
+            /// an integer that fits in 32 bits.
+            {
+            }
+
+            explicit compact_node(const node& n) : compact_node(n.deme, n.time)
+            {
+            }
+
+            operator node() const
+            {
+                return node{deme, static_cast<double>(time)};
+            }
+        };
+
+        inline bool
+        operator==(const compact_node& a, const compact_node& b)
+        {
+            return std::tie(a.time, a.deme) == std::tie(b.time, b.deme);
+        }
+    } // namespace ts
+} // namespace fwdpp
+#endif
@@ -0,0 +1,59 @@
+#ifndef FWDPP_TS_COMPACT_SITE_HPP
+#define FWDPP_TS_COMPACT_SITE_HPP
+
+#include <tuple>
+#include <cstdint>
+#include "definitions.hpp"
+#include "site.hpp"
+#include "detail/compact_value.hpp"
+
+namespace fwdpp
+{
+    namespace ts
+    {
+        struct compact_site
+        /// Entry in a site table for a discrete genome.
+        /// \version 0.10.0 Added to library
+        {
+            std::int32_t position;
+            std::int8_t ancestral_state;
+
+            compact_site() : position{0}, ancestral_state{default_ancestral_state}
+            {
+            }
+
+            compact_site(double p, std::int8_t a)
+                : position{detail::compact_value<std::int32_t>(p, "site position")},
+                  ancestral_state{a}
+            /// Throws std::invalid_argument if \a p is not
+            /// an integer that fits in 32 bits.
+            {
+            }
+
+            explicit compact_site(const site& s)
+                : compact_site(s.position, s.ancestral_state)
+            {
+            }
+
+            operator site() const
+            {
+                return site{static_cast<double>(position), ancestral_state};
+            }
+        };
+
+        inline bool
+        operator<(const compact_site& a, const compact_site& b)
+        {
+            return a.position < b.position;
+        }
+
+        inline bool
+        operator==(const compact_site& a, const compact_site& b)
+        {
+            return std::tie(a.position, a.ancestral_state)
+                   == std::tie(b.position, b.ancestral_state);
+        }
+    } // namespace ts
+} // namespace fwdpp
+
+#endif
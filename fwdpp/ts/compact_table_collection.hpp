@@ -0,0 +1,28 @@
+#ifndef FWDPP_TS_COMPACT_TABLE_COLLECTION_HPP
+#define FWDPP_TS_COMPACT_TABLE_COLLECTION_HPP
+
+#include <vector>
+#include "compact_node.hpp"
+#include "compact_edge.hpp"
+#include "compact_site.hpp"
+#include "compact_mutation_record.hpp"
+#include "table_collection.hpp"
+
+namespace fwdpp
+{
+    namespace ts
+    {
+        /// Alias for a table collection backed by std::vector
+        /// of compact records.  Suitable for simulations of
+        /// discrete genomes with integer birth times.  Adding
+        /// a row throws std::invalid_argument if a value
+        /// cannot be stored in 32 bits.
+        /// \version 0.10.0 Added to library
+        using compact_table_collection
+            = table_collection<std::vector<compact_node>, std::vector<compact_edge>,
+                               std::vector<compact_site>,
+                               std::vector<compact_mutation_record>>;
+    } // namespace ts
+} // namespace fwdpp
+
+#endif
@@ -0,0 +1,451 @@
+#ifndef FWDPP_TS_COMPRESSED_SERIALIZATION_HPP
+#define FWDPP_TS_COMPRESSED_SERIALIZATION_HPP
+
+#include <cmath>
+#include <tuple>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <fwdpp/io/scalar_serialization.hpp>
+#include "serialization.hpp"
+
+namespace fwdpp
+{
+    namespace ts
+    {
+        namespace io
+        {
+            /// Current version number of the compressed binary format
+            /// \version 0.10.0 Added to library
+            constexpr const std::uint32_t TS_COMPRESSED_TABLES_VERSION = 1;
+
+            namespace detail
+            {
+                // Column encodings.  The first byte of each
+                // encoded column is one of these values.
+                enum class column_encoding : std::uint8_t
+                {
+                    // Values are written as they are stored
+                    raw = 0,
+                    // Integer values are written as zigzag varints
+                    // of the difference from the previous row
+                    delta_varint = 1
+                };
+
+                inline void
+                encode_varint(std::uint64_t x, std::vector<char>& buffer)
+                /// Unsigned LEB128: seven bits per byte, least
+                /// significant group first, high bit set on all
+                /// bytes but the last.
+                {
+                    while (x >= 0x80)
+                        {
+                            buffer.push_back(static_cast<char>((x & 0x7f) | 0x80));
+                            x >>= 7;
+                        }
+                    buffer.push_back(static_cast<char>(x));
+                }
+
+                inline std::uint64_t
+                decode_varint(const char*& p, const char* end)
+                {
+                    std::uint64_t x = 0;
+                    for (unsigned shift = 0; shift < 64; shift += 7)
+                        {
+                            if (p == end)
+                                {
+                                    throw std::runtime_error("truncated varint");
+                                }
+                            const auto byte = static_cast<std::uint8_t>(*p++);
+                            x |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+                            if (!(byte & 0x80))
+                                {
+                                    return x;
+                                }
+                        }
+                    throw std::runtime_error("varint is too long");
+                }
+
+                inline std::uint64_t
+                zigzag_encode(std::uint64_t delta)
+                /// Map a two's complement difference to an unsigned value
+                /// so that small magnitudes of either sign are small:
+                /// 0, -1, 1, -2, ... become 0, 1, 2, 3, ...
+                {
+                    return (delta << 1) ^ (0 - (delta >> 63));
+                }
+
+                inline std::uint64_t
+                zigzag_decode(std::uint64_t x)
+                {
+                    return (x >> 1) ^ (0 - (x & 1));
+                }
+
+                template <typename T>
+                inline void
+                encode_delta_varints(const std::vector<T>& column,
+                                     std::vector<char>& buffer)
+                /// Differences are taken modulo 2^64, so that any
+                /// integer type round trips.
+                {
+                    std::uint64_t previous = 0;
+                    for (auto x : column)
+                        {
+                            const auto current = static_cast<std::uint64_t>(x);
+                            encode_varint(zigzag_encode(current - previous), buffer);
+                            previous = current;
+                        }
+                }
+
+                template <typename T>
+                inline void
+                decode_delta_varints(const char* p, const char* end,
+                                     std::vector<T>& column)
+                {
+                    std::uint64_t previous = 0;
+                    for (auto& x : column)
+                        {
+                            previous += zigzag_decode(decode_varint(p, end));
+                            x = static_cast<T>(previous);
+                        }
+                    if (p != end)
+                        {
+                            throw std::runtime_error("unexpected data after column");
+                        }
+                }
+
+                template <typename T>
+                inline void
+                encode_raw(const std::vector<T>& column, std::vector<char>& buffer)
+                {
+                    const auto p = reinterpret_cast<const char*>(column.data());
+                    buffer.insert(buffer.end(), p, p + column.size() * sizeof(T));
+                }
+
+                template <typename T>
+                inline void
+                decode_raw(const char* p, const char* end, std::vector<T>& column)
+                {
+                    if (static_cast<std::size_t>(end - p) != column.size() * sizeof(T))
+                        {
+                            throw std::runtime_error("invalid column size");
+                        }
+                    std::copy(p, end, reinterpret_cast<char*>(column.data()));
+                }
+
+                template <typename T>
+                inline void
+                encode_column(const std::vector<T>& column, std::vector<char>& buffer,
+                              std::true_type)
+                /// Integer columns.  Single bytes do not benefit
+                /// from variable-length encoding.
+                {
+                    if (sizeof(T) == 1)
+                        {
+                            buffer.push_back(static_cast<char>(column_encoding::raw));
+                            encode_raw(column, buffer);
+                        }
+                    else
+                        {
+                            buffer.push_back(
+                                static_cast<char>(column_encoding::delta_varint));
+                            encode_delta_varints(column, buffer);
+                        }
+                }
+
+                inline bool
+                all_integral(const std::vector<double>& column)
+                /// True if every value is an integer that a double
+                /// represents exactly.
+                {
+                    constexpr double max_exact = 9007199254740992.; // 2^53
+                    for (auto x : column)
+                        {
+                            if (!(std::fabs(x) <= max_exact) || std::trunc(x) != x
+                                || (x == 0. && std::signbit(x)))
+                                {
+                                    return false;
+                                }
+                        }
+                    return true;
+                }
+
+                inline void
+                encode_column(const std::vector<double>& column,
+                              std::vector<char>& buffer, std::false_type)
+                /// Floating-point columns holding integer values,
+                /// such as node times or breakpoints in discrete
+                /// genomes, are delta encoded.  Other columns are
+                /// written as they are stored.
+                {
+                    if (all_integral(column))
+                        {
+                            buffer.push_back(
+                                static_cast<char>(column_encoding::delta_varint));
+                            std::vector<std::int64_t> integers(column.begin(),
+                                                               column.end());
+                            encode_delta_varints(integers, buffer);
+                        }
+                    else
+                        {
+                            buffer.push_back(static_cast<char>(column_encoding::raw));
+                            encode_raw(column, buffer);
+                        }
+                }
+
+                template <typename T>
+                inline void
+                decode_column(const char* p, const char* end, std::vector<T>& column,
+                              std::true_type)
+                {
+                    const auto encoding = static_cast<column_encoding>(*p++);
+                    if (encoding == column_encoding::raw)
+                        {
+                            decode_raw(p, end, column);
+                        }
+                    else if (encoding == column_encoding::delta_varint)
+                        {
+                            decode_delta_varints(p, end, column);
+                        }
+                    else
+                        {
+                            throw std::runtime_error("invalid column encoding");
+                        }
+                }
+
+                inline void
+                decode_column(const char* p, const char* end,
+                              std::vector<double>& column, std::false_type)
+                {
+                    const auto encoding = static_cast<column_encoding>(*p++);
+                    if (encoding == column_encoding::raw)
+                        {
+                            decode_raw(p, end, column);
+                        }
+                    else if (encoding == column_encoding::delta_varint)
+                        {
+                            std::vector<std::int64_t> integers(column.size());
+                            decode_delta_varints(p, end, integers);
+                            std::copy(integers.begin(), integers.end(), column.begin());
+                        }
+                    else
+                        {
+                            throw std::runtime_error("invalid column encoding");
+                        }
+                }
+
+                template <typename T, typename ostreamtype>
+                inline void
+                write_compressed_column(ostreamtype& o, const std::vector<T>& column)
+                /// Each column is written as its encoded size in bytes
+                /// followed by the encoding and the data.
+                {
+                    std::vector<char> buffer;
+                    encode_column(column, buffer, typename std::is_integral<T>::type{});
+                    fwdpp::io::scalar_writer sw;
+                    const std::uint64_t nbytes = buffer.size();
+                    sw(o, &nbytes);
+                    sw(o, buffer.data(), buffer.size());
+                }
+
+                template <typename T, typename istreamtype>
+                inline void
+                read_compressed_column(istreamtype& i, std::size_t nrows,
+                                       std::vector<T>& column)
+                {
+                    fwdpp::io::scalar_reader sr;
+                    std::uint64_t nbytes;
+                    sr(i, &nbytes);
+                    // After the encoding byte, every row takes
+                    // between one byte and the ten bytes of the
+                    // longest varint.
+                    if (!i || nbytes == 0 || nbytes - 1 < nrows
+                        || nbytes - 1 > 10 * nrows)
+                        {
+                            throw std::runtime_error("invalid compressed column size");
+                        }
+                    std::vector<char> buffer(nbytes);
+                    i.read(buffer.data(), static_cast<std::streamsize>(nbytes));
+                    if (!i)
+                        {
+                            throw std::runtime_error("unexpected end of input");
+                        }
+                    column.resize(nrows);
+                    decode_column(buffer.data(), buffer.data() + buffer.size(), column,
+                                  typename std::is_integral<T>::type{});
+                }
+
+                template <typename Record, typename TableType, typename ostreamtype,
+                          std::size_t... I>
+                inline void
+                write_compressed_columns_details(ostreamtype& o, const TableType& table,
+                                                 std::index_sequence<I...>)
+                {
+                    const auto columns = gather_columns<Record>(table);
+                    int dummy[] = {(write_compressed_column(o, std::get<I>(columns)), 0)...};
+                    static_cast<void>(dummy);
+                }
+
+                template <typename Record, typename TableType, typename ostreamtype>
+                inline void
+                write_compressed_columns(ostreamtype& o, const TableType& table)
+                {
+                    constexpr std::size_t ncols
+                        = std::tuple_size<serialized_fields<Record>>::value;
+                    fwdpp::io::scalar_writer sw;
+                    const std::uint64_t nrows = table.size();
+                    const std::uint32_t num_columns = ncols;
+                    sw(o, &nrows);
+                    sw(o, &num_columns);
+                    write_compressed_columns_details<Record>(
+                        o, table, std::make_index_sequence<ncols>());
+                }
+
+                template <typename Record, typename TableType, typename istreamtype,
+                          std::size_t... I>
+                inline void
+                read_compressed_columns_details(istreamtype& i, std::size_t nrows,
+                                                TableType& table,
+                                                std::index_sequence<I...>)
+                {
+                    serialized_column_vectors<Record> columns;
+                    int dummy[] = {
+                        (read_compressed_column(i, nrows, std::get<I>(columns)), 0)...};
+                    static_cast<void>(dummy);
+                    assign_rows<Record>(table, nrows, columns);
+                }
+
+                template <typename Record, typename TableType, typename istreamtype>
+                inline void
+                read_compressed_columns(istreamtype& i, TableType& table)
+                {
+                    constexpr std::size_t ncols
+                        = std::tuple_size<serialized_fields<Record>>::value;
+                    fwdpp::io::scalar_reader sr;
+                    std::uint64_t nrows;
+                    std::uint32_t num_columns;
+                    sr(i, &nrows);
+                    sr(i, &num_columns);
+                    if (!i || num_columns != ncols)
+                        {
+                            throw std::runtime_error("invalid number of columns");
+                        }
+                    read_compressed_columns_details<Record>(
+                        i, static_cast<std::size_t>(nrows), table,
+                        std::make_index_sequence<ncols>());
+                }
+            } // namespace detail
+
+            template <typename TableCollectionType, typename ostreamtype>
+            void
+            serialize_tables_compressed(ostreamtype& o,
+                                        const TableCollectionType& tables)
+            /*! \brief Write a fwdpp::ts::table_collection to a compressed binary stream
+             *
+             *  The layout follows fwdpp::ts::io::serialize_tables: a header
+             *  and then the edge, node, mutation, and site tables, one
+             *  column at a time.  Columns are compressed as follows:
+             *
+             *  1. Integer columns wider than one byte are written as
+             *     the differences between successive rows, zigzag encoded
+             *     and written as variable-length integers.  Sorted
+             *     columns, such as edge parents, take one or two bytes
+             *     per row.
+             *  2. Floating-point columns whose values are all integers,
+             *     such as node times and the breakpoints of discrete
+             *     genomes, are encoded as in (1).
+             *  3. Other columns are written as they are stored.
+             *
+             *  The encoding is lossless.  Read the output with
+             *  fwdpp::ts::io::deserialize_tables_compressed.
+             *
+             *  \param o A model of std::ostream
+             *  \param tables A fwdpp::ts::table_collection
+             *
+             *  \version 0.10.0 Added to library
+             */
+            {
+                o << "fwdpptz";
+                fwdpp::io::scalar_writer sw;
+                sw(o, &TS_COMPRESSED_TABLES_VERSION);
+                auto L = tables.genome_length();
+                sw(o, &L);
+                sw(o, &tables.edge_offset);
+                detail::write_compressed_columns<edge>(o, tables.edges);
+                detail::write_compressed_columns<node>(o, tables.nodes);
+                detail::write_compressed_columns<mutation_record>(o, tables.mutations);
+                detail::write_compressed_columns<site>(o, tables.sites);
+                std::vector<table_index_t> preserved_nodes(
+                    tables.preserved_nodes.begin(), tables.preserved_nodes.end());
+                const std::uint64_t num_preserved_nodes = preserved_nodes.size();
+                sw(o, &num_preserved_nodes);
+                detail::write_compressed_column(o, preserved_nodes);
+            }
+
+            template <typename TableCollectionType>
+            struct deserialize_tables_compressed
+            {
+                template <typename istreamtype>
+                inline TableCollectionType
+                operator()(istreamtype& i)
+                /*! \brief Read a fwdpp::ts::table_collection from a compressed
+                 *  binary stream
+                 *
+                 *  \param i A model of std::istream
+                 *
+                 *  \return fwdpp::ts::table_collection
+                 *
+                 *  \note The return value has its index vectors populated.
+                 *
+                 *  See fwdpp::ts::io::serialize_tables_compressed.
+                 *
+                 *  \version 0.10.0 Added to library
+                 */
+                {
+                    char magic[7];
+                    i.read(magic, 7);
+                    if (!i || std::string(magic, magic + 7) != "fwdpptz")
+                        {
+                            throw std::runtime_error(
+                                "input stream is not at the beginning of a "
+                                "compressed table_collection");
+                        }
+                    fwdpp::io::scalar_reader sr;
+                    std::uint32_t format;
+                    sr(i, &format);
+                    if (format != TS_COMPRESSED_TABLES_VERSION)
+                        {
+                            throw std::runtime_error(
+                                "invalid serialization version detected");
+                        }
+                    double L;
+                    sr(i, &L);
+                    TableCollectionType tables(L);
+                    sr(i, &tables.edge_offset);
+                    detail::read_compressed_columns<edge>(i, tables.edges);
+                    detail::read_compressed_columns<node>(i, tables.nodes);
+                    detail::read_compressed_columns<mutation_record>(i,
+                                                                     tables.mutations);
+                    detail::read_compressed_columns<site>(i, tables.sites);
+                    std::uint64_t num_preserved_nodes;
+                    sr(i, &num_preserved_nodes);
+                    std::vector<table_index_t> preserved_nodes;
+                    detail::read_compressed_column(
+                        i, static_cast<std::size_t>(num_preserved_nodes),
+                        preserved_nodes);
+                    tables.preserved_nodes.assign(preserved_nodes.begin(),
+                                                  preserved_nodes.end());
+                    tables.build_indexes();
+                    return tables;
+                }
+            };
+        } // namespace io
+    }     // namespace ts
+} // namespace fwdpp
+
+#endif
@@ -73,6 +73,7 @@ namespace fwdpp
                         return c || p;
                     }),
                 end(tables.edges));
+            tables.clear_indexes();
             tables.build_indexes();
         }
     } // namespace ts
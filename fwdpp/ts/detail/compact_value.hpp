@@ -0,0 +1,80 @@
+#ifndef FWDPP_TS_DETAIL_COMPACT_VALUE_HPP
+#define FWDPP_TS_DETAIL_COMPACT_VALUE_HPP
+
+#include <cmath>
+#include <limits>
+#include <string>
+#include <stdexcept>
+#include <type_traits>
+
+namespace fwdpp
+{
+    namespace ts
+    {
+        namespace detail
+        {
+            template <typename Narrow, typename Wide>
+            inline Narrow
+            compact_value(Wide value, const char* field, std::true_type)
+            // Integer input
+            {
+                using wide_limits = std::numeric_limits<Wide>;
+                using narrow_limits = std::numeric_limits<Narrow>;
+                bool fits = true;
+                if (wide_limits::is_signed && !narrow_limits::is_signed)
+                    {
+                        fits = value >= 0
+                               && static_cast<typename std::make_unsigned<Wide>::type>(
+                                      value)
+                                      <= narrow_limits::max();
+                    }
+                else if (!wide_limits::is_signed && narrow_limits::is_signed)
+                    {
+                        fits = value <= static_cast<typename std::make_unsigned<
+                                   Narrow>::type>(narrow_limits::max());
+                    }
+                else
+                    {
+                        fits = value >= narrow_limits::min()
+                               && value <= narrow_limits::max();
+                    }
+                if (!fits)
+                    {
+                        throw std::invalid_argument(std::string(field)
+                                                    + " does not fit in compact record");
+                    }
+                return static_cast<Narrow>(value);
+            }
+
+            template <typename Narrow, typename Wide>
+            inline Narrow
+            compact_value(Wide value, const char* field, std::false_type)
+            // Floating-point input must be a whole number
+            {
+                if (!std::isfinite(value) || std::floor(value) != value
+                    || value < static_cast<Wide>(std::numeric_limits<Narrow>::min())
+                    || value > static_cast<Wide>(std::numeric_limits<Narrow>::max()))
+                    {
+                        throw std::invalid_argument(
+                            std::string(field)
+                            + " is not an integer value that fits in compact record");
+                    }
+                return static_cast<Narrow>(value);
+            }
+
+            template <typename Narrow, typename Wide>
+            inline Narrow
+            compact_value(Wide value, const char* field)
+            /// Convert \a value to \a Narrow, throwing
+            /// std::invalid_argument if information would be lost.
+            {
+                static_assert(std::is_integral<Narrow>::value,
+                              "compact record fields must be integers");
+                return compact_value<Narrow>(value, field,
+                                             typename std::is_integral<Wide>::type{});
+            }
+        } // namespace detail
+    }     // namespace ts
+} // namespace fwdpp
+
+#endif
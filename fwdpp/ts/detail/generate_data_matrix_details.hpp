@@ -5,6 +5,8 @@
 #include <vector>
 #include <algorithm>
 #include <fwdpp/data_matrix.hpp>
+#include <fwdpp/packed_data_matrix.hpp>
+#include <fwdpp/sparse_data_matrix.hpp>
 #include "../marginal_tree.hpp"
 #include "../site_visitor.hpp"
 #include "../marginal_tree_functions/samples.hpp"
@@ -15,15 +17,42 @@ namespace fwdpp
     {
         namespace detail
         {
-            template<typename SITE_CONST_ITER, typename MUT_CONST_ITR>
             inline void
-            process_site_range(const marginal_tree & tree,
-                               const SITE_CONST_ITER current_site,
-                               const std::pair<MUT_CONST_ITR,MUT_CONST_ITR> & muts,
-                               bool record_neutral, bool record_selected,
-                               bool skip_fixed,
-                               std::vector<std::int8_t>& genotypes,
-                               data_matrix& dm)
+            append_site(double position, std::int8_t /*ancestral_state*/,
+                        const std::vector<std::int8_t>& genotypes, state_matrix& sm)
+            {
+                sm.positions.push_back(position);
+                sm.data.insert(end(sm.data), begin(genotypes), end(genotypes));
+            }
+
+            inline void
+            append_site(double position, std::int8_t ancestral_state,
+                        const std::vector<std::int8_t>& genotypes,
+                        packed_state_matrix& sm)
+            {
+                sm.push_back_row(position, begin(genotypes), end(genotypes),
+                                 [ancestral_state](std::int8_t g) {
+                                     return g != ancestral_state;
+                                 });
+            }
+
+            struct site_genotypes
+            /// Returned by fill_site_genotypes
+            {
+                /// Number of sample nodes carrying a recorded mutation
+                int nsamples;
+                /// True if the mutations at the site are neutral
+                bool neutral;
+            };
+
+            template<typename SITE_CONST_ITER, typename MUT_CONST_ITR>
+            inline site_genotypes
+            fill_site_genotypes(const marginal_tree & tree,
+                                const SITE_CONST_ITER current_site,
+                                const std::pair<MUT_CONST_ITR,MUT_CONST_ITR> & muts,
+                                bool record_neutral, bool record_selected,
+                                bool skip_fixed,
+                                std::vector<std::int8_t>& genotypes)
             {
                 int neutral = -1, selected = -1;
                 std::fill(begin(genotypes), end(genotypes),
@@ -60,29 +89,80 @@ namespace fwdpp
                         throw tables_error("inconsistent neutral flags in "
                                            "mutation table");
                     }
-                if (nsamples)
+                return site_genotypes{nsamples, neutral != -1};
+            }
+
+            template<typename SITE_CONST_ITER, typename MUT_CONST_ITR>
+            inline site_genotypes
+            fill_site_entries(const marginal_tree & tree,
+                              const SITE_CONST_ITER current_site,
+                              const std::pair<MUT_CONST_ITR,MUT_CONST_ITR> & muts,
+                              bool record_neutral, bool record_selected,
+                              bool skip_fixed, std::size_t samplesize,
+                              std::vector<std::pair<std::uint32_t, std::int8_t>>& entries)
+            /// As fill_site_genotypes, but only the samples below
+            /// each mutation are visited.  entries holds the (sample,
+            /// state) pairs that differ from the ancestral state, sorted
+            /// by sample.
+            {
+                int neutral = -1, selected = -1;
+                entries.clear();
+                int nsamples = 0;
+                convert_sample_index_to_nodes convert(false);
+                for (auto mut = muts.first; mut < muts.second; ++mut)
+                    {
+                        neutral += (mut->neutral == true);
+                        selected += (mut->neutral == false);
+                        std::size_t lc = tree.leaf_counts[mut->node];
+
+                        if ((mut->neutral && record_neutral)
+                            || (!mut->neutral && record_selected))
+                            {
+                                if (lc > 0 && (!skip_fixed || (lc < samplesize)))
+                                    {
+                                        const auto f
+                                            = [mut, &nsamples, &entries](
+                                                  fwdpp::ts::table_index_t u) {
+                                                  ++nsamples;
+                                                  entries.emplace_back(
+                                                      static_cast<std::uint32_t>(u),
+                                                      mut->derived_state);
+                                              };
+                                        process_samples(tree, convert,
+                                                        mut->node, f);
+                                    }
+                            }
+                    }
+                if (neutral != -1 && selected != -1)
+                    {
+                        throw tables_error("inconsistent neutral flags in "
+                                           "mutation table");
+                    }
+                // Later mutations at a site replace the states
+                // set by earlier ones.
+                std::stable_sort(begin(entries), end(entries),
+                                 [](const std::pair<std::uint32_t, std::int8_t>& a,
+                                    const std::pair<std::uint32_t, std::int8_t>& b) {
+                                     return a.first < b.first;
+                                 });
+                // Keep the last state of each sample, and only
+                // if it differs from the ancestral state.  A single
+                // mutation may also have the ancestral state.
+                std::size_t n = 0;
+                for (std::size_t i = 0; i < entries.size(); ++i)
                     {
-                        if (neutral != -1)
+                        if (i + 1 < entries.size()
+                            && entries[i + 1].first == entries[i].first)
                             {
-                                dm.neutral.positions.push_back(
-                                    current_site->position);
-                                dm.neutral_keys.push_back(
-                                    (muts.second - 1)->key);
-                                dm.neutral.data.insert(end(dm.neutral.data),
-                                                       begin(genotypes),
-                                                       end(genotypes));
+                                continue;
                             }
-                        else
+                        if (entries[i].second != current_site->ancestral_state)
                             {
-                                dm.selected.positions.push_back(
-                                    current_site->position);
-                                dm.selected_keys.push_back(
-                                    (muts.second - 1)->key);
-                                dm.selected.data.insert(end(dm.selected.data),
-                                                        begin(genotypes),
-                                                        end(genotypes));
+                                entries[n++] = entries[i];
                             }
                     }
+                entries.resize(n);
+                return site_genotypes{nsamples, neutral != -1};
             }
         } // namespace detail
     }     // namespace ts
@@ -0,0 +1,467 @@
+#ifndef FWDPP_TS_DETAIL_KASTORE_HPP
+#define FWDPP_TS_DETAIL_KASTORE_HPP
+
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <tuple>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include <functional>
+
+namespace fwdpp
+{
+    namespace ts
+    {
+        namespace detail
+        {
+            // The kastore file format, version 1.0.  A file is a
+            // 64 byte header, a 64 byte descriptor per item, the item
+            // keys in sorted order, and then the item arrays in the same
+            // order, each starting at a multiple of 8 bytes.
+            // All values are little-endian.
+            // See https://kastore.readthedocs.io for details.
+
+            constexpr std::size_t kastore_header_size = 64;
+            constexpr std::size_t kastore_descriptor_size = 64;
+            constexpr std::size_t kastore_array_align = 8;
+            constexpr std::uint16_t kastore_version_major = 1;
+            constexpr std::uint16_t kastore_version_minor = 0;
+
+            inline const char*
+            kastore_magic()
+            {
+                return "\211KAS\r\n\032\n";
+            }
+
+            enum kastore_type : std::uint8_t
+            {
+                kastore_int8 = 0,
+                kastore_uint8,
+                kastore_int16,
+                kastore_uint16,
+                kastore_int32,
+                kastore_uint32,
+                kastore_int64,
+                kastore_uint64,
+                kastore_float32,
+                kastore_float64
+            };
+
+            template <typename T> struct kastore_type_code;
+            template <> struct kastore_type_code<std::int8_t>
+            {
+                static constexpr std::uint8_t value = kastore_int8;
+            };
+            template <> struct kastore_type_code<std::uint8_t>
+            {
+                static constexpr std::uint8_t value = kastore_uint8;
+            };
+            template <> struct kastore_type_code<std::int32_t>
+            {
+                static constexpr std::uint8_t value = kastore_int32;
+            };
+            template <> struct kastore_type_code<std::uint32_t>
+            {
+                static constexpr std::uint8_t value = kastore_uint32;
+            };
+            template <> struct kastore_type_code<std::int64_t>
+            {
+                static constexpr std::uint8_t value = kastore_int64;
+            };
+            template <> struct kastore_type_code<std::uint64_t>
+            {
+                static constexpr std::uint8_t value = kastore_uint64;
+            };
+            template <> struct kastore_type_code<double>
+            {
+                static constexpr std::uint8_t value = kastore_float64;
+            };
+
+            inline std::size_t
+            kastore_type_size(std::uint8_t type)
+            {
+                switch (type)
+                    {
+                    case kastore_int8:
+                    case kastore_uint8:
+                        return 1;
+                    case kastore_int16:
+                    case kastore_uint16:
+                        return 2;
+                    case kastore_int32:
+                    case kastore_uint32:
+                    case kastore_float32:
+                        return 4;
+                    case kastore_int64:
+                    case kastore_uint64:
+                    case kastore_float64:
+                        return 8;
+                    default:
+                        throw std::runtime_error("kastore: unknown type code");
+                    }
+            }
+
+            template <typename T>
+            inline void
+            encode_little_endian(T value, char* out)
+            /// Works on hosts of either byte order
+            {
+                unsigned char bytes[sizeof(T)];
+                std::memcpy(bytes, &value, sizeof(T));
+                const std::uint16_t probe = 1;
+                unsigned char first;
+                std::memcpy(&first, &probe, 1);
+                if (first != 1)
+                    {
+                        std::reverse(bytes, bytes + sizeof(T));
+                    }
+                std::memcpy(out, bytes, sizeof(T));
+            }
+
+            template <typename T>
+            inline T
+            decode_little_endian(const char* in)
+            {
+                unsigned char bytes[sizeof(T)];
+                std::memcpy(bytes, in, sizeof(T));
+                const std::uint16_t probe = 1;
+                unsigned char first;
+                std::memcpy(&first, &probe, 1);
+                if (first != 1)
+                    {
+                        std::reverse(bytes, bytes + sizeof(T));
+                    }
+                T rv;
+                std::memcpy(&rv, bytes, sizeof(T));
+                return rv;
+            }
+
+            template <typename ostreamtype> class kastore_array_sink
+            /// Buffered output of the elements of one array
+            {
+              private:
+                ostreamtype& o;
+                std::vector<char> buffer;
+                std::uint64_t bytes;
+
+              public:
+                explicit kastore_array_sink(ostreamtype& out)
+                    : o(out), buffer{}, bytes{0}
+                {
+                    buffer.reserve(1 << 16);
+                }
+
+                template <typename T>
+                void
+                operator()(T value)
+                {
+                    char tmp[sizeof(T)];
+                    encode_little_endian(value, tmp);
+                    buffer.insert(buffer.end(), tmp, tmp + sizeof(T));
+                    bytes += sizeof(T);
+                    if (buffer.size() >= (1 << 16))
+                        {
+                            flush();
+                        }
+                }
+
+                void
+                flush()
+                {
+                    if (!buffer.empty())
+                        {
+                            o.write(buffer.data(), buffer.size());
+                            buffer.clear();
+                        }
+                }
+
+                std::uint64_t
+                bytes_written() const
+                {
+                    return bytes;
+                }
+            };
+
+            template <typename ostreamtype> class kastore_writer
+            /// Streaming writer.  Each item's elements are produced by a
+            /// callback when the file is written, so no copy of the
+            /// arrays is held in memory.
+            {
+              private:
+                struct item
+                {
+                    std::string key;
+                    std::uint8_t type;
+                    std::uint64_t length;
+                    std::function<void(kastore_array_sink<ostreamtype>&)> fill;
+                };
+                std::vector<item> items;
+
+                static void
+                write_padding(ostreamtype& o, std::uint64_t n)
+                {
+                    const char zeros[kastore_array_align] = {};
+                    o.write(zeros, static_cast<std::streamsize>(n));
+                }
+
+              public:
+                kastore_writer() : items{}
+                {
+                }
+
+                template <typename T, typename F>
+                void
+                add(std::string key, std::uint64_t length, F fill)
+                /// \a fill must pass exactly \a length values of
+                /// type T to its argument.
+                {
+                    items.push_back(item{std::move(key), kastore_type_code<T>::value,
+                                         length, std::move(fill)});
+                }
+
+                template <typename T>
+                void
+                add(std::string key, std::vector<T> values)
+                {
+                    const auto length = values.size();
+                    add<T>(std::move(key), length,
+                           [values = std::move(values)](
+                               kastore_array_sink<ostreamtype>& sink) {
+                               for (auto v : values)
+                                   {
+                                       sink(v);
+                                   }
+                           });
+                }
+
+                void
+                write(ostreamtype& o)
+                {
+                    std::sort(begin(items), end(items),
+                              [](const item& a, const item& b) { return a.key < b.key; });
+                    for (std::size_t i = 1; i < items.size(); ++i)
+                        {
+                            if (items[i].key == items[i - 1].key)
+                                {
+                                    throw std::invalid_argument("kastore: duplicate key "
+                                                                + items[i].key);
+                                }
+                        }
+                    std::uint64_t offset
+                        = kastore_header_size + items.size() * kastore_descriptor_size;
+                    std::vector<std::uint64_t> key_start, array_start;
+                    for (auto& i : items)
+                        {
+                            key_start.push_back(offset);
+                            offset += i.key.size();
+                        }
+                    for (auto& i : items)
+                        {
+                            offset = (offset + kastore_array_align - 1)
+                                     / kastore_array_align * kastore_array_align;
+                            array_start.push_back(offset);
+                            offset += i.length * kastore_type_size(i.type);
+                        }
+                    const std::uint64_t file_size = offset;
+
+                    char header[kastore_header_size] = {};
+                    std::memcpy(header, kastore_magic(), 8);
+                    encode_little_endian(kastore_version_major, header + 8);
+                    encode_little_endian(kastore_version_minor, header + 10);
+                    encode_little_endian(static_cast<std::uint32_t>(items.size()),
+                                         header + 12);
+                    encode_little_endian(file_size, header + 16);
+                    o.write(header, kastore_header_size);
+                    for (std::size_t i = 0; i < items.size(); ++i)
+                        {
+                            char d[kastore_descriptor_size] = {};
+                            d[0] = static_cast<char>(items[i].type);
+                            encode_little_endian(key_start[i], d + 8);
+                            encode_little_endian(
+                                static_cast<std::uint64_t>(items[i].key.size()), d + 16);
+                            encode_little_endian(array_start[i], d + 24);
+                            encode_little_endian(items[i].length, d + 32);
+                            o.write(d, kastore_descriptor_size);
+                        }
+                    offset = kastore_header_size + items.size() * kastore_descriptor_size;
+                    for (auto& i : items)
+                        {
+                            o.write(i.key.data(), i.key.size());
+                            offset += i.key.size();
+                        }
+                    for (std::size_t i = 0; i < items.size(); ++i)
+                        {
+                            write_padding(o, array_start[i] - offset);
+                            kastore_array_sink<ostreamtype> sink(o);
+                            items[i].fill(sink);
+                            sink.flush();
+                            const auto expected
+                                = items[i].length * kastore_type_size(items[i].type);
+                            if (sink.bytes_written() != expected)
+                                {
+                                    throw std::logic_error(
+                                        "kastore: wrong amount of data written for "
+                                        + items[i].key);
+                                }
+                            offset = array_start[i] + expected;
+                        }
+                }
+            };
+
+            struct kastore_array
+            /// Raw data of one item read from a kastore file
+            {
+                std::uint8_t type;
+                std::uint64_t length;
+                std::vector<char> data;
+            };
+
+            using kastore_items = std::map<std::string, kastore_array>;
+
+            template <typename istreamtype>
+            inline void
+            kastore_read_bytes(istreamtype& i, char* out, std::uint64_t n)
+            {
+                i.read(out, static_cast<std::streamsize>(n));
+                if (!i)
+                    {
+                        throw std::runtime_error("kastore: unexpected end of file");
+                    }
+            }
+
+            template <typename istreamtype>
+            inline kastore_items
+            read_kastore(istreamtype& i, const std::vector<std::string>& keys)
+            /// Read the items named in \a keys, in one pass over \a i.
+            /// Keys not in the file are ignored.  Other arrays are skipped.
+            {
+                char header[kastore_header_size];
+                kastore_read_bytes(i, header, kastore_header_size);
+                if (std::memcmp(header, kastore_magic(), 8) != 0)
+                    {
+                        throw std::runtime_error("kastore: bad magic number");
+                    }
+                if (decode_little_endian<std::uint16_t>(header + 8)
+                    != kastore_version_major)
+                    {
+                        throw std::runtime_error("kastore: unsupported version");
+                    }
+                const auto num_items = decode_little_endian<std::uint32_t>(header + 12);
+                const auto file_size = decode_little_endian<std::uint64_t>(header + 16);
+                std::vector<char> descriptors(num_items * kastore_descriptor_size);
+                kastore_read_bytes(i, descriptors.data(), descriptors.size());
+                std::uint64_t position = kastore_header_size + descriptors.size();
+
+                struct descriptor
+                {
+                    std::uint8_t type;
+                    std::uint64_t key_start, key_len, array_start, array_len;
+                };
+                std::vector<descriptor> d;
+                std::uint64_t keys_end = position;
+                for (std::uint32_t j = 0; j < num_items; ++j)
+                    {
+                        const char* p = descriptors.data() + j * kastore_descriptor_size;
+                        d.push_back(descriptor{
+                            static_cast<std::uint8_t>(p[0]),
+                            decode_little_endian<std::uint64_t>(p + 8),
+                            decode_little_endian<std::uint64_t>(p + 16),
+                            decode_little_endian<std::uint64_t>(p + 24),
+                            decode_little_endian<std::uint64_t>(p + 32)});
+                        auto& x = d.back();
+                        if (x.key_start < position
+                            || x.array_start + x.array_len * kastore_type_size(x.type)
+                                   > file_size)
+                            {
+                                throw std::runtime_error("kastore: bad item descriptor");
+                            }
+                        keys_end = std::max(keys_end, x.key_start + x.key_len);
+                    }
+                std::vector<char> key_bytes(keys_end - position);
+                kastore_read_bytes(i, key_bytes.data(), key_bytes.size());
+                const auto keys_begin = position;
+                position = keys_end;
+
+                std::vector<std::pair<std::string, descriptor>> wanted;
+                for (auto& x : d)
+                    {
+                        std::string key(key_bytes.data() + (x.key_start - keys_begin),
+                                        x.key_len);
+                        if (std::find(begin(keys), end(keys), key) != end(keys))
+                            {
+                                wanted.emplace_back(std::move(key), x);
+                            }
+                    }
+                std::sort(begin(wanted), end(wanted),
+                          [](const std::pair<std::string, descriptor>& a,
+                             const std::pair<std::string, descriptor>& b) {
+                              // Empty arrays may share a start with the next one
+                              return std::tie(a.second.array_start, a.second.array_len)
+                                     < std::tie(b.second.array_start,
+                                                b.second.array_len);
+                          });
+                kastore_items rv;
+                for (auto& w : wanted)
+                    {
+                        if (w.second.array_start < position)
+                            {
+                                throw std::runtime_error("kastore: overlapping arrays");
+                            }
+                        i.ignore(
+                            static_cast<std::streamsize>(w.second.array_start - position));
+                        kastore_array a{
+                            w.second.type, w.second.array_len,
+                            std::vector<char>(w.second.array_len
+                                              * kastore_type_size(w.second.type))};
+                        kastore_read_bytes(i, a.data.data(), a.data.size());
+                        position = w.second.array_start + a.data.size();
+                        rv.emplace(w.first, std::move(a));
+                    }
+                return rv;
+            }
+
+            template <typename T>
+            inline std::vector<T>
+            kastore_get(const kastore_items& items, const std::string& key)
+            /// Decode an item, which must have type T
+            {
+                auto i = items.find(key);
+                if (i == items.end())
+                    {
+                        throw std::runtime_error("kastore: missing key " + key);
+                    }
+                if (i->second.type != kastore_type_code<T>::value)
+                    {
+                        throw std::runtime_error("kastore: wrong type for key " + key);
+                    }
+                std::vector<T> rv(i->second.length);
+                for (std::size_t j = 0; j < rv.size(); ++j)
+                    {
+                        rv[j] = decode_little_endian<T>(i->second.data.data()
+                                                        + j * sizeof(T));
+                    }
+                return rv;
+            }
+
+            inline std::vector<std::uint64_t>
+            kastore_get_offsets(const kastore_items& items, const std::string& key)
+            /// Decode an offset column, stored as either 32 or 64 bit integers
+            {
+                auto i = items.find(key);
+                if (i != items.end() && i->second.type == kastore_uint32)
+                    {
+                        auto x = kastore_get<std::uint32_t>(items, key);
+                        return std::vector<std::uint64_t>(begin(x), end(x));
+                    }
+                return kastore_get<std::uint64_t>(items, key);
+            }
+        } // namespace detail
+    }     // namespace ts
+} // namespace fwdpp
+
+#endif
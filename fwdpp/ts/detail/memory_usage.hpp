@@ -0,0 +1,32 @@
+#ifndef FWDPP_TS_DETAIL_MEMORY_USAGE_HPP
+#define FWDPP_TS_DETAIL_MEMORY_USAGE_HPP
+
+#include <vector>
+#include <cstddef>
+
+namespace fwdpp
+{
+    namespace ts
+    {
+        namespace detail
+        {
+            template <typename T, typename A>
+            inline std::size_t
+            memory_usage(const std::vector<T, A>& v)
+            /// Bytes allocated by \a v
+            {
+                return v.capacity() * sizeof(T);
+            }
+
+            template <typename Container>
+            inline auto
+            memory_usage(const Container& c) -> decltype(c.memory_usage())
+            /// Containers defined in fwdpp report their own usage
+            {
+                return c.memory_usage();
+            }
+        } // namespace detail
+    }     // namespace ts
+} // namespace fwdpp
+
+#endif
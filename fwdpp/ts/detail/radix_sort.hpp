@@ -0,0 +1,163 @@
+#ifndef FWDPP_TS_DETAIL_RADIX_SORT_HPP
+#define FWDPP_TS_DETAIL_RADIX_SORT_HPP
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <utility>
+#include <algorithm>
+#include <fwdpp/internal/run_in_threads.hpp>
+
+namespace fwdpp
+{
+    namespace ts
+    {
+        namespace detail
+        {
+            template <std::size_t N> struct radix_sort_record
+            /// A row index plus N 64-bit keys.
+            /// key[0] is the most significant.
+            {
+                std::array<std::uint64_t, N> key;
+                std::size_t index;
+            };
+
+            inline std::uint64_t
+            radix_key(double x)
+            /// Map a double to an unsigned integer with the same ordering
+            {
+                if (x == 0.)
+                    {
+                        x = 0.; // -0.0 and 0.0 must compare equal
+                    }
+                std::uint64_t u;
+                std::memcpy(&u, &x, sizeof(double));
+                constexpr std::uint64_t sign = std::uint64_t(1) << 63;
+                return (u & sign) ? ~u : (u | sign);
+            }
+
+            template <std::size_t N>
+            inline unsigned
+            radix_digit(const radix_sort_record<N>& r, std::size_t pass)
+            // Pass 0 is the least significant byte of the last key.
+            {
+                return static_cast<unsigned>((r.key[N - 1 - pass / 8] >> (8 * (pass % 8)))
+                                             & 0xff);
+            }
+
+            /// Below this size, a comparison sort is used.
+            constexpr std::size_t radix_sort_min_size = 256;
+            /// Minimum number of records handled by a thread.
+            constexpr std::size_t radix_sort_min_per_thread = 1 << 15;
+
+            template <std::size_t N>
+            void
+            radix_sort(std::vector<radix_sort_record<N>>& records,
+                       std::vector<radix_sort_record<N>>& buffer, unsigned num_threads)
+            /// \brief Stable LSD radix sort on record keys
+            ///
+            /// Sorts one byte at a time.  Bytes that have the
+            /// same value in all records are skipped, which
+            /// is the common case for the high bytes of
+            /// node times and ids.
+            ///
+            /// If \a num_threads > 1, histograms and scatters
+            /// are done in parallel on contiguous chunks of \a records.
+            ///
+            /// \a buffer is used as scratch space.
+            {
+                constexpr std::size_t npasses = 8 * N;
+                using histogram = std::array<std::size_t, 256>;
+                const std::size_t n = records.size();
+                if (n < radix_sort_min_size)
+                    {
+                        std::stable_sort(begin(records), end(records),
+                                         [](const radix_sort_record<N>& a,
+                                            const radix_sort_record<N>& b) {
+                                             return a.key < b.key;
+                                         });
+                        return;
+                    }
+                num_threads = static_cast<unsigned>(std::max<std::size_t>(
+                    1, std::min<std::size_t>(num_threads,
+                                             n / radix_sort_min_per_thread)));
+                buffer.resize(n);
+                auto chunk_begin = [n, num_threads](unsigned t) {
+                    return n * t / num_threads;
+                };
+
+                // counts[t * npasses + pass] for the initial order.
+                // Totals over threads do not depend on order, so
+                // we use them to find the passes we can skip.
+                std::vector<histogram> counts(num_threads * npasses, histogram{});
+                fwdpp_internal::run_in_threads(num_threads, [&](unsigned t) {
+                    auto c = counts.begin() + t * npasses;
+                    for (auto i = chunk_begin(t); i < chunk_begin(t + 1); ++i)
+                        {
+                            for (std::size_t pass = 0; pass < npasses; ++pass)
+                                {
+                                    ++c[pass][radix_digit(records[i], pass)];
+                                }
+                        }
+                });
+                std::vector<histogram> offsets(num_threads);
+                bool first_pass = true;
+                for (std::size_t pass = 0; pass < npasses; ++pass)
+                    {
+                        bool skip = false;
+                        for (std::size_t d = 0; d < 256 && !skip; ++d)
+                            {
+                                std::size_t total = 0;
+                                for (unsigned t = 0; t < num_threads; ++t)
+                                    {
+                                        total += counts[t * npasses + pass][d];
+                                    }
+                                skip = (total == n);
+                            }
+                        if (skip)
+                            {
+                                continue;
+                            }
+                        if (num_threads > 1 && !first_pass)
+                            // The chunks hold different records
+                            // than when we counted.
+                            {
+                                fwdpp_internal::run_in_threads(
+                                    num_threads, [&](unsigned t) {
+                                        auto& c = counts[t * npasses + pass];
+                                        c.fill(0);
+                                        for (auto i = chunk_begin(t);
+                                             i < chunk_begin(t + 1); ++i)
+                                            {
+                                                ++c[radix_digit(records[i], pass)];
+                                            }
+                                    });
+                            }
+                        first_pass = false;
+                        std::size_t running = 0;
+                        for (std::size_t d = 0; d < 256; ++d)
+                            {
+                                for (unsigned t = 0; t < num_threads; ++t)
+                                    {
+                                        offsets[t][d] = running;
+                                        running += counts[t * npasses + pass][d];
+                                    }
+                            }
+                        fwdpp_internal::run_in_threads(num_threads, [&](unsigned t) {
+                            auto& o = offsets[t];
+                            for (auto i = chunk_begin(t); i < chunk_begin(t + 1); ++i)
+                                {
+                                    buffer[o[radix_digit(records[i], pass)]++]
+                                        = records[i];
+                                }
+                        });
+                        records.swap(buffer);
+                    }
+            }
+        } // namespace detail
+    }     // namespace ts
+} // namespace fwdpp
+
+#endif
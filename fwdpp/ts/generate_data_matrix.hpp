@@ -2,19 +2,200 @@
 #define FWDPP_TS_GENERATE_DATA_MATRIX_HPP
 
 #include <vector>
+#include <algorithm>
 #include <type_traits>
 #include <cstdint>
 #include <stdexcept>
 #include <fwdpp/data_matrix.hpp>
-#include "site_visitor.hpp"
+#include <fwdpp/packed_data_matrix.hpp>
+#include <fwdpp/sparse_data_matrix.hpp>
+#include "variant_visitor.hpp"
 #include "exceptions.hpp"
 #include "marginal_tree_functions/samples.hpp"
 #include "detail/generate_data_matrix_details.hpp"
+#include <fwdpp/internal/run_in_threads.hpp>
 
 namespace fwdpp
 {
     namespace ts
     {
+        namespace detail
+        {
+            template <typename DataMatrixType, typename TableCollectionType,
+                      typename Samples>
+            void
+            fill_rows(const TableCollectionType& tables, const Samples& samples,
+                      const bool record_neutral, const bool record_selected,
+                      const bool skip_fixed, const double start, const double stop,
+                      DataMatrixType& rv)
+            /// Dense matrices are filled from one genotype vector per site
+            {
+                variant_visitor<TableCollectionType> vv(tables, samples, record_neutral,
+                                                        record_selected, skip_fixed,
+                                                        start, stop);
+                while (vv())
+                    {
+                        if (vv.neutral())
+                            {
+                                append_site(vv.position(), vv.ancestral_state(),
+                                            vv.genotypes(), rv.neutral);
+                                rv.neutral_keys.push_back(vv.key());
+                            }
+                        else
+                            {
+                                append_site(vv.position(), vv.ancestral_state(),
+                                            vv.genotypes(), rv.selected);
+                                rv.selected_keys.push_back(vv.key());
+                            }
+                    }
+            }
+
+            template <typename TableCollectionType, typename Samples>
+            void
+            fill_rows(const TableCollectionType& tables, const Samples& samples,
+                      const bool record_neutral, const bool record_selected,
+                      const bool skip_fixed, const double start, const double stop,
+                      sparse_data_matrix& rv)
+            /// Sparse matrices are filled from the sample lists
+            /// below each mutation
+            {
+                site_visitor<TableCollectionType> sv(tables, samples, start);
+                std::vector<std::pair<std::uint32_t, std::int8_t>> entries;
+                decltype(sv()) itr;
+                while ((itr = sv()) != sv.end() && itr->position < stop)
+                    {
+                        auto muts = sv.get_mutations();
+                        auto site = fill_site_entries(sv.current_tree(), itr, muts,
+                                                      record_neutral, record_selected,
+                                                      skip_fixed, samples.size(), entries);
+                        if (site.nsamples)
+                            {
+                                if (site.neutral)
+                                    {
+                                        rv.neutral.push_back_row(itr->position, entries);
+                                        rv.neutral_keys.push_back((muts.second - 1)->key);
+                                    }
+                                else
+                                    {
+                                        rv.selected.push_back_row(itr->position, entries);
+                                        rv.selected_keys.push_back(
+                                            (muts.second - 1)->key);
+                                    }
+                            }
+                    }
+            }
+
+            template <typename DataMatrixType, typename TableCollectionType,
+                      typename Samples>
+            DataMatrixType
+            fill_data_matrix(const TableCollectionType& tables, Samples&& samples,
+                             const bool record_neutral, const bool record_selected,
+                             const bool skip_fixed, const double start,
+                             const double stop)
+            {
+                if (!(stop > start))
+                    {
+                        throw std::invalid_argument("invalid position range");
+                    }
+                DataMatrixType rv(samples.size());
+                fill_rows(tables, samples, record_neutral, record_selected, skip_fixed,
+                          start, stop, rv);
+                return rv;
+            }
+
+            template <typename StateMatrixType>
+            inline void
+            append_rows(StateMatrixType& sm, const StateMatrixType& other)
+            {
+                sm.data.insert(end(sm.data), begin(other.data), end(other.data));
+                sm.positions.insert(end(sm.positions), begin(other.positions),
+                                    end(other.positions));
+            }
+
+            inline void
+            append_rows(sparse_state_matrix& sm, const sparse_state_matrix& other)
+            {
+                const auto offset = sm.columns.size();
+                for (std::size_t i = 1; i < other.row_offsets.size(); ++i)
+                    {
+                        sm.row_offsets.push_back(offset + other.row_offsets[i]);
+                    }
+                sm.columns.insert(end(sm.columns), begin(other.columns),
+                                  end(other.columns));
+                sm.states.insert(end(sm.states), begin(other.states), end(other.states));
+                sm.positions.insert(end(sm.positions), begin(other.positions),
+                                    end(other.positions));
+            }
+
+            template <typename DataMatrixType, typename TableCollectionType,
+                      typename Samples>
+            DataMatrixType
+            fill_data_matrix(const TableCollectionType& tables, Samples&& samples,
+                             const bool record_neutral, const bool record_selected,
+                             const bool skip_fixed, const double start,
+                             const double stop, unsigned num_threads)
+            /// Split [start, stop) into chunks with equal numbers of sites,
+            /// fill a matrix for each chunk in its own thread, and
+            /// concatenate the rows.
+            {
+                if (!(stop > start))
+                    {
+                        throw std::invalid_argument("invalid position range");
+                    }
+                auto position_less
+                    = [](typename TableCollectionType::site_table::const_reference s,
+                         double x) { return s.position < x; };
+                const auto first_site = static_cast<std::size_t>(
+                    std::lower_bound(begin(tables.sites), end(tables.sites), start,
+                                     position_less)
+                    - begin(tables.sites));
+                const auto last_site = static_cast<std::size_t>(
+                    std::lower_bound(begin(tables.sites), end(tables.sites), stop,
+                                     position_less)
+                    - begin(tables.sites));
+                const auto num_sites = last_site - first_site;
+                const auto num_chunks = static_cast<unsigned>(
+                    std::min<std::size_t>(num_threads, num_sites));
+                if (num_chunks < 2)
+                    {
+                        return fill_data_matrix<DataMatrixType>(
+                            tables, samples, record_neutral, record_selected,
+                            skip_fixed, start, stop);
+                    }
+                std::vector<double> breakpoints{start};
+                for (unsigned c = 1; c < num_chunks; ++c)
+                    {
+                        breakpoints.push_back(
+                            tables.sites[first_site + num_sites * c / num_chunks]
+                                .position);
+                    }
+                breakpoints.push_back(stop);
+                std::vector<DataMatrixType> chunks(num_chunks,
+                                                   DataMatrixType(samples.size()));
+                fwdpp_internal::run_in_threads(num_chunks, [&](unsigned c) {
+                    if (breakpoints[c + 1] > breakpoints[c])
+                        {
+                            chunks[c] = fill_data_matrix<DataMatrixType>(
+                                tables, samples, record_neutral, record_selected,
+                                skip_fixed, breakpoints[c], breakpoints[c + 1]);
+                        }
+                });
+                DataMatrixType rv(std::move(chunks[0]));
+                for (unsigned c = 1; c < num_chunks; ++c)
+                    {
+                        append_rows(rv.neutral, chunks[c].neutral);
+                        append_rows(rv.selected, chunks[c].selected);
+                        rv.neutral_keys.insert(end(rv.neutral_keys),
+                                               begin(chunks[c].neutral_keys),
+                                               end(chunks[c].neutral_keys));
+                        rv.selected_keys.insert(end(rv.selected_keys),
+                                                begin(chunks[c].selected_keys),
+                                                end(chunks[c].selected_keys));
+                    }
+                return rv;
+            }
+        } // namespace detail
+
         template <typename TableCollectionType, typename Samples>
         data_matrix
         generate_data_matrix(const TableCollectionType& tables, Samples&& samples,
@@ -27,27 +208,34 @@ namespace fwdpp
         /// \version 0.7.4 Add [start, stop) arguments. Add option to skip fixed variants.
         /// \version 0.8.0 No longer requires mutation vector. Function body re-implemented.
         /// \version 0.9.0 Added typename TableCollectionType
+        /// \version 0.10.0 Implemented with fwdpp::ts::variant_visitor.  To process
+        /// one site at a time without storing the matrix, use that type directly.
         {
-            if (!(stop > start))
-                {
-                    throw std::invalid_argument("invalid position range");
-                }
-            std::size_t samplesize = samples.size();
-            std::vector<std::int8_t> genotypes(samplesize);
-            site_visitor<TableCollectionType> sv(tables, samples);
-            data_matrix rv(samplesize);
-            decltype(sv()) itr;
-            while ((itr = sv()) != end(sv))
-                {
-                    if (itr->position >= start && itr->position < stop)
-                        {
-                            const auto& tree = sv.current_tree();
-                            detail::process_site_range(tree, itr, sv.get_mutations(),
-                                                       record_neutral, record_selected,
-                                                       skip_fixed, genotypes, rv);
-                        }
-                }
-            return rv;
+            return detail::fill_data_matrix<data_matrix>(
+                tables, std::forward<Samples>(samples), record_neutral, record_selected,
+                skip_fixed, start, stop);
+        }
+
+        template <typename TableCollectionType, typename Samples>
+        data_matrix
+        generate_data_matrix(const TableCollectionType& tables, Samples&& samples,
+                             const bool record_neutral, const bool record_selected,
+                             const bool skip_fixed, const double start,
+                             const double stop, const unsigned num_threads)
+        /// Multi-threaded version of fwdpp::ts::generate_data_matrix.
+        ///
+        /// [start, stop) is divided into up to \a num_threads chunks holding
+        /// equal numbers of sites.  Each chunk is processed by a separate
+        /// fwdpp::ts::variant_visitor, whose first tree is found with
+        /// tree_visitor::seek.  The rows of the chunks are concatenated in
+        /// position order, so the return value is the same as for the
+        /// single-threaded version.
+        ///
+        /// \version 0.10.0 Added to library
+        {
+            return detail::fill_data_matrix<data_matrix>(
+                tables, std::forward<Samples>(samples), record_neutral, record_selected,
+                skip_fixed, start, stop, num_threads);
         }
 
         template <typename TableCollectionType, typename Samples>
@@ -61,6 +249,85 @@ namespace fwdpp
                                         tables.genome_length());
         }
 
+        template <typename TableCollectionType, typename Samples>
+        packed_data_matrix
+        generate_packed_data_matrix(const TableCollectionType& tables,
+                                    Samples&& samples, const bool record_neutral,
+                                    const bool record_selected, const bool skip_fixed,
+                                    const double start, const double stop)
+        /// Same as fwdpp::ts::generate_data_matrix, but the rows are
+        /// bit-packed, with 1 for any state other than the ancestral state.
+        /// Only one site is unpacked at a time, so the memory used is about
+        /// one eighth of that of generate_data_matrix.
+        /// \version 0.10.0 Added to library
+        {
+            return detail::fill_data_matrix<packed_data_matrix>(
+                tables, std::forward<Samples>(samples), record_neutral, record_selected,
+                skip_fixed, start, stop);
+        }
+
+        template <typename TableCollectionType, typename Samples>
+        packed_data_matrix
+        generate_packed_data_matrix(const TableCollectionType& tables,
+                                    Samples&& samples, const bool record_neutral,
+                                    const bool record_selected, const bool skip_fixed,
+                                    const double start, const double stop,
+                                    const unsigned num_threads)
+        /// Multi-threaded version of fwdpp::ts::generate_packed_data_matrix.
+        /// See the multi-threaded fwdpp::ts::generate_data_matrix for details.
+        /// \version 0.10.0 Added to library
+        {
+            return detail::fill_data_matrix<packed_data_matrix>(
+                tables, std::forward<Samples>(samples), record_neutral, record_selected,
+                skip_fixed, start, stop, num_threads);
+        }
+
+        template <typename TableCollectionType, typename Samples>
+        packed_data_matrix
+        generate_packed_data_matrix(const TableCollectionType& tables,
+                                    Samples&& samples, const bool record_neutral,
+                                    const bool record_selected, const bool skip_fixed)
+        /// \version 0.10.0 Added to library
+        {
+            return generate_packed_data_matrix(
+                tables, std::forward<Samples>(samples), record_neutral, record_selected,
+                skip_fixed, 0., tables.genome_length());
+        }
+        template <typename TableCollectionType, typename Samples>
+        sparse_data_matrix
+        generate_sparse_data_matrix(const TableCollectionType& tables,
+                                    Samples&& samples, const bool record_neutral,
+                                    const bool record_selected, const bool skip_fixed,
+                                    const double start, const double stop,
+                                    const unsigned num_threads = 1)
+        /// Same as fwdpp::ts::generate_data_matrix, but returns a
+        /// fwdpp::sparse_data_matrix.  For each site, only the samples
+        /// below its mutations are visited, using the sample lists of the
+        /// marginal tree.  Memory use and run time therefore scale with
+        /// the number of derived alleles rather than with the number of
+        /// sites times the number of samples.
+        ///
+        /// See the multi-threaded fwdpp::ts::generate_data_matrix
+        /// for the meaning of \a num_threads.
+        ///
+        /// \version 0.10.0 Added to library
+        {
+            return detail::fill_data_matrix<sparse_data_matrix>(
+                tables, std::forward<Samples>(samples), record_neutral, record_selected,
+                skip_fixed, start, stop, num_threads);
+        }
+
+        template <typename TableCollectionType, typename Samples>
+        sparse_data_matrix
+        generate_sparse_data_matrix(const TableCollectionType& tables,
+                                    Samples&& samples, const bool record_neutral,
+                                    const bool record_selected, const bool skip_fixed)
+        /// \version 0.10.0 Added to library
+        {
+            return generate_sparse_data_matrix(
+                tables, std::forward<Samples>(samples), record_neutral, record_selected,
+                skip_fixed, 0., tables.genome_length());
+        }
     } // namespace ts
 } // namespace fwdpp
 
@@ -0,0 +1,300 @@
+#ifndef FWDPP_TS_IBD_SEGMENTS_HPP
+#define FWDPP_TS_IBD_SEGMENTS_HPP
+
+#include <cstdint>
+#include <vector>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include "definitions.hpp"
+#include "tree_visitor.hpp"
+#include "marginal_tree_functions/samples.hpp"
+
+namespace fwdpp
+{
+    namespace ts
+    {
+        struct ibd_segment
+        /// \brief A genomic interval over which two nodes share an MRCA
+        /// \version 0.10.0 Added to fwdpp
+        {
+            /// The two nodes
+            table_index_t a, b;
+            /// The half-open interval [left, right)
+            double left, right;
+            /// The MRCA of a and b
+            table_index_t node;
+            /// Time from node to the more recent of a and b
+            double tmrca;
+        };
+
+        inline std::vector<std::pair<table_index_t, table_index_t>>
+        all_pairs(const std::vector<table_index_t>& group)
+        /// All pairs of distinct nodes in \a group
+        /// \version 0.10.0 Added to fwdpp
+        {
+            std::vector<std::pair<table_index_t, table_index_t>> rv;
+            for (std::size_t i = 0; i < group.size(); ++i)
+                {
+                    for (std::size_t j = i + 1; j < group.size(); ++j)
+                        {
+                            rv.emplace_back(group[i], group[j]);
+                        }
+                }
+            return rv;
+        }
+
+        inline std::vector<std::pair<table_index_t, table_index_t>>
+        all_pairs(const std::vector<table_index_t>& group_a,
+                  const std::vector<table_index_t>& group_b)
+        /// All pairs with one node from each group
+        /// \version 0.10.0 Added to fwdpp
+        {
+            std::vector<std::pair<table_index_t, table_index_t>> rv;
+            for (auto a : group_a)
+                {
+                    for (auto b : group_b)
+                        {
+                            rv.emplace_back(a, b);
+                        }
+                }
+            return rv;
+        }
+
+        template <typename TableCollectionType> class ibd_finder
+        /*! \brief Find IBD segments between pairs of nodes
+         *
+         *  A segment is a maximal interval over which a pair of
+         *  nodes has the same MRCA.  Trees are visited from left to
+         *  right.  When moving to the next tree, only the samples
+         *  below the child nodes of removed and inserted edges can
+         *  have new ancestors.  Only the pairs that contain one of
+         *  these samples are updated, and the MRCAs of the other
+         *  pairs are carried over.
+         *
+         *  A segment is reported if its length is at least
+         *  \a min_length and its tmrca is at most \a max_tmrca.
+         *
+         *  \version 0.10.0 Added to fwdpp
+         */
+        {
+          private:
+            struct pair_state
+            {
+                std::int32_t a, b; // sample indexes
+                table_index_t mrca;
+                double left;
+                std::uint32_t updated;
+            };
+
+            const TableCollectionType& tables;
+            std::vector<table_index_t> samples;
+            std::vector<pair_state> pairs;
+            // Pairs containing each sample, in CSR format
+            std::vector<std::size_t> pair_offsets, pairs_of_sample;
+            double min_length, max_tmrca;
+
+            std::vector<table_index_t>
+            init_samples(const std::vector<std::pair<table_index_t, table_index_t>>& p)
+            {
+                std::vector<table_index_t> rv;
+                for (auto& i : p)
+                    {
+                        if (i.first < 0 || i.second < 0
+                            || static_cast<std::size_t>(i.first) >= tables.num_nodes()
+                            || static_cast<std::size_t>(i.second)
+                                   >= tables.num_nodes())
+                            {
+                                throw std::invalid_argument("node index out of range");
+                            }
+                        if (i.first == i.second)
+                            {
+                                throw std::invalid_argument(
+                                    "a pair must contain two different nodes");
+                            }
+                        rv.push_back(i.first);
+                        rv.push_back(i.second);
+                    }
+                std::sort(begin(rv), end(rv));
+                rv.erase(std::unique(begin(rv), end(rv)), end(rv));
+                return rv;
+            }
+
+            std::int32_t
+            sample_index(table_index_t u) const
+            {
+                return static_cast<std::int32_t>(
+                    std::lower_bound(begin(samples), end(samples), u) - begin(samples));
+            }
+
+            template <typename F>
+            void
+            end_segment(pair_state& p, double right, const F& f) const
+            {
+                if (p.mrca == NULL_INDEX || right - p.left < min_length)
+                    {
+                        return;
+                    }
+                const auto a = samples[p.a], b = samples[p.b];
+                const double t = std::max(tables.nodes[a].time, tables.nodes[b].time)
+                                 - tables.nodes[p.mrca].time;
+                if (t <= max_tmrca)
+                    {
+                        f(ibd_segment{a, b, p.left, right, p.mrca, t});
+                    }
+            }
+
+          public:
+            ibd_finder(const TableCollectionType& tables_,
+                       const std::vector<std::pair<table_index_t, table_index_t>>& pairs_,
+                       double min_length_ = 0.,
+                       double max_tmrca_ = std::numeric_limits<double>::infinity())
+                /// \param tables_ Indexed tables
+                /// \param pairs_ The pairs of nodes to compare
+                /// \param min_length_ Minimum length of a reported segment
+                /// \param max_tmrca_ Maximum tmrca of a reported segment
+                : tables(tables_), samples(init_samples(pairs_)), pairs{},
+                  pair_offsets(samples.size() + 1, 0), pairs_of_sample(2 * pairs_.size()),
+                  min_length(min_length_), max_tmrca(max_tmrca_)
+            {
+                if (pairs_.empty())
+                    {
+                        throw std::invalid_argument("empty list of pairs");
+                    }
+                if (!(min_length >= 0.) || !(max_tmrca >= 0.))
+                    {
+                        throw std::invalid_argument(
+                            "min_length and max_tmrca must be non-negative");
+                    }
+                for (auto& p : pairs_)
+                    {
+                        pairs.push_back(
+                            pair_state{sample_index(p.first), sample_index(p.second),
+                                       NULL_INDEX, 0., 0});
+                        ++pair_offsets[pairs.back().a + 1];
+                        ++pair_offsets[pairs.back().b + 1];
+                    }
+                std::partial_sum(begin(pair_offsets), end(pair_offsets),
+                                 begin(pair_offsets));
+                auto next = pair_offsets;
+                for (std::size_t i = 0; i < pairs.size(); ++i)
+                    {
+                        pairs_of_sample[next[pairs[i].a]++] = i;
+                        pairs_of_sample[next[pairs[i].b]++] = i;
+                    }
+            }
+
+            template <typename F>
+            void
+            operator()(const F& f)
+            /// Call \a f(const ibd_segment &) for each segment.
+            /// Segments are reported when they end, so they are
+            /// sorted by right end.
+            {
+                tree_visitor<TableCollectionType> tv(tables, samples,
+                                                     update_samples_list(true));
+                auto j = tables.input_left.cbegin(), jM = tables.input_left.cend();
+                auto k = tables.output_right.cbegin(), kM = tables.output_right.cend();
+                const auto edges = begin(tables.edges);
+                std::vector<std::uint32_t> path_stamp(tables.num_nodes(), 0),
+                    affected_stamp(samples.size(), 0);
+                std::vector<std::int32_t> affected;
+                std::uint32_t path = 0, round = 0;
+                convert_sample_index_to_nodes convert(false);
+                for (auto& p : pairs)
+                    {
+                        p.mrca = NULL_INDEX;
+                        p.left = 0.;
+                        p.updated = 0;
+                    }
+                while (tv())
+                    {
+                        const auto& tree = tv.tree();
+                        const double x = tree.left;
+                        ++round;
+                        affected.clear();
+                        const auto mark = [&](table_index_t s) {
+                            if (affected_stamp[s] != round)
+                                {
+                                    affected_stamp[s] = round;
+                                    affected.push_back(s);
+                                }
+                        };
+                        if (round == 1)
+                            {
+                                for (std::size_t s = 0; s < samples.size(); ++s)
+                                    {
+                                        mark(static_cast<table_index_t>(s));
+                                    }
+                            }
+                        for (; k < kM && (edges + *k)->right == x; ++k)
+                            {
+                                process_samples(tree, convert, (edges + *k)->child, mark);
+                            }
+                        for (; j < jM && (edges + *j)->left == x; ++j)
+                            {
+                                process_samples(tree, convert, (edges + *j)->child, mark);
+                            }
+                        for (auto s : affected)
+                            {
+                                ++path;
+                                for (auto u = samples[s]; u != NULL_INDEX;
+                                     u = tree.parents[u])
+                                    {
+                                        path_stamp[u] = path;
+                                    }
+                                for (auto i = pair_offsets[s]; i < pair_offsets[s + 1];
+                                     ++i)
+                                    {
+                                        auto& p = pairs[pairs_of_sample[i]];
+                                        if (p.updated == round)
+                                            {
+                                                continue;
+                                            }
+                                        p.updated = round;
+                                        auto u = samples[p.a == s ? p.b : p.a];
+                                        while (u != NULL_INDEX && path_stamp[u] != path)
+                                            {
+                                                u = tree.parents[u];
+                                            }
+                                        if (u != p.mrca)
+                                            {
+                                                end_segment(p, x, f);
+                                                p.mrca = u;
+                                                p.left = x;
+                                            }
+                                    }
+                            }
+                    }
+                for (auto& p : pairs)
+                    {
+                        end_segment(p, tables.genome_length(), f);
+                    }
+            }
+        };
+
+        template <typename TableCollectionType>
+        std::vector<ibd_segment>
+        ibd_segments(const TableCollectionType& tables,
+                     const std::vector<std::pair<table_index_t, table_index_t>>& pairs,
+                     double min_length = 0.,
+                     double max_tmrca = std::numeric_limits<double>::infinity())
+        /*! \brief Return the IBD segments of pairs of nodes
+         *
+         *  See fwdpp::ts::ibd_finder for details.  Segments are
+         *  sorted by right end.
+         *
+         *  \version 0.10.0 Added to fwdpp
+         */
+        {
+            std::vector<ibd_segment> rv;
+            ibd_finder<TableCollectionType>(tables, pairs, min_length, max_tmrca)(
+                [&rv](const ibd_segment& s) { rv.push_back(s); });
+            return rv;
+        }
+    } // namespace ts
+} // namespace fwdpp
+
+#endif
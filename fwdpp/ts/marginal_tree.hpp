@@ -54,6 +54,10 @@ namespace fwdpp
             std::size_t num_nodes;
             std::vector<std::int32_t> sample_groups;
             std::vector<table_index_t> samples_list;
+            // The first num_leaf_samples elements of samples_list
+            // contribute to leaf_counts.  The rest are preserved
+            // nodes and contribute to preserved_leaf_counts.
+            std::size_t num_leaf_samples;
             bool advancing_sample_list_;
 
             std::vector<std::int32_t>
@@ -191,6 +195,7 @@ namespace fwdpp
                 : num_nodes(nnodes),
                   sample_groups(fill_sample_groups(samples)),
                   samples_list(init_samples_list(samples)),
+                  num_leaf_samples(samples_list.size()),
                   advancing_sample_list_(advancing_sample_list),
                   parents(nnodes, NULL_INDEX), leaf_counts(nnodes, 0),
                   preserved_leaf_counts(nnodes, 0),
@@ -233,6 +238,7 @@ namespace fwdpp
                 : num_nodes(nnodes),
                   sample_groups(fill_sample_groups(samples, preserved_nodes)),
                   samples_list(init_samples_list(samples, preserved_nodes)),
+                  num_leaf_samples(samples.size()),
                   advancing_sample_list_(advancing_sample_list),
                   parents(nnodes, NULL_INDEX), leaf_counts(nnodes, 0),
                   preserved_leaf_counts(nnodes, 0),
@@ -269,7 +275,8 @@ namespace fwdpp
 
             marginal_tree(table_index_t nnodes)
                 : num_nodes(nnodes), sample_groups{}, samples_list{},
-                  advancing_sample_list_(false), parents(nnodes, NULL_INDEX),
+                  num_leaf_samples(0), advancing_sample_list_(false),
+                  parents(nnodes, NULL_INDEX),
                   leaf_counts{}, preserved_leaf_counts{},
                   left_sib(nnodes, NULL_INDEX),
                   right_sib(nnodes, NULL_INDEX),
@@ -288,6 +295,48 @@ namespace fwdpp
             {
             }
 
+            void
+            reset()
+            /// Return to the state after construction, in which
+            /// there are no edges and each sample is a root.
+            /// Sample lists and groups are kept.
+            /// \version 0.10.0 Added to fwdpp
+            {
+                std::fill(begin(parents), end(parents), NULL_INDEX);
+                std::fill(begin(leaf_counts), end(leaf_counts), 0);
+                std::fill(begin(preserved_leaf_counts), end(preserved_leaf_counts),
+                          0);
+                std::fill(begin(left_sib), end(left_sib), NULL_INDEX);
+                std::fill(begin(right_sib), end(right_sib), NULL_INDEX);
+                std::fill(begin(left_child), end(left_child), NULL_INDEX);
+                std::fill(begin(right_child), end(right_child), NULL_INDEX);
+                std::fill(begin(left_sample), end(left_sample), NULL_INDEX);
+                std::fill(begin(right_sample), end(right_sample), NULL_INDEX);
+                std::fill(begin(next_sample), end(next_sample), NULL_INDEX);
+                std::fill(begin(sample_index_map), end(sample_index_map),
+                          NULL_INDEX);
+                std::fill(begin(above_sample), end(above_sample), 0);
+                left = right = std::numeric_limits<double>::quiet_NaN();
+                left_root = NULL_INDEX;
+                if (samples_list.empty())
+                    {
+                        return;
+                    }
+                init_samples();
+                for (std::size_t i = 0; i < samples_list.size(); ++i)
+                    {
+                        if (i < num_leaf_samples)
+                            {
+                                leaf_counts[samples_list[i]] = 1;
+                            }
+                        else
+                            {
+                                preserved_leaf_counts[samples_list[i]] = 1;
+                            }
+                    }
+                left_root = samples_list[0];
+            }
+
             int
             num_roots() const
             /// Return number of roots
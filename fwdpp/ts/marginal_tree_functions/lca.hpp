@@ -0,0 +1,260 @@
+#ifndef FWDPP_TS_MARGINAL_TREE_FUNCTIONS_LCA_HPP
+#define FWDPP_TS_MARGINAL_TREE_FUNCTIONS_LCA_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <limits>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include "../marginal_tree.hpp"
+
+namespace fwdpp
+{
+    namespace ts
+    {
+        class lca_index
+        /*! \brief Constant-time lowest common ancestor queries on a marginal_tree
+         *
+         *  The index is an Euler tour of each tree in the forest and
+         *  a sparse table of range minima of node depths along the
+         *  tour.  Building takes O(n log n) time for a tree with n
+         *  nodes, and each query then takes O(1) time, compared to
+         *  O(depth) for walking up the parents array.
+         *
+         *  Building is only worthwhile when there are many queries
+         *  per tree.  update() rebuilds the index only if the tree
+         *  has changed since the last build, so it can be called
+         *  before every query.  No work is done for trees that are
+         *  not queried.  The vectors are reused, so memory is only
+         *  allocated when a tree is larger than any seen before.
+         *
+         *  \code
+         *  fwdpp::ts::lca_index index;
+         *  while (tv())
+         *  {
+         *      index.update(tv.tree());
+         *      auto m = index.lca(a, b);
+         *  }
+         *  \endcode
+         *
+         *  \headerfile fwdpp/ts/marginal_tree_functions/lca.hpp
+         *  \version 0.10.0 Added to fwdpp
+         */
+        {
+          private:
+            const marginal_tree* tree;
+            double left, right;
+            // Position of each node's first visit in the tour, or -1
+            // if the node is not in the tree.
+            std::vector<std::int32_t> first_visit;
+            // Index of the root of each node's tree
+            std::vector<std::int32_t> component;
+            std::vector<table_index_t> tour;
+            std::vector<std::int32_t> tour_depth;
+            // sparse_table[k * tour.size() + i] is the position of
+            // the minimum depth in tour[i, i + 2^k).
+            std::vector<std::int32_t> sparse_table;
+            std::vector<std::uint8_t> floor_log2;
+            std::vector<std::pair<table_index_t, table_index_t>> stack;
+
+            void
+            visit(table_index_t u, std::int32_t depth, std::int32_t c)
+            {
+                if (first_visit[u] == -1)
+                    {
+                        first_visit[u] = static_cast<std::int32_t>(tour.size());
+                        component[u] = c;
+                    }
+                tour.push_back(u);
+                tour_depth.push_back(depth);
+            }
+
+            std::int32_t
+            shallower(std::int32_t a, std::int32_t b) const
+            {
+                return tour_depth[a] <= tour_depth[b] ? a : b;
+            }
+
+            void
+            euler_tour(const marginal_tree& m)
+            {
+                tour.clear();
+                tour_depth.clear();
+                first_visit.assign(m.size(), -1);
+                component.assign(m.size(), -1);
+                std::int32_t c = 0;
+                for (auto r = m.left_root; r != NULL_INDEX; r = m.right_sib[r], ++c)
+                    {
+                        visit(r, 0, c);
+                        stack.clear();
+                        stack.emplace_back(r, m.left_child[r]);
+                        while (!stack.empty())
+                            {
+                                auto& top = stack.back();
+                                if (top.second != NULL_INDEX)
+                                    {
+                                        auto v = top.second;
+                                        top.second = m.right_sib[v];
+                                        visit(v, static_cast<std::int32_t>(stack.size()),
+                                              c);
+                                        stack.emplace_back(v, m.left_child[v]);
+                                    }
+                                else
+                                    {
+                                        stack.pop_back();
+                                        if (!stack.empty())
+                                            {
+                                                visit(stack.back().first,
+                                                      static_cast<std::int32_t>(
+                                                          stack.size() - 1),
+                                                      c);
+                                            }
+                                    }
+                            }
+                    }
+            }
+
+            void
+            build_sparse_table()
+            {
+                const auto n = tour.size();
+                floor_log2.assign(n + 1, 0);
+                for (std::size_t i = 2; i <= n; ++i)
+                    {
+                        floor_log2[i] = floor_log2[i / 2] + 1;
+                    }
+                const std::size_t levels = n ? floor_log2[n] + 1 : 0;
+                sparse_table.resize(levels * n);
+                for (std::size_t i = 0; i < n; ++i)
+                    {
+                        sparse_table[i] = static_cast<std::int32_t>(i);
+                    }
+                for (std::size_t k = 1; k < levels; ++k)
+                    {
+                        const std::size_t half = std::size_t{1} << (k - 1);
+                        const auto prev = sparse_table.begin() + (k - 1) * n;
+                        const auto curr = sparse_table.begin() + k * n;
+                        for (std::size_t i = 0; i + 2 * half <= n; ++i)
+                            {
+                                curr[i] = shallower(prev[i], prev[i + half]);
+                            }
+                    }
+            }
+
+          public:
+            lca_index()
+                : tree(nullptr), left(std::numeric_limits<double>::quiet_NaN()),
+                  right(std::numeric_limits<double>::quiet_NaN()), first_visit{},
+                  component{}, tour{}, tour_depth{}, sparse_table{}, floor_log2{},
+                  stack{}
+            {
+            }
+
+            explicit lca_index(const marginal_tree& m) : lca_index()
+            {
+                build(m);
+            }
+
+            void
+            build(const marginal_tree& m)
+            /// Build the index for \a m
+            {
+                euler_tour(m);
+                build_sparse_table();
+                tree = &m;
+                left = m.left;
+                right = m.right;
+            }
+
+            bool
+            update(const marginal_tree& m)
+            /// Build the index unless it was last built for the
+            /// same object when it had the same genomic interval.
+            /// This assumes that \a m is only changed by a
+            /// fwdpp::ts::tree_visitor, which changes the interval
+            /// whenever it changes the tree.
+            ///
+            /// \return true if the index was rebuilt
+            {
+                if (&m == tree && m.left == left && m.right == right)
+                    {
+                        return false;
+                    }
+                build(m);
+                return true;
+            }
+
+            table_index_t
+            lca(table_index_t u, table_index_t v) const
+            /// Return the lowest common ancestor of nodes \a u and \a v,
+            /// or fwdpp::ts::NULL_INDEX if they are not in the same tree.
+            /// A node is its own ancestor.
+            ///
+            /// \throw std::invalid_argument if a node is out of range
+            {
+                if (u < 0 || v < 0 || static_cast<std::size_t>(u) >= first_visit.size()
+                    || static_cast<std::size_t>(v) >= first_visit.size())
+                    {
+                        throw std::invalid_argument("node index out of range");
+                    }
+                auto a = first_visit[u];
+                auto b = first_visit[v];
+                if (a == -1 || b == -1 || component[u] != component[v])
+                    {
+                        return NULL_INDEX;
+                    }
+                if (a > b)
+                    {
+                        std::swap(a, b);
+                    }
+                const auto n = tour.size();
+                const auto k = floor_log2[b - a + 1];
+                const auto x = sparse_table[k * n + a];
+                const auto y = sparse_table[k * n + b - (std::int32_t{1} << k) + 1];
+                return tour[shallower(x, y)];
+            }
+        };
+
+        template <typename NodeTableType>
+        void
+        pairwise_tmrca(const lca_index& index, const NodeTableType& nodes,
+                       const std::vector<table_index_t>& samples,
+                       std::vector<double>& tmrca)
+        /*! \brief Time to the most recent common ancestor of all pairs of samples
+         *
+         *  For samples i < j, element i * n - i * (i + 1) / 2 + j - i - 1
+         *  of \a tmrca is the time from the MRCA of samples[i] and
+         *  samples[j] to the more recent of the two.  This is the
+         *  upper triangle of the n by n matrix, in row-major order.
+         *  Pairs without a common ancestor get NaN.
+         *
+         *  \param index An index built for the current tree
+         *  \param nodes The node table
+         *  \param samples Node ids
+         *  \param tmrca Output.  Resized to n(n - 1)/2.
+         *
+         *  \version 0.10.0 Added to fwdpp
+         */
+        {
+            const auto n = samples.size();
+            tmrca.resize(n > 1 ? n * (n - 1) / 2 : 0);
+            std::size_t k = 0;
+            for (std::size_t i = 0; i + 1 < n; ++i)
+                {
+                    const auto ti = nodes[samples[i]].time;
+                    for (std::size_t j = i + 1; j < n; ++j, ++k)
+                        {
+                            const auto m = index.lca(samples[i], samples[j]);
+                            tmrca[k] = (m == NULL_INDEX)
+                                           ? std::numeric_limits<double>::quiet_NaN()
+                                           : std::max(ti, nodes[samples[j]].time)
+                                                 - nodes[m].time;
+                        }
+                }
+        }
+    } // namespace ts
+} // namespace fwdpp
+
+#endif
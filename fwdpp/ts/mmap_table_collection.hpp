@@ -0,0 +1,28 @@
+#ifndef FWDPP_TS_MMAP_TABLE_COLLECTION_HPP
+#define FWDPP_TS_MMAP_TABLE_COLLECTION_HPP
+
+#include "node.hpp"
+#include "edge.hpp"
+#include "site.hpp"
+#include "mutation_record.hpp"
+#include "mmap_vector.hpp"
+#include "table_collection.hpp"
+
+namespace fwdpp
+{
+    namespace ts
+    {
+        /// Alias for a table collection whose tables are stored
+        /// in memory-mapped temporary files.  Use this type when the
+        /// tables may not fit in RAM, such as long simulations
+        /// preserving many ancient samples.  The edge indexes and
+        /// the list of preserved nodes remain in std::vector.
+        /// See fwdpp::ts::mmap_vector for details.
+        /// \version 0.10.0 Added to library
+        using mmap_table_collection
+            = table_collection<mmap_vector<node>, mmap_vector<edge>, mmap_vector<site>,
+                               mmap_vector<mutation_record>>;
+    } // namespace ts
+} // namespace fwdpp
+
+#endif
@@ -0,0 +1,658 @@
+#ifndef FWDPP_TS_MMAP_VECTOR_HPP
+#define FWDPP_TS_MMAP_VECTOR_HPP
+
+#include <string>
+#include <vector>
+#include <cerrno>
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <utility>
+#include <memory>
+#include <functional>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <initializer_list>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+namespace fwdpp
+{
+    namespace ts
+    {
+        namespace detail
+        {
+            inline void
+            throw_mmap_error(const char* what)
+            {
+                throw std::runtime_error(std::string("mmap_vector: ") + what + ": "
+                                         + std::strerror(errno));
+            }
+
+            inline int
+            open_mmap_file()
+            /// Create a temporary file and unlink it, so
+            /// that the storage goes away with the descriptor.
+            {
+                const char* dir = std::getenv("FWDPP_MMAP_DIR");
+                if (dir == nullptr || *dir == '\0')
+                    {
+                        dir = std::getenv("TMPDIR");
+                    }
+                if (dir == nullptr || *dir == '\0')
+                    {
+                        dir = "/tmp";
+                    }
+                std::string path_template = std::string(dir) + "/fwdpp_mmap_XXXXXX";
+                std::vector<char> path(path_template.begin(), path_template.end());
+                path.push_back('\0');
+                int fd = ::mkstemp(path.data());
+                if (fd == -1)
+                    {
+                        throw_mmap_error("mkstemp failed");
+                    }
+                ::unlink(path.data());
+                return fd;
+            }
+        } // namespace detail
+
+        template <typename T> class mmap_vector
+        /*! \brief A growable array stored in a memory-mapped temporary file
+         *
+         * The interface is the subset of std::vector used by
+         * fwdpp::ts::table_collection and the functions that
+         * operate on it.  See fwdpp::ts::mmap_table_collection.
+         *
+         * Storage is a shared mapping of a temporary file that is
+         * unlinked as soon as it is created.  The operating system
+         * can therefore write cold rows back to disk instead of
+         * swap, and tables may exceed the available RAM.
+         *
+         * The file is created in the directory named by the environment
+         * variable FWDPP_MMAP_DIR, else TMPDIR, else /tmp.  No file is
+         * created until the capacity is nonzero.
+         *
+         * T must be trivially copyable.  Growing the capacity extends
+         * the file and maps it again, which invalidates iterators,
+         * pointers, and references, as for std::vector.
+         *
+         * Errors from the operating system throw std::runtime_error.
+         *
+         * \note Requires a POSIX system.
+         *
+         * \version 0.10.0 Added to library
+         */
+        {
+            static_assert(std::is_trivially_copyable<T>::value,
+                          "mmap_vector requires a trivially copyable type");
+
+          public:
+            using value_type = T;
+            using reference = T&;
+            using const_reference = const T&;
+            using pointer = T*;
+            using const_pointer = const T*;
+            using size_type = std::size_t;
+            using difference_type = std::ptrdiff_t;
+            using iterator = T*;
+            using const_iterator = const T*;
+            using reverse_iterator = std::reverse_iterator<iterator>;
+            using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+          private:
+            int fd_;
+            T* data_;
+            size_type size_, capacity_;
+
+            static size_type
+            page_rounded_capacity(size_type n)
+            /// Round n up so that the mapping is a whole number of pages
+            {
+                const auto page = static_cast<size_type>(::sysconf(_SC_PAGESIZE));
+                const auto bytes = ((n * sizeof(T) + page - 1) / page) * page;
+                return bytes / sizeof(T);
+            }
+
+            void
+            remap(size_type new_capacity)
+            {
+                if (new_capacity == capacity_)
+                    {
+                        return;
+                    }
+                if (new_capacity == 0)
+                    {
+                        release();
+                        return;
+                    }
+                if (fd_ == -1)
+                    {
+                        fd_ = detail::open_mmap_file();
+                    }
+                const auto bytes = new_capacity * sizeof(T);
+                if (new_capacity > capacity_
+                    && ::ftruncate(fd_, static_cast<off_t>(bytes)) == -1)
+                    {
+                        detail::throw_mmap_error("ftruncate failed");
+                    }
+                void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd_,
+                                 0);
+                if (p == MAP_FAILED)
+                    {
+                        detail::throw_mmap_error("mmap failed");
+                    }
+                if (data_ != nullptr)
+                    {
+                        ::munmap(data_, capacity_ * sizeof(T));
+                    }
+                if (new_capacity < capacity_)
+                    {
+                        // Give the disk space back.  Failure
+                        // only means that the file stays larger.
+                        static_cast<void>(::ftruncate(fd_, static_cast<off_t>(bytes)));
+                    }
+                data_ = static_cast<T*>(p);
+                capacity_ = new_capacity;
+            }
+
+            void
+            release()
+            {
+                if (data_ != nullptr)
+                    {
+                        ::munmap(data_, capacity_ * sizeof(T));
+                    }
+                if (fd_ != -1)
+                    {
+                        ::close(fd_);
+                    }
+                fd_ = -1;
+                data_ = nullptr;
+                size_ = capacity_ = 0;
+            }
+
+            void
+            grow_for(size_type n)
+            {
+                if (n > capacity_)
+                    {
+                        remap(page_rounded_capacity(std::max(n, 2 * capacity_)));
+                    }
+            }
+
+          public:
+            mmap_vector() : fd_{-1}, data_{nullptr}, size_{0}, capacity_{0}
+            {
+            }
+
+            explicit mmap_vector(size_type n, const value_type& v = value_type{})
+                : mmap_vector()
+            {
+                resize(n, v);
+            }
+
+            template <typename Iterator,
+                      typename = typename std::iterator_traits<Iterator>::value_type>
+            mmap_vector(Iterator first, Iterator last) : mmap_vector()
+            {
+                assign(first, last);
+            }
+
+            mmap_vector(std::initializer_list<value_type> l) : mmap_vector()
+            {
+                assign(l.begin(), l.end());
+            }
+
+            mmap_vector(const mmap_vector& other) : mmap_vector()
+            {
+                assign(other.begin(), other.end());
+            }
+
+            mmap_vector(mmap_vector&& other) noexcept
+                : fd_{other.fd_}, data_{other.data_}, size_{other.size_},
+                  capacity_{other.capacity_}
+            {
+                other.fd_ = -1;
+                other.data_ = nullptr;
+                other.size_ = other.capacity_ = 0;
+            }
+
+            mmap_vector&
+            operator=(const mmap_vector& other)
+            {
+                if (this != &other)
+                    {
+                        assign(other.begin(), other.end());
+                    }
+                return *this;
+            }
+
+            mmap_vector&
+            operator=(mmap_vector&& other) noexcept
+            {
+                swap(other);
+                return *this;
+            }
+
+            ~mmap_vector()
+            {
+                release();
+            }
+
+            reference operator[](size_type i)
+            {
+                return data_[i];
+            }
+
+            const_reference operator[](size_type i) const
+            {
+                return data_[i];
+            }
+
+            reference
+            at(size_type i)
+            {
+                if (i >= size_)
+                    {
+                        throw std::out_of_range("mmap_vector: index out of range");
+                    }
+                return data_[i];
+            }
+
+            const_reference
+            at(size_type i) const
+            {
+                if (i >= size_)
+                    {
+                        throw std::out_of_range("mmap_vector: index out of range");
+                    }
+                return data_[i];
+            }
+
+            reference
+            front()
+            {
+                return data_[0];
+            }
+
+            const_reference
+            front() const
+            {
+                return data_[0];
+            }
+
+            reference
+            back()
+            {
+                return data_[size_ - 1];
+            }
+
+            const_reference
+            back() const
+            {
+                return data_[size_ - 1];
+            }
+
+            pointer
+            data()
+            {
+                return data_;
+            }
+
+            const_pointer
+            data() const
+            {
+                return data_;
+            }
+
+            size_type
+            size() const
+            {
+                return size_;
+            }
+
+            bool
+            empty() const
+            {
+                return size_ == 0;
+            }
+
+            size_type
+            capacity() const
+            {
+                return capacity_;
+            }
+
+            void
+            reserve(size_type n)
+            {
+                if (n > capacity_)
+                    {
+                        remap(page_rounded_capacity(n));
+                    }
+            }
+
+            void
+            shrink_to_fit()
+            /// Shrink the mapping and the file to the smallest
+            /// number of pages holding size() elements.
+            {
+                remap(page_rounded_capacity(size_));
+            }
+
+            std::size_t
+            memory_usage() const
+            /// Size of the mapping, in bytes.  The pages are backed
+            /// by the temporary file rather than by swap.
+            {
+                return capacity_ * sizeof(T);
+            }
+
+            void
+            clear()
+            /// Set size() to zero.  The capacity is kept.
+            {
+                size_ = 0;
+            }
+
+            void
+            resize(size_type n, const value_type& v = value_type{})
+            {
+                grow_for(n);
+                if (n > size_)
+                    {
+                        std::fill(data_ + size_, data_ + n, v);
+                    }
+                size_ = n;
+            }
+
+            void
+            push_back(const value_type& v)
+            {
+                if (size_ == capacity_)
+                    {
+                        // v may refer to an element of this container
+                        const value_type copy = v;
+                        grow_for(size_ + 1);
+                        data_[size_++] = copy;
+                        return;
+                    }
+                data_[size_++] = v;
+            }
+
+            template <typename... Args>
+            void
+            emplace_back(Args&&... args)
+            {
+                push_back(value_type{std::forward<Args>(args)...});
+            }
+
+            void
+            pop_back()
+            {
+                --size_;
+            }
+
+          private:
+            template <typename Iterator>
+            bool
+            in_storage(Iterator first, Iterator last, std::true_type) const
+            {
+                if (first == last || data_ == nullptr)
+                    {
+                        return false;
+                    }
+                const value_type* p = std::addressof(*first);
+                return !std::less<const value_type*>()(p, data_)
+                       && std::less<const value_type*>()(p, data_ + capacity_);
+            }
+
+            template <typename Iterator>
+            bool
+            in_storage(Iterator, Iterator, std::false_type) const
+            // Iterators not dereferencing to our elements cannot alias them
+            {
+                return false;
+            }
+
+            template <typename Iterator>
+            bool
+            in_storage(Iterator first, Iterator last) const
+            /// True if [first, last) refers to elements of this container
+            {
+                using ref = decltype(*first);
+                return in_storage(
+                    first, last,
+                    std::integral_constant<
+                        bool, std::is_lvalue_reference<ref>::value
+                                  && std::is_same<typename std::decay<ref>::type,
+                                                  value_type>::value>{});
+            }
+
+            template <typename Iterator>
+            void
+            assign(Iterator first, Iterator last, std::input_iterator_tag)
+            {
+                size_ = 0;
+                for (; first != last; ++first)
+                    {
+                        push_back(*first);
+                    }
+            }
+
+            template <typename Iterator>
+            void
+            assign(Iterator first, Iterator last, std::forward_iterator_tag)
+            {
+                const auto n = static_cast<size_type>(std::distance(first, last));
+                if (in_storage(first, last))
+                    {
+                        // Growing would unmap the input
+                        std::vector<value_type> temp(first, last);
+                        size_ = 0;
+                        grow_for(n);
+                        std::copy(temp.begin(), temp.end(), data_);
+                    }
+                else
+                    {
+                        size_ = 0;
+                        grow_for(n);
+                        std::copy(first, last, data_);
+                    }
+                size_ = n;
+            }
+
+            template <typename Iterator>
+            iterator
+            insert(size_type offset, Iterator first, Iterator last,
+                   std::input_iterator_tag)
+            {
+                std::vector<value_type> temp(first, last);
+                return insert(offset, temp.begin(), temp.end(),
+                              std::forward_iterator_tag{});
+            }
+
+            template <typename Iterator>
+            iterator
+            insert(size_type offset, Iterator first, Iterator last,
+                   std::forward_iterator_tag)
+            {
+                if (in_storage(first, last))
+                    {
+                        // Growing or shifting would change the input
+                        std::vector<value_type> temp(first, last);
+                        return insert(offset, temp.begin(), temp.end(),
+                                      std::forward_iterator_tag{});
+                    }
+                const auto n = static_cast<size_type>(std::distance(first, last));
+                grow_for(size_ + n);
+                std::move_backward(data_ + offset, data_ + size_, data_ + size_ + n);
+                std::copy(first, last, data_ + offset);
+                size_ += n;
+                return data_ + offset;
+            }
+
+          public:
+            template <typename Iterator>
+            void
+            assign(Iterator first, Iterator last)
+            /// The input is copied straight into the mapping,
+            /// unless it is part of this container.
+            {
+                assign(first, last,
+                       typename std::iterator_traits<Iterator>::iterator_category{});
+            }
+
+            template <typename Iterator,
+                      typename = typename std::iterator_traits<Iterator>::value_type>
+            iterator
+            insert(const_iterator pos, Iterator first, Iterator last)
+            /// The input is copied straight into the mapping,
+            /// unless it is part of this container.
+            {
+                return insert(static_cast<size_type>(pos - cbegin()), first, last,
+                              typename std::iterator_traits<Iterator>::iterator_category{});
+            }
+
+            iterator
+            insert(const_iterator pos, const value_type& v)
+            {
+                const value_type copy = v;
+                return insert(pos, &copy, &copy + 1);
+            }
+
+            iterator
+            erase(const_iterator first, const_iterator last)
+            {
+                auto f = data_ + (first - cbegin());
+                auto l = data_ + (last - cbegin());
+                std::copy(l, data_ + size_, f);
+                size_ -= static_cast<size_type>(l - f);
+                return f;
+            }
+
+            iterator
+            erase(const_iterator pos)
+            {
+                return erase(pos, pos + 1);
+            }
+
+            void
+            swap(mmap_vector& other) noexcept
+            {
+                std::swap(fd_, other.fd_);
+                std::swap(data_, other.data_);
+                std::swap(size_, other.size_);
+                std::swap(capacity_, other.capacity_);
+            }
+
+            iterator
+            begin()
+            {
+                return data_;
+            }
+
+            iterator
+            end()
+            {
+                return data_ + size_;
+            }
+
+            const_iterator
+            begin() const
+            {
+                return data_;
+            }
+
+            const_iterator
+            end() const
+            {
+                return data_ + size_;
+            }
+
+            const_iterator
+            cbegin() const
+            {
+                return data_;
+            }
+
+            const_iterator
+            cend() const
+            {
+                return data_ + size_;
+            }
+
+            reverse_iterator
+            rbegin()
+            {
+                return reverse_iterator(end());
+            }
+
+            reverse_iterator
+            rend()
+            {
+                return reverse_iterator(begin());
+            }
+
+            const_reverse_iterator
+            rbegin() const
+            {
+                return const_reverse_iterator(end());
+            }
+
+            const_reverse_iterator
+            rend() const
+            {
+                return const_reverse_iterator(begin());
+            }
+
+            bool
+            operator==(const mmap_vector& other) const
+            {
+                return size_ == other.size_ && std::equal(begin(), end(), other.begin());
+            }
+
+            bool
+            operator!=(const mmap_vector& other) const
+            {
+                return !(*this == other);
+            }
+
+            friend iterator
+            begin(mmap_vector& v)
+            {
+                return v.begin();
+            }
+
+            friend iterator
+            end(mmap_vector& v)
+            {
+                return v.end();
+            }
+
+            friend const_iterator
+            begin(const mmap_vector& v)
+            {
+                return v.begin();
+            }
+
+            friend const_iterator
+            end(const mmap_vector& v)
+            {
+                return v.end();
+            }
+        };
+
+        template <typename T>
+        inline void
+        swap(mmap_vector<T>& a, mmap_vector<T>& b) noexcept
+        {
+            a.swap(b);
+        }
+    } // namespace ts
+} // namespace fwdpp
+
+#endif
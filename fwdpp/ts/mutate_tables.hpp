@@ -100,7 +100,7 @@ namespace fwdpp
                                 }
                         }
                 }
-            for (auto &e : tables.edges)
+            for (const auto &e : tables.edges)
                 {
                     auto ct = tables.nodes[e.child].time;
                     auto pt = tables.nodes[e.parent].time;
@@ -44,6 +44,175 @@ namespace fwdpp
             }
         };
 
+        class parent_edge_ranges
+        /// \brief Location of each parent's edges in an edge table
+        ///
+        /// Simplification outputs all edges of a parent
+        /// contiguously, so the simplifier records the
+        /// ranges as it goes.  A later call to find_pre_existing_edges
+        /// can then skip scanning the edge table.
+        ///
+        /// Ranges are [start, stop], as in fwdpp::ts::parent_location.
+        /// A parent without edges has start and stop equal to
+        /// std::numeric_limits<std::size_t>::max().
+        ///
+        /// The ranges are keyed on the edge table's length and
+        /// fwdpp::ts::table_collection::edge_table_generation, so
+        /// that they are not used once the table has changed.
+        ///
+        /// \version 0.10.0 Added to library
+        {
+          private:
+            std::vector<std::size_t> start_, stop_;
+            std::size_t num_edges_;
+            std::uint64_t edge_table_generation_;
+
+            static constexpr std::size_t null() noexcept
+            {
+                return std::numeric_limits<std::size_t>::max();
+            }
+
+          public:
+            parent_edge_ranges()
+                : start_{}, stop_{}, num_edges_{null()}, edge_table_generation_{0}
+            {
+            }
+
+            void
+            clear()
+            /// Remove all ranges.  Keeps the memory allocated.
+            {
+                start_.clear();
+                stop_.clear();
+                num_edges_ = null();
+            }
+
+            void
+            record(table_index_t parent, std::size_t start, std::size_t stop)
+            {
+                auto p = static_cast<std::size_t>(parent);
+                if (p >= start_.size())
+                    {
+                        start_.resize(p + 1, null());
+                        stop_.resize(p + 1, null());
+                    }
+                start_[p] = start;
+                stop_[p] = stop;
+            }
+
+            template <typename TableCollectionType>
+            void
+            finalize(const TableCollectionType& tables)
+            /// Mark the ranges as describing the current
+            /// edge table of \a tables
+            {
+                num_edges_ = tables.num_edges();
+                edge_table_generation_ = tables.edge_table_generation();
+            }
+
+            template <typename TableCollectionType>
+            bool
+            describes(const TableCollectionType& tables) const
+            /// Return true if the edge table of \a tables has not
+            /// changed since finalize was called
+            {
+                return num_edges_ == tables.num_edges()
+                       && edge_table_generation_ == tables.edge_table_generation();
+            }
+
+            parent_location
+            operator[](table_index_t parent) const
+            {
+                auto p = static_cast<std::size_t>(parent);
+                if (p >= start_.size())
+                    {
+                        return parent_location(parent, null(), null());
+                    }
+                return parent_location(parent, start_[p], stop_[p]);
+            }
+
+            void
+            swap(parent_edge_ranges& other)
+            {
+                start_.swap(other.start_);
+                stop_.swap(other.stop_);
+                std::swap(num_edges_, other.num_edges_);
+                std::swap(edge_table_generation_, other.edge_table_generation_);
+            }
+        };
+
+        namespace detail
+        {
+            inline std::vector<table_index_t>
+            alive_with_new_edges(
+                const std::vector<table_index_t>& alive_at_last_simplification,
+                const fwdpp::ts::edge_buffer& new_edges)
+            {
+                std::vector<table_index_t> rv;
+                for (auto a : alive_at_last_simplification)
+                    {
+                        if (new_edges.head(a) != edge_buffer::null)
+                            {
+                                rv.push_back(a);
+                            }
+                    }
+                return rv;
+            }
+
+            template <typename TableCollectionType>
+            inline bool
+            valid_parent_location(const TableCollectionType& tables,
+                                  const parent_location& loc)
+            // O(1) check that loc is the complete range of a
+            // parent's edges.  We cannot cheaply check
+            // that a parent without a recorded range has no edges.
+            {
+                if (loc.start == std::numeric_limits<std::size_t>::max())
+                    {
+                        return loc.stop == std::numeric_limits<std::size_t>::max();
+                    }
+                const auto n = tables.num_edges();
+                return loc.start <= loc.stop && loc.stop < n
+                       && tables.edges[loc.start].parent == loc.parent
+                       && tables.edges[loc.stop].parent == loc.parent
+                       && (loc.start == 0
+                           || tables.edges[loc.start - 1].parent != loc.parent)
+                       && (loc.stop + 1 == n
+                           || tables.edges[loc.stop + 1].parent != loc.parent);
+            }
+
+            template <typename TableCollectionType>
+            inline std::vector<parent_location>
+            sort_pre_existing_edges(const TableCollectionType& tables,
+                                    std::vector<parent_location> existing_edges)
+            {
+                // Our only sort!!
+                std::sort(
+                    begin(existing_edges), end(existing_edges),
+                    [&tables](const parent_location& lhs, const parent_location& rhs) {
+                        // NOTE: have to take -time so that tuple sorting works
+                        auto t0 = -tables.nodes[lhs.parent].time;
+                        auto t1 = -tables.nodes[rhs.parent].time;
+                        return std::tie(t0, lhs.start, lhs.parent)
+                               < std::tie(t1, rhs.start, rhs.parent);
+                    });
+
+                // FIXME: this should be debug only
+                for (std::size_t i = 1; i < existing_edges.size(); ++i)
+                    {
+                        auto t0 = tables.nodes[existing_edges[i - 1].parent].time;
+                        auto t1 = tables.nodes[existing_edges[i].parent].time;
+                        if (t0 < t1)
+                            {
+                                throw std::runtime_error(
+                                    "existing edges not properly sorted by time");
+                            }
+                    }
+
+                return existing_edges;
+            }
+        } // namespace detail
+
         template <typename TableCollectionType>
         inline std::vector<parent_location>
         find_pre_existing_edges(
@@ -53,14 +222,8 @@ namespace fwdpp
         // FIXME: the indexing step need go no farther than the time of the most
         // recent node in alive_at_last_simplification.
         {
-            std::vector<table_index_t> alive_with_new_edges;
-            for (auto a : alive_at_last_simplification)
-                {
-                    if (new_edges.head(a) != edge_buffer::null)
-                        {
-                            alive_with_new_edges.push_back(a);
-                        }
-                }
+            auto alive_with_new_edges
+                = detail::alive_with_new_edges(alive_at_last_simplification, new_edges);
             if (alive_with_new_edges.empty()) // get out early
                 {
                     return {};
@@ -90,30 +253,41 @@ namespace fwdpp
                 {
                     existing_edges.emplace_back(a, starts[a], stops[a]);
                 }
+            return detail::sort_pre_existing_edges(tables, std::move(existing_edges));
+        }
 
-            // Our only sort!!
-            std::sort(begin(existing_edges), end(existing_edges),
-                      [&tables](const parent_location& lhs, const parent_location& rhs) {
-                          // NOTE: have to take -time so that tuple sorting works
-                          auto t0 = -tables.nodes[lhs.parent].time;
-                          auto t1 = -tables.nodes[rhs.parent].time;
-                          return std::tie(t0, lhs.start, lhs.parent)
-                                 < std::tie(t1, rhs.start, rhs.parent);
-                      });
-
-            // FIXME: this should be debug only
-            for (std::size_t i = 1; i < existing_edges.size(); ++i)
+        template <typename TableCollectionType>
+        inline std::vector<parent_location>
+        find_pre_existing_edges(
+            const TableCollectionType& tables,
+            const std::vector<table_index_t>& alive_at_last_simplification,
+            const fwdpp::ts::edge_buffer& new_edges, const parent_edge_ranges& ranges)
+        /// Use \a ranges, recorded during the last simplification,
+        /// instead of scanning the edge table.  If \a ranges do not
+        /// describe the edge table, the table is scanned.
+        /// See fwdpp::ts::parent_edge_ranges::describes.
+        ///
+        /// \version 0.10.0 Added to library
+        {
+            if (!ranges.describes(tables))
+                {
+                    return find_pre_existing_edges(tables, alive_at_last_simplification,
+                                                   new_edges);
+                }
+            auto alive_with_new_edges
+                = detail::alive_with_new_edges(alive_at_last_simplification, new_edges);
+            std::vector<parent_location> existing_edges;
+            existing_edges.reserve(alive_with_new_edges.size());
+            for (auto a : alive_with_new_edges)
                 {
-                    auto t0 = tables.nodes[existing_edges[i - 1].parent].time;
-                    auto t1 = tables.nodes[existing_edges[i].parent].time;
-                    if (t0 < t1)
+                    existing_edges.push_back(ranges[a]);
+                    if (!detail::valid_parent_location(tables, existing_edges.back()))
                         {
-                            throw std::runtime_error(
-                                "existing edges not properly sorted by time");
+                            return find_pre_existing_edges(
+                                tables, alive_at_last_simplification, new_edges);
                         }
                 }
-
-            return existing_edges;
+            return detail::sort_pre_existing_edges(tables, std::move(existing_edges));
         }
 
         template <typename TableCollectionType>
@@ -213,6 +387,138 @@ namespace fwdpp
                 }
         }
 
+        template <typename TableCollectionType>
+        void
+        stitch_together_edges(
+            const std::vector<table_index_t>& alive_at_last_simplification,
+            double max_time, edge_buffer& new_edges, TableCollectionType& tables)
+        /// Add the births in \a new_edges to the edge table,
+        /// such that the table is sorted as needed for simplification.
+        ///
+        /// The edge table is grown in place.  Existing edges are moved
+        /// towards the end of the table, with births inserted as we go.
+        /// Thus, the additional memory required is proportional to the
+        /// number of births, provided that the edge table's capacity
+        /// suffices, which is typical after simplification.
+        ///
+        /// \version 0.10.0 Added to library
+        {
+            const auto parent_time
+                = [&tables](table_index_t p) { return tables.nodes[p].time; };
+            const auto num_births = [&new_edges](std::int32_t n) {
+                std::size_t rv = 0;
+                for (; n != edge_buffer::null; n = new_edges.next(n))
+                    {
+                        ++rv;
+                    }
+                return rv;
+            };
+
+            // Births from parents born since the last simplification
+            // go to the front of the table.  These parents are at the
+            // end of the buffer.
+            std::size_t num_front_births = 0;
+            auto front_end = new_edges.rbegin();
+            for (; front_end < new_edges.rend(); ++front_end)
+                {
+                    auto parent = new_edges.convert_to_head_index(front_end);
+                    if (parent < 0)
+                        {
+                            throw std::runtime_error("negative parent value");
+                        }
+                    if (parent >= std::numeric_limits<table_index_t>::max())
+                        {
+                            throw std::overflow_error("parent value overflows");
+                        }
+                    if (*front_end != edge_buffer::null)
+                        {
+                            if (tables.nodes[parent].time <= max_time)
+                                {
+                                    break;
+                                }
+                            num_front_births += num_births(*front_end);
+                        }
+                }
+
+            // Births from parents alive at the last simplification
+            // go immediately after any existing edges for that parent.
+            auto existing_edges
+                = find_pre_existing_edges(tables, alive_at_last_simplification, new_edges);
+            const auto num_old_edges = tables.num_edges();
+            std::vector<std::size_t> insertion_points(existing_edges.size());
+            std::size_t offset = 0, total_births = num_front_births;
+            for (std::size_t i = 0; i < existing_edges.size(); ++i)
+                {
+                    const auto& ex = existing_edges[i];
+                    if (ex.start != std::numeric_limits<std::size_t>::max())
+                        {
+                            offset = ex.stop + 1;
+                        }
+                    else
+                        {
+                            // Edges are sorted by decreasing parent time
+                            auto t = parent_time(ex.parent);
+                            offset = static_cast<std::size_t>(
+                                std::partition_point(
+                                    begin(tables.edges) + offset, end(tables.edges),
+                                    [t, &parent_time](const auto& e) {
+                                        return parent_time(e.parent) > t;
+                                    })
+                                - begin(tables.edges));
+                        }
+                    insertion_points[i] = offset;
+                    total_births += num_births(new_edges.head(ex.parent));
+                }
+
+            // Merge from the back
+            tables.edges.resize(num_old_edges + total_births);
+            const auto first_edge = begin(tables.edges);
+            auto old_end = num_old_edges;
+            auto dest_end = num_old_edges + total_births;
+            for (std::size_t i = existing_edges.size(); i-- > 0;)
+                {
+                    auto first = insertion_points[i];
+                    if (dest_end != old_end)
+                        {
+                            std::move_backward(first_edge + first, first_edge + old_end,
+                                               first_edge + dest_end);
+                        }
+                    dest_end -= old_end - first;
+                    old_end = first;
+                    auto parent = existing_edges[i].parent;
+                    auto n = new_edges.head(parent);
+                    dest_end -= num_births(n);
+                    for (auto j = dest_end; n != edge_buffer::null;
+                         n = new_edges.next(n), ++j)
+                        {
+                            const auto& birth = new_edges.fetch(n);
+                            tables.edges[j] = typename TableCollectionType::edge_t{
+                                birth.left, birth.right, parent, birth.child};
+                        }
+                }
+            std::move_backward(first_edge, first_edge + old_end, first_edge + dest_end);
+            if (dest_end - old_end != num_front_births)
+                {
+                    throw std::runtime_error("error merging new edges into edge table");
+                }
+
+            // Fill in the front
+            std::size_t j = 0;
+            for (auto b = new_edges.rbegin(); b < front_end; ++b)
+                {
+                    auto parent
+                        = static_cast<table_index_t>(new_edges.convert_to_head_index(b));
+                    for (auto n = *b; n != edge_buffer::null; n = new_edges.next(n))
+                        {
+                            const auto& birth = new_edges.fetch(n);
+                            tables.edges[j++] = typename TableCollectionType::edge_t{
+                                birth.left, birth.right, parent, birth.child};
+                        }
+                }
+            tables.clear_indexes();
+            new_edges.reset(tables.num_nodes());
+        }
+
         template <typename TableCollectionType>
         void
         stitch_together_edges(
@@ -220,21 +526,12 @@ namespace fwdpp
             double max_time, edge_buffer& new_edges,
             typename TableCollectionType::edge_table& edge_liftover,
             TableCollectionType& tables)
+        /// \version 0.10.0 \a edge_liftover is no longer used,
+        /// as edges are merged in place.
         {
-            copy_births_since_last_simplification(new_edges, tables, max_time,
-                                                  edge_liftover);
-            auto existing_edges = find_pre_existing_edges(
-                tables, alive_at_last_simplification, new_edges);
-            auto offset = handle_pre_existing_edges(tables, new_edges, existing_edges,
-                                                    edge_liftover);
-            for (; offset < tables.num_edges(); ++offset)
-                {
-                    edge_liftover.emplace_back(tables.edges[offset]);
-                }
-            tables.edges.assign(begin(edge_liftover), end(edge_liftover));
-            // This resets sizes to 0, but keeps the memory allocated.
             edge_liftover.clear();
-            new_edges.reset(tables.num_nodes());
+            stitch_together_edges(alive_at_last_simplification, max_time, new_edges,
+                                  tables);
         }
     }
 }
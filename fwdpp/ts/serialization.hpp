@@ -5,12 +5,17 @@
 #include <cstdint>
 #include <limits>
 #include <vector>
+#include <tuple>
+#include <utility>
+#include <algorithm>
 #include <stdexcept>
+#include <type_traits>
 #include <fwdpp/io/scalar_serialization.hpp>
 #include "edge.hpp"
 #include "node.hpp"
 #include "site.hpp"
 #include "mutation_record.hpp"
+#include "column_table.hpp"
 #include "serialization_version.hpp"
 #include "table_collection_functions.hpp"
 
@@ -191,6 +196,352 @@ namespace fwdpp
                 }
             };
 
+            namespace detail
+            {
+                // Format 3 wrote tables as contiguous arrays of their
+                // value_type.  Containers that do not store their
+                // rows contiguously, such as fwdpp::ts::column_table,
+                // are filled in bounded chunks.
+                constexpr std::size_t serialization_chunk_size = 1 << 16;
+
+                // Format 4 writes each table as one block per column.
+                // The fields of each record type, in column order:
+
+                template <typename Record> struct serialized_columns;
+
+                template <> struct serialized_columns<node>
+                {
+                    static inline auto
+                    tie(node& n)
+                    {
+                        return std::tie(n.deme, n.time);
+                    }
+                };
+
+                template <> struct serialized_columns<edge>
+                {
+                    static inline auto
+                    tie(edge& e)
+                    {
+                        return std::tie(e.left, e.right, e.parent, e.child);
+                    }
+                };
+
+                template <> struct serialized_columns<site>
+                {
+                    static inline auto
+                    tie(site& s)
+                    {
+                        return std::tie(s.position, s.ancestral_state);
+                    }
+                };
+
+                template <> struct serialized_columns<mutation_record>
+                {
+                    static inline auto
+                    tie(mutation_record& m)
+                    {
+                        return std::tie(m.node, m.key, m.site, m.derived_state,
+                                        m.neutral);
+                    }
+                };
+
+                template <typename Record>
+                using serialized_fields = decltype(
+                    serialized_columns<Record>::tie(std::declval<Record&>()));
+
+                template <typename T> struct column_storage
+                {
+                    using type = T;
+                };
+
+                // std::vector<bool> has no data()
+                template <> struct column_storage<bool>
+                {
+                    using type = std::uint8_t;
+                };
+
+                template <typename Record, std::size_t I>
+                using serialized_column_type = typename column_storage<
+                    typename std::decay<typename std::tuple_element<
+                        I, serialized_fields<Record>>::type>::type>::type;
+
+                template <typename Record, typename Sequence> struct column_vectors;
+
+                template <typename Record, std::size_t... I>
+                struct column_vectors<Record, std::index_sequence<I...>>
+                {
+                    using type
+                        = std::tuple<std::vector<serialized_column_type<Record, I>>...>;
+                };
+
+                /// One std::vector per serialized column of Record
+                template <typename Record>
+                using serialized_column_vectors = typename column_vectors<
+                    Record, std::make_index_sequence<std::tuple_size<
+                                serialized_fields<Record>>::value>>::type;
+
+                template <typename Record, typename TableType, typename Columns,
+                          std::size_t... I>
+                inline void
+                gather_columns_details(const TableType& table, Columns& columns,
+                                       std::index_sequence<I...>)
+                {
+                    int reserve[] = {(std::get<I>(columns).reserve(table.size()), 0)...};
+                    static_cast<void>(reserve);
+                    for (std::size_t j = 0; j < table.size(); ++j)
+                        {
+                            Record r = table[j];
+                            auto fields = serialized_columns<Record>::tie(r);
+                            int dummy[] = {(std::get<I>(columns).push_back(
+                                                static_cast<serialized_column_type<Record, I>>(
+                                                    std::get<I>(fields))),
+                                            0)...};
+                            static_cast<void>(dummy);
+                        }
+                }
+
+                template <typename Record, typename TableType>
+                inline serialized_column_vectors<Record>
+                gather_columns(const TableType& table)
+                /// Copy the fields of all rows into one std::vector
+                /// per column, in a single pass over the rows.
+                {
+                    serialized_column_vectors<Record> columns;
+                    gather_columns_details<Record>(
+                        table, columns,
+                        std::make_index_sequence<std::tuple_size<
+                            serialized_fields<Record>>::value>());
+                    return columns;
+                }
+
+                template <typename Record, typename ColumnTraits, std::size_t... I>
+                inline serialized_column_vectors<Record>
+                gather_columns_details(const column_table<ColumnTraits>& table,
+                                       std::index_sequence<I...>)
+                {
+                    return serialized_column_vectors<Record>(
+                        std::vector<serialized_column_type<Record, I>>(
+                            table.template column<I>().begin(),
+                            table.template column<I>().end())...);
+                }
+
+                template <typename Record, typename ColumnTraits>
+                inline serialized_column_vectors<Record>
+                gather_columns(const column_table<ColumnTraits>& table)
+                {
+                    return gather_columns_details<Record>(
+                        table, std::make_index_sequence<std::tuple_size<
+                                   serialized_fields<Record>>::value>());
+                }
+
+                template <typename Record, typename TableType, typename Columns,
+                          std::size_t... I>
+                inline void
+                append_rows_details(TableType& table, std::size_t nrows,
+                                    const Columns& columns, std::index_sequence<I...>)
+                {
+                    using value_type = typename TableType::value_type;
+                    table.reserve(table.size() + nrows);
+                    for (std::size_t j = 0; j < nrows; ++j)
+                        {
+                            Record r;
+                            serialized_columns<Record>::tie(r)
+                                = std::forward_as_tuple(std::get<I>(columns)[j]...);
+                            table.push_back(value_type(r));
+                        }
+                }
+
+                template <typename Record, typename TableType>
+                inline void
+                append_rows(TableType& table, std::size_t nrows,
+                            const serialized_column_vectors<Record>& columns)
+                /// Append the first \a nrows elements of each
+                /// column to \a table.
+                {
+                    append_rows_details<Record>(
+                        table, nrows, columns,
+                        std::make_index_sequence<std::tuple_size<
+                            serialized_fields<Record>>::value>());
+                }
+
+                template <typename Record, typename TableType>
+                inline void
+                assign_rows(TableType& table, std::size_t nrows,
+                            const serialized_column_vectors<Record>& columns)
+                /// Replace the rows of \a table with the first
+                /// \a nrows elements of each column.
+                {
+                    table.clear();
+                    append_rows<Record>(table, nrows, columns);
+                }
+
+                template <typename T, typename ostreamtype>
+                inline void
+                write_column_header(ostreamtype& o)
+                {
+                    fwdpp::io::scalar_writer sw;
+                    const std::uint32_t element_size = sizeof(T);
+                    sw(o, &element_size);
+                }
+
+                template <typename T, typename Column, typename ostreamtype>
+                inline void
+                write_column(ostreamtype& o, const Column& column)
+                /// Write the element size and then the contents
+                /// of \a column in a single call.
+                {
+                    static_assert(
+                        std::is_same<T, typename Column::value_type>::value,
+                        "column type differs from the serialized type");
+                    write_column_header<T>(o);
+                    if (!column.empty())
+                        {
+                            o.write(reinterpret_cast<const char*>(column.data()),
+                                    column.size() * sizeof(T));
+                        }
+                    if (!o)
+                        {
+                            throw std::runtime_error("error writing tables");
+                        }
+                }
+
+                template <typename Record, typename TableType, typename ostreamtype,
+                          std::size_t... I>
+                inline void
+                write_columns_details(ostreamtype& o, const TableType& table,
+                                      std::index_sequence<I...>)
+                /// Rows are gathered into columns in one pass
+                {
+                    const auto columns = gather_columns<Record>(table);
+                    int dummy[] = {(write_column<serialized_column_type<Record, I>>(
+                                        o, std::get<I>(columns)),
+                                    0)...};
+                    static_cast<void>(dummy);
+                }
+
+                template <typename Record, typename ColumnTraits, typename ostreamtype,
+                          std::size_t... I>
+                inline void
+                write_columns_details(ostreamtype& o,
+                                      const column_table<ColumnTraits>& table,
+                                      std::index_sequence<I...>)
+                /// Columns of a column_table are written directly
+                {
+                    int dummy[] = {(write_column<serialized_column_type<Record, I>>(
+                                        o, table.template column<I>()),
+                                    0)...};
+                    static_cast<void>(dummy);
+                }
+
+                template <typename Record, typename TableType, typename ostreamtype>
+                inline void
+                write_columns(ostreamtype& o, const TableType& table)
+                /// Write the number of rows and columns, then
+                /// each column as an element size and a block of data.
+                {
+                    constexpr std::size_t ncols
+                        = std::tuple_size<serialized_fields<Record>>::value;
+                    fwdpp::io::scalar_writer sw;
+                    const std::uint64_t nrows = table.size();
+                    const std::uint32_t num_columns = ncols;
+                    sw(o, &nrows);
+                    sw(o, &num_columns);
+                    write_columns_details<Record>(o, table,
+                                                  std::make_index_sequence<ncols>());
+                }
+
+                template <typename T, typename istreamtype>
+                inline void
+                read_column(istreamtype& i, std::size_t nrows, std::vector<T>& column)
+                {
+                    std::uint32_t element_size;
+                    fwdpp::io::scalar_reader sr;
+                    sr(i, &element_size);
+                    if (!i || element_size != sizeof(T))
+                        {
+                            throw std::runtime_error("invalid column element size");
+                        }
+                    column.resize(nrows);
+                    i.read(reinterpret_cast<char*>(column.data()), nrows * sizeof(T));
+                    if (!i)
+                        {
+                            throw std::runtime_error("unexpected end of input");
+                        }
+                }
+
+                template <typename Record, typename TableType, typename istreamtype,
+                          std::size_t... I>
+                inline void
+                read_columns_details(istreamtype& i, std::size_t nrows, TableType& table,
+                                     std::index_sequence<I...>)
+                {
+                    serialized_column_vectors<Record> columns;
+                    int dummy[] = {(read_column(i, nrows, std::get<I>(columns)), 0)...};
+                    static_cast<void>(dummy);
+                    append_rows<Record>(table, nrows, columns);
+                }
+
+                template <typename Record, typename TableType, typename istreamtype>
+                inline void
+                append_columns(istreamtype& i, TableType& table)
+                /// Read rows written by write_columns and append
+                /// them to \a table.  Each column is read in a
+                /// single call.
+                {
+                    constexpr std::size_t ncols
+                        = std::tuple_size<serialized_fields<Record>>::value;
+                    fwdpp::io::scalar_reader sr;
+                    std::uint64_t nrows;
+                    std::uint32_t num_columns;
+                    sr(i, &nrows);
+                    sr(i, &num_columns);
+                    if (!i || num_columns != ncols)
+                        {
+                            throw std::runtime_error("invalid number of columns");
+                        }
+                    read_columns_details<Record>(i, static_cast<std::size_t>(nrows),
+                                                 table,
+                                                 std::make_index_sequence<ncols>());
+                }
+
+                template <typename Record, typename TableType, typename istreamtype>
+                inline void
+                read_columns(istreamtype& i, TableType& table)
+                /// Replace the rows of \a table with those
+                /// written by write_columns.
+                {
+                    table.clear();
+                    append_columns<Record>(i, table);
+                }
+
+                template <typename T, typename A, typename istreamtype>
+                inline void
+                read_table_rows(istreamtype& i, std::size_t nrows,
+                                std::vector<T, A>& table)
+                {
+                    table.resize(nrows);
+                    i.read(reinterpret_cast<char*>(table.data()), nrows * sizeof(T));
+                }
+
+                template <typename TableType, typename istreamtype>
+                inline void
+                read_table_rows(istreamtype& i, std::size_t nrows, TableType& table)
+                {
+                    using value_type = typename TableType::value_type;
+                    std::vector<value_type> buffer;
+                    table.clear();
+                    table.reserve(nrows);
+                    while (nrows > 0)
+                        {
+                            auto n = std::min(nrows, serialization_chunk_size);
+                            read_table_rows(i, n, buffer);
+                            table.insert(table.end(), buffer.begin(), buffer.end());
+                            nrows -= n;
+                        }
+                }
+            } // namespace detail
+
             namespace backwards_compat
             {
                 struct mutation_record_V2
@@ -217,6 +568,11 @@ namespace fwdpp
 			 *  specified by fwdpp::ts::io::TS_TABLES_VERSION.
              *
              *  \version 0.7.4 Tables are written in a single call
+             *  \version 0.10.0 Format version 4 writes each table as
+             *  one block per column, preceded by the number of rows and,
+             *  for each column, the element size.
+             *
+             *  \throws std::runtime_error if writing to \a o fails.
 			 */
             {
                 o << "fwdppts";
@@ -225,40 +581,20 @@ namespace fwdpp
                 auto L = tables.genome_length();
                 sw(o, &L);
                 sw(o, &tables.edge_offset);
-                std::size_t num_edges = tables.edges.size(),
-                            num_nodes = tables.num_nodes(),
-                            num_mutations = tables.mutations.size(),
-                            num_sites = tables.sites.size();
-                sw(o, &num_edges);
-                sw(o, &num_nodes);
-                sw(o, &num_mutations);
-                sw(o, &num_sites);
-                if (!tables.edges.empty())
-                    {
-                        o.write(reinterpret_cast<const char*>(tables.edges.data()),
-                                tables.edges.size() * sizeof(edge));
-                    }
-                if (!tables.nodes.empty())
-                    {
-                        o.write(reinterpret_cast<const char*>(tables.nodes.data()),
-                                tables.nodes.size() * sizeof(node));
-                    }
-                if (!tables.mutations.empty())
-                    {
-                        o.write(reinterpret_cast<const char*>(tables.mutations.data()),
-                                tables.mutations.size() * sizeof(mutation_record));
-                    }
-                if (!tables.sites.empty())
-                    {
-                        o.write(reinterpret_cast<const char*>(tables.sites.data()),
-                                tables.sites.size() * sizeof(site));
-                    }
+                detail::write_columns<edge>(o, tables.edges);
+                detail::write_columns<node>(o, tables.nodes);
+                detail::write_columns<mutation_record>(o, tables.mutations);
+                detail::write_columns<site>(o, tables.sites);
                 std::size_t num_preserved_samples = tables.preserved_nodes.size();
                 sw(o, &num_preserved_samples);
                 if (num_preserved_samples)
                     {
                         sw(o, tables.preserved_nodes.data(), num_preserved_samples);
                     }
+                if (!o)
+                    {
+                        throw std::runtime_error("error writing tables");
+                    }
             }
 
             template <typename TableCollectionType> struct deserialize_tables
@@ -276,6 +612,8 @@ namespace fwdpp
 			 *  See fwdpp::ts::table_collection::build_indexes
              *
              *  \version 0.7.4 Tables are read in a single call
+             *  \version 0.10.0 Read format version 4 with one
+             *  read per column.
 			 */
                 {
                     //Reading data back in has to manage versions
@@ -294,82 +632,85 @@ namespace fwdpp
                     sr(i, &L);
                     TableCollectionType tables(L);
                     sr(i, &tables.edge_offset);
-                    std::size_t num_edges, num_nodes, num_mutations, num_sites;
-                    sr(i, &num_edges);
-                    sr(i, &num_nodes);
-                    sr(i, &num_mutations);
                     if (format == TS_TABLES_VERSION)
                         {
-                            sr(i, &num_sites);
+                            detail::read_columns<edge>(i, tables.edges);
+                            detail::read_columns<node>(i, tables.nodes);
+                            detail::read_columns<mutation_record>(i, tables.mutations);
+                            detail::read_columns<site>(i, tables.sites);
                         }
-                    if (format == TS_TABLES_VERSION || format == 2)
+                    else
                         {
-                            tables.edges.resize(num_edges);
-                            i.read(reinterpret_cast<char*>(tables.edges.data()),
-                                   num_edges * sizeof(edge));
-                            tables.nodes.resize(num_nodes);
-                            i.read(reinterpret_cast<char*>(tables.nodes.data()),
-                                   num_nodes * sizeof(node));
-
-                            if (format == TS_TABLES_VERSION)
+                            std::size_t num_edges, num_nodes, num_mutations, num_sites;
+                            sr(i, &num_edges);
+                            sr(i, &num_nodes);
+                            sr(i, &num_mutations);
+                            if (format == 3)
                                 {
-                                    tables.mutations.resize(num_mutations);
-                                    i.read(
-                                        reinterpret_cast<char*>(tables.mutations.data()),
-                                        num_mutations * sizeof(mutation_record));
-                                    tables.sites.resize(num_sites);
-                                    i.read(reinterpret_cast<char*>(tables.sites.data()),
-                                           num_sites * sizeof(site));
+                                    sr(i, &num_sites);
                                 }
-                            else
+                            if (format == 3 || format == 2)
                                 {
-                                    std::vector<backwards_compat::mutation_record_V2>
-                                        temp(num_mutations);
-                                    i.read(
-                                        reinterpret_cast<char*>(temp.data()),
-                                        num_mutations
-                                            * sizeof(
-                                                backwards_compat::mutation_record_V2));
-                                    for (auto t : temp)
+                                    detail::read_table_rows(i, num_edges, tables.edges);
+                                    detail::read_table_rows(i, num_nodes, tables.nodes);
+
+                                    if (format == 3)
                                         {
-                                            tables.mutations.emplace_back(
-                                                mutation_record{t.node, t.key,
-                                                                std::numeric_limits<
-                                                                    std::size_t>::max(),
-                                                                std::numeric_limits<
-                                                                    std::int8_t>::min(),
-                                                                true});
+                                            detail::read_table_rows(i, num_mutations,
+                                                                    tables.mutations);
+                                            detail::read_table_rows(i, num_sites,
+                                                                    tables.sites);
+                                        }
+                                    else
+                                        {
+                                            using record_V2
+                                                = backwards_compat::mutation_record_V2;
+                                            std::vector<record_V2> temp(num_mutations);
+                                            i.read(reinterpret_cast<char*>(temp.data()),
+                                                   num_mutations * sizeof(record_V2));
+                                            for (auto t : temp)
+                                                {
+                                                    tables.mutations.emplace_back(
+                                                        mutation_record{
+                                                            t.node, t.key,
+                                                            std::numeric_limits<
+                                                                std::size_t>::max(),
+                                                            std::numeric_limits<
+                                                                std::int8_t>::min(),
+                                                            true});
+                                                }
                                         }
                                 }
-                        }
-                    else if (format == 1)
-                        {
-                            deserialize_edge<TS_TABLES_VERSION> edge_reader;
-                            deserialize_node<TS_TABLES_VERSION> node_reader;
-                            // Format versions 1 and 2 have the same mutation_record type
-                            deserialize_mutation_record<2> mutation_record_reader;
-                            tables.edges.reserve(num_edges);
-                            for (std::size_t j = 0; j < num_edges; ++j)
-                                {
-                                    tables.edges.emplace_back(edge_reader(i));
-                                }
-                            tables.nodes.reserve(num_nodes);
-                            for (std::size_t j = 0; j < num_nodes; ++j)
+                            else if (format == 1)
                                 {
-                                    tables.nodes.emplace_back(node_reader(i));
+                                    deserialize_edge<TS_TABLES_VERSION> edge_reader;
+                                    deserialize_node<TS_TABLES_VERSION> node_reader;
+                                    // Format versions 1 and 2 have the same
+                                    // mutation_record type
+                                    deserialize_mutation_record<2> mutation_record_reader;
+                                    tables.edges.reserve(num_edges);
+                                    for (std::size_t j = 0; j < num_edges; ++j)
+                                        {
+                                            tables.edges.emplace_back(edge_reader(i));
+                                        }
+                                    tables.nodes.reserve(num_nodes);
+                                    for (std::size_t j = 0; j < num_nodes; ++j)
+                                        {
+                                            tables.nodes.emplace_back(node_reader(i));
+                                        }
+                                    tables.mutations.reserve(num_mutations);
+                                    for (std::size_t j = 0; j < num_mutations; ++j)
+                                        {
+                                            tables.mutations.emplace_back(
+                                                mutation_record_reader(i));
+                                        }
                                 }
-                            tables.mutations.reserve(num_mutations);
-                            for (std::size_t j = 0; j < num_mutations; ++j)
+                            else
                                 {
-                                    tables.mutations.emplace_back(
-                                        mutation_record_reader(i));
+                                    throw std::runtime_error(
+                                        "invalid serialization version detected");
                                 }
                         }
-                    else
-                        {
-                            throw std::runtime_error(
-                                "invalid serialization version detected");
-                        }
                     std::size_t num_preserved_samples;
                     sr(i, &num_preserved_samples);
                     if (num_preserved_samples)
@@ -12,8 +12,9 @@ namespace fwdpp
 			 *  \version 0.7.0 Added to library
              *  \version 0.7.4 Updated value to 2
              *  \version 0.8.0 Updated value to 3
+             *  \version 0.10.0 Updated value to 4
 			 */
-            constexpr const std::uint32_t TS_TABLES_VERSION = 3;
+            constexpr const std::uint32_t TS_TABLES_VERSION = 4;
         }
     } // namespace ts
 } // namespace fwdpp
@@ -5,6 +5,7 @@
 #include <vector>
 #include <cstdint>
 #include <tuple>
+#include <numeric>
 #include <algorithm>
 #include <stdexcept>
 #include <type_traits>
@@ -208,24 +209,46 @@ namespace fwdpp
                 typename table_type::site_table new_site_table;
                 ancestry_list ancestry;
                 segment_overlapper overlapper;
-                // NOTE: the whole idea of mutation map could
-                // go away?  Should benchmark (later) with
-                // high-mutation rate simulations.
+                // Mutations sorted by (node, position).
+                // Filled by a counting sort, using
+                // mutation_node_offsets as scratch space.
+                // Both are kept to reuse their memory.
                 std::vector<mutation_node_map_entry> mutation_map;
+                std::vector<std::size_t> mutation_node_offsets;
+                // Where each parent's edges are in the edge
+                // table output by the last simplification,
+                // and in the one being output now.
+                parent_edge_ranges edge_ranges, new_edge_ranges;
+                std::size_t num_output_edges;
 
                 simplifier_internal_state()
                     : new_edge_table{}, temp_edge_buffer{}, new_node_table{},
-                      new_site_table{}, ancestry{}, overlapper{}, mutation_map{}
+                      new_site_table{}, ancestry{}, overlapper{}, mutation_map{},
+                      mutation_node_offsets{}, edge_ranges{}, new_edge_ranges{},
+                      num_output_edges{0}
                 {
                 }
 
                 void
                 clear()
+                /// Note: edge_ranges are kept, as they
+                /// are used by the next simplification.
                 {
                     new_edge_table.clear();
                     new_node_table.clear();
                     temp_edge_buffer.clear();
                     new_site_table.clear();
+                    new_edge_ranges.clear();
+                    num_output_edges = 0;
+                }
+
+                void
+                finalize_edge_ranges(const TableCollectionType& tables)
+                /// Called once the output edge table is in place.
+                {
+                    new_edge_ranges.finalize(tables);
+                    edge_ranges.swap(new_edge_ranges);
+                    new_edge_ranges.clear();
                 }
             };
 
@@ -244,7 +267,7 @@ namespace fwdpp
             {
                 auto itr = std::find_if(
                     state.temp_edge_buffer.rbegin(), state.temp_edge_buffer.rend(),
-                    [child](const typename SimplifierState::edge_t& e) {
+                    [child](const auto& e) {
                         return e.child == child;
                     });
                 if (itr == state.temp_edge_buffer.rend())
@@ -275,14 +298,22 @@ namespace fwdpp
             {
                 std::stable_sort(begin(state.temp_edge_buffer),
                                  end(state.temp_edge_buffer),
-                                 [](const typename SimplifierState::edge_t& a,
-                                    const typename SimplifierState::edge_t& b) {
+                                 [](const auto& a, const auto& b) {
                                      return a.child < b.child;
                                  });
                 state.new_edge_table.insert(end(state.new_edge_table),
                                             begin(state.temp_edge_buffer),
                                             end(state.temp_edge_buffer));
-                return state.temp_edge_buffer.size();
+                auto n = state.temp_edge_buffer.size();
+                if (n)
+                    {
+                        // All buffered edges have the same parent
+                        state.new_edge_ranges.record(state.temp_edge_buffer[0].parent,
+                                                     state.num_output_edges,
+                                                     state.num_output_edges + n - 1);
+                        state.num_output_edges += n;
+                    }
+                return n;
             }
 
             inline void
@@ -349,9 +380,8 @@ namespace fwdpp
                                 if (output_id == NULL_INDEX)
                                     {
                                         state.new_node_table.emplace_back(
-                                            typename TableCollectionType::node_t{
-                                                input_node_table[parent_input_id].deme,
-                                                input_node_table[parent_input_id].time});
+                                            typename TableCollectionType::node_t(
+                                                input_node_table[parent_input_id]));
                                         output_id = static_cast<decltype(output_id)>(
                                             state.new_node_table.size() - 1);
                                         // update sample map
@@ -415,8 +445,8 @@ namespace fwdpp
                                     && edge_ptr->right > seg.left)
                                     {
                                         state.overlapper.enqueue(
-                                            std::max(seg.left, edge_ptr->left),
-                                            std::min(seg.right, edge_ptr->right),
+                                            std::max<double>(seg.left, edge_ptr->left),
+                                            std::min<double>(seg.right, edge_ptr->right),
                                             seg.node);
                                     }
                                 idx = state.ancestry.next(idx);
@@ -443,8 +473,7 @@ namespace fwdpp
                                 throw std::invalid_argument("invalid sample list");
                             }
                         state.new_node_table.emplace_back(
-                            typename TableCollectionType::node_t{tables.nodes[s].deme,
-                                                                 tables.nodes[s].time});
+                            typename TableCollectionType::node_t(tables.nodes[s]));
                         add_ancestry(
                             s, 0, tables.genome_length(),
                             static_cast<table_index_t>(state.new_node_table.size() - 1),
@@ -470,23 +499,79 @@ namespace fwdpp
             inline void
             prep_mutation_simplification(
                 const TableCollectionType& input_tables,
-                std::vector<mutation_node_map_entry>& mutation_map)
+                std::vector<mutation_node_map_entry>& mutation_map,
+                std::vector<std::size_t>& node_offsets)
+            /// Fill \a mutation_map with the mutation table sorted
+            /// by (node, position).
+            ///
+            /// The mutation table is normally sorted by position
+            /// (see fwdpp::ts::sort_tables_for_simplification),
+            /// in which case a stable counting sort on node gives
+            /// the required order in O(M + N) time for M mutations
+            /// and N nodes.  Otherwise, the mutations are sorted
+            /// in O(M log M) time.
+            ///
+            /// \version 0.10.0 Added to library
             {
+                const auto& mutations = input_tables.mutations;
+                const auto num_nodes = input_tables.num_nodes();
                 mutation_map.clear();
-                mutation_map.reserve(input_tables.mutations.size());
-                for (std::size_t i = 0; i < input_tables.mutations.size(); ++i)
+                mutation_map.reserve(mutations.size());
+                node_offsets.assign(num_nodes + 1, 0);
+                bool sorted_by_position = true;
+                for (std::size_t i = 0; i < mutations.size() && sorted_by_position; ++i)
                     {
-                        mutation_map.emplace_back(input_tables.mutations[i].node,
-                                                  input_tables.mutations[i].site, i);
+                        auto n = mutations[i].node;
+                        sorted_by_position
+                            = n >= 0 && static_cast<std::size_t>(n) < num_nodes
+                              && (i == 0
+                                  || !(input_tables.sites[mutations[i].site].position
+                                       < input_tables.sites[mutations[i - 1].site]
+                                             .position));
+                        if (sorted_by_position)
+                            {
+                                ++node_offsets[n + 1];
+                            }
                     }
+                if (!sorted_by_position)
+                    {
+                        for (std::size_t i = 0; i < mutations.size(); ++i)
+                            {
+                                mutation_map.emplace_back(mutations[i].node,
+                                                          mutations[i].site, i);
+                            }
+                        std::sort(begin(mutation_map), end(mutation_map),
+                                  [&input_tables](const mutation_node_map_entry& a,
+                                                  const mutation_node_map_entry& b) {
+                                      return std::tie(
+                                                 a.node,
+                                                 input_tables.sites[a.site].position)
+                                             < std::tie(
+                                                 b.node,
+                                                 input_tables.sites[b.site].position);
+                                  });
+                        return;
+                    }
+                std::partial_sum(begin(node_offsets), end(node_offsets),
+                                 begin(node_offsets));
+                mutation_map.resize(mutations.size(),
+                                    mutation_node_map_entry(NULL_INDEX, 0, 0));
+                for (std::size_t i = 0; i < mutations.size(); ++i)
+                    {
+                        const auto& mr = mutations[i];
+                        mutation_map[node_offsets[mr.node]++]
+                            = mutation_node_map_entry(mr.node, mr.site, i);
+                    }
+            }
 
-                std::sort(
-                    begin(mutation_map), end(mutation_map),
-                    [&input_tables](const mutation_node_map_entry& a,
-                                    const mutation_node_map_entry& b) {
-                        return std::tie(a.node, input_tables.sites[a.site].position)
-                               < std::tie(b.node, input_tables.sites[b.site].position);
-                    });
+            template <typename TableCollectionType>
+            inline void
+            prep_mutation_simplification(
+                const TableCollectionType& input_tables,
+                std::vector<mutation_node_map_entry>& mutation_map)
+            {
+                std::vector<std::size_t> node_offsets;
+                prep_mutation_simplification(input_tables, mutation_map, node_offsets);
             }
 
             template <typename TableCollectionType, typename PreservedVariantIndexes>
@@ -503,7 +588,8 @@ namespace fwdpp
                     std::is_integral<
                         typename PreservedVariantIndexes::value_type>::value,
                     "PreservedVariantIndexes::value_type must be an integer type");
-                prep_mutation_simplification(input_tables, state.mutation_map);
+                prep_mutation_simplification(input_tables, state.mutation_map,
+                                             state.mutation_node_offsets);
                 // Set all output nodes to null for now.
                 for (auto& mr : input_tables.mutations)
                     {
@@ -594,6 +680,8 @@ namespace fwdpp
             {
                 tables.edges.resize(
                     std::distance(begin(tables.edges), new_edge_destination));
+                tables.clear_indexes();
+                state.finalize_edge_ranges(tables);
                 tables.nodes.resize(state.new_node_table.size());
                 std::move(begin(state.new_node_table), end(state.new_node_table),
                           begin(tables.nodes));
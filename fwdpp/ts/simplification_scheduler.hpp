@@ -0,0 +1,420 @@
+#ifndef FWDPP_TS_SIMPLIFICATION_SCHEDULER_HPP
+#define FWDPP_TS_SIMPLIFICATION_SCHEDULER_HPP
+
+#include <limits>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include "definitions.hpp"
+#include "recording/edge_buffer.hpp"
+
+namespace fwdpp
+{
+    namespace ts
+    {
+        enum class simplification_reason : std::int8_t
+        /// Why a fwdpp::ts::simplification_scheduler asked for simplification
+        /// \version 0.10.0 Added to library
+        {
+            /// The maximum interval has passed
+            max_interval,
+            /// The tables would exceed the memory budget before the next generation
+            memory_budget,
+            /// The edge table grew by the current growth factor
+            edge_growth
+        };
+
+        struct simplification_decision
+        /// \brief One simplification scheduled by a fwdpp::ts::simplification_scheduler
+        ///
+        /// The timing and output fields are filled in by
+        /// fwdpp::ts::simplification_scheduler::record_simplification.
+        ///
+        /// \version 0.10.0 Added to library
+        {
+            /// Generation of the decision
+            std::uint32_t generation;
+            /// Generations since the previous simplification
+            std::uint32_t interval;
+            simplification_reason reason;
+            /// Number of edges before simplification
+            std::size_t edges_before;
+            /// Number of edges after simplification
+            std::size_t edges_after;
+            /// Memory use of the tables, and of any edge buffer,
+            /// before simplification
+            std::size_t bytes_before;
+            /// Seconds spent simulating since the previous simplification
+            double simulation_seconds;
+            /// Seconds spent simplifying
+            double simplification_seconds;
+            /// Growth factor in effect for the next interval
+            double growth_factor;
+        };
+
+        class simplification_scheduler
+        /*! \brief Decide when to simplify from edge table growth, timing, and memory
+         *
+         *  Simplifying every generation wastes time re-processing the same
+         *  ancestry.  Simplifying rarely wastes memory on edges that will be
+         *  removed.  The best interval depends on N, the recombination rate,
+         *  and the machine, so this class picks it as the simulation runs.
+         *
+         *  Simplification is requested when one of these holds:
+         *
+         *  1. max_interval() generations have passed.
+         *  2. The tables, plus one more generation of growth at the mean rate
+         *     since the last simplification, would exceed memory_budget().
+         *  3. At least min_interval() generations have passed and the number
+         *     of edges has grown to growth_factor() times its value after the
+         *     last simplification.
+         *
+         *  Memory use is that reported by
+         *  fwdpp::ts::table_collection::memory_usage.  When new edges are
+         *  recorded in a fwdpp::ts::edge_buffer, pass the buffer to
+         *  should_simplify and record_simplification, so that its births
+         *  and memory are counted.
+         *
+         *  After each simplification, growth_factor() is adapted from the
+         *  time spent.  If simplification took more than target_overhead()
+         *  of the time since the previous one, the factor is multiplied by
+         *  the ratio of the two, so that the next interval is longer.  If it
+         *  took less than half of the target, the factor is divided by the
+         *  ratio of half the target to the overhead.  Each step changes the
+         *  factor by at most max_growth_step(), and the factor stays within
+         *  [1.5, 1024].
+         *
+         *  Typical use:
+         *
+         *  \code
+         *  fwdpp::ts::simplification_scheduler scheduler(1, 1000, budget);
+         *  for (generation ...)
+         *  {
+         *      // simulate, adding edges to tables
+         *      if (scheduler.should_simplify(generation, tables))
+         *      {
+         *          scheduler.timed_simplification(tables, [&]() {
+         *              // sort and simplify tables
+         *          });
+         *      }
+         *  }
+         *  \endcode
+         *
+         *  decisions() returns a record of each simplification.
+         *
+         *  \version 0.10.0 Added to library
+         */
+        {
+          private:
+            using clock = std::chrono::steady_clock;
+
+            std::uint32_t min_interval_, max_interval_;
+            std::size_t memory_budget_;
+            double target_overhead_, growth_factor_;
+            std::uint32_t last_generation;
+            std::size_t edges_after_last, bytes_after_last;
+            bool pending;
+            clock::time_point last_time;
+            std::vector<simplification_decision> decisions_;
+
+            static constexpr double
+            min_growth_factor()
+            {
+                return 1.5;
+            }
+
+            static constexpr double
+            max_growth_factor()
+            {
+                return 1024.;
+            }
+
+            bool
+            should_simplify_details(std::uint32_t generation, std::size_t num_edges,
+                                    std::size_t bytes)
+            {
+                if (pending)
+                    {
+                        throw std::runtime_error("should_simplify called while a "
+                                                 "simplification is pending");
+                    }
+                if (generation < last_generation)
+                    {
+                        throw std::invalid_argument("generation is less than that of "
+                                                    "the last simplification");
+                    }
+                const std::uint32_t interval = generation - last_generation;
+                if (interval == 0)
+                    {
+                        return false;
+                    }
+                bool rv = false;
+                simplification_reason reason = simplification_reason::max_interval;
+                if (interval >= max_interval_)
+                    {
+                        rv = true;
+                    }
+                else if (memory_budget_ > 0)
+                    {
+                        const auto growth = bytes > bytes_after_last
+                                                ? (bytes - bytes_after_last) / interval
+                                                : 0;
+                        if (bytes + growth >= memory_budget_)
+                            {
+                                rv = true;
+                                reason = simplification_reason::memory_budget;
+                            }
+                    }
+                if (!rv && interval >= min_interval_
+                    && static_cast<double>(num_edges)
+                           >= growth_factor_ * static_cast<double>(edges_after_last))
+                    {
+                        rv = true;
+                        reason = simplification_reason::edge_growth;
+                    }
+                if (rv)
+                    {
+                        const double elapsed
+                            = std::chrono::duration<double>(clock::now() - last_time)
+                                  .count();
+                        decisions_.push_back(simplification_decision{
+                            generation, interval, reason, num_edges, 0, bytes, elapsed,
+                            0., growth_factor_});
+                        pending = true;
+                    }
+                return rv;
+            }
+
+            void
+            record_simplification_details(std::size_t num_edges, std::size_t bytes,
+                                          double simulation_seconds,
+                                          double simplification_seconds)
+            {
+                if (!pending)
+                    {
+                        throw std::runtime_error("no simplification is pending");
+                    }
+                if (simulation_seconds < 0. || simplification_seconds < 0.)
+                    {
+                        throw std::invalid_argument("times must be non-negative");
+                    }
+                auto& d = decisions_.back();
+                d.edges_after = num_edges;
+                d.simulation_seconds = simulation_seconds;
+                d.simplification_seconds = simplification_seconds;
+                const double total = simulation_seconds + simplification_seconds;
+                if (total > 0.)
+                    {
+                        const double overhead = simplification_seconds / total;
+                        if (overhead > target_overhead_)
+                            {
+                                growth_factor_ = std::min(
+                                    max_growth_factor(),
+                                    growth_factor_
+                                        * std::min(max_growth_step(),
+                                                   overhead / target_overhead_));
+                            }
+                        else if (overhead < target_overhead_ / 2.)
+                            {
+                                // overhead may be zero, giving a ratio of infinity
+                                growth_factor_ = std::max(
+                                    min_growth_factor(),
+                                    growth_factor_
+                                        / std::min(max_growth_step(),
+                                                   target_overhead_ / 2. / overhead));
+                            }
+                    }
+                d.growth_factor = growth_factor_;
+                last_generation = d.generation;
+                edges_after_last = num_edges;
+                bytes_after_last = bytes;
+                pending = false;
+                last_time = clock::now();
+            }
+
+            template <typename F>
+            double
+            time_simplification(const F& f)
+            {
+                if (!pending)
+                    {
+                        throw std::runtime_error("no simplification is pending");
+                    }
+                const auto start = clock::now();
+                f();
+                return std::chrono::duration<double>(clock::now() - start).count();
+            }
+
+          public:
+            simplification_scheduler(std::uint32_t min_interval,
+                                     std::uint32_t max_interval,
+                                     std::size_t memory_budget,
+                                     double target_overhead = 0.1)
+                : min_interval_(min_interval), max_interval_(max_interval),
+                  memory_budget_(memory_budget), target_overhead_(target_overhead),
+                  growth_factor_(2.), last_generation(0), edges_after_last(0),
+                  bytes_after_last(0), pending(false), last_time(clock::now()),
+                  decisions_{}
+            /// \param min_interval Minimum number of generations between simplifications,
+            ///        unless the memory budget forces one
+            /// \param max_interval Maximum number of generations between simplifications
+            /// \param memory_budget Memory budget for the tables, in bytes.
+            ///        Use 0 for no budget.
+            /// \param target_overhead Target fraction of run time spent simplifying
+            ///
+            /// \note The first interval is counted from generation 0.
+            {
+                if (min_interval < 1)
+                    {
+                        throw std::invalid_argument("min_interval must be > 0");
+                    }
+                if (max_interval < min_interval)
+                    {
+                        throw std::invalid_argument(
+                            "max_interval must be >= min_interval");
+                    }
+                if (!(target_overhead > 0. && target_overhead < 1.))
+                    {
+                        throw std::invalid_argument(
+                            "target_overhead must be in the interval (0, 1)");
+                    }
+            }
+
+            template <typename TableCollectionType>
+            bool
+            should_simplify(std::uint32_t generation, const TableCollectionType& tables)
+            /// Return true if \a tables should be simplified at \a generation.
+            ///
+            /// If the return value is true, the decision is appended to decisions()
+            /// and record_simplification must be called after simplifying.
+            {
+                return should_simplify_details(generation, tables.num_edges(),
+                                               tables.memory_usage());
+            }
+
+            template <typename TableCollectionType>
+            bool
+            should_simplify(std::uint32_t generation, const TableCollectionType& tables,
+                            const edge_buffer& new_edges)
+            /// Return true if \a tables, whose new edges are stored in
+            /// \a new_edges, should be simplified at \a generation.
+            /// Births in \a new_edges count as edges, and the buffer's
+            /// memory counts towards the budget.
+            {
+                return should_simplify_details(
+                    generation, tables.num_edges() + new_edges.size(),
+                    tables.memory_usage() + new_edges.memory_usage());
+            }
+
+            template <typename TableCollectionType>
+            void
+            record_simplification(const TableCollectionType& tables,
+                                  double simulation_seconds,
+                                  double simplification_seconds)
+            /// Record the outcome of the simplification requested by the last call
+            /// to should_simplify.
+            ///
+            /// \param tables The tables after simplification
+            /// \param simulation_seconds Time spent simulating since the previous
+            ///        simplification
+            /// \param simplification_seconds Time spent simplifying
+            {
+                record_simplification_details(tables.num_edges(), tables.memory_usage(),
+                                              simulation_seconds,
+                                              simplification_seconds);
+            }
+
+            template <typename TableCollectionType>
+            void
+            record_simplification(const TableCollectionType& tables,
+                                  const edge_buffer& new_edges,
+                                  double simulation_seconds,
+                                  double simplification_seconds)
+            /// Record the outcome of a simplification requested by
+            /// should_simplify(generation, tables, new_edges).
+            {
+                record_simplification_details(
+                    tables.num_edges() + new_edges.size(),
+                    tables.memory_usage() + new_edges.memory_usage(),
+                    simulation_seconds, simplification_seconds);
+            }
+
+            template <typename TableCollectionType, typename F>
+            void
+            timed_simplification(const TableCollectionType& tables, const F& f)
+            /// Call \a f, which must simplify \a tables, and record the
+            /// outcome using wall-clock times.
+            ///
+            /// Simulation time is measured from the end of the previous
+            /// simplification to the last call to should_simplify.
+            {
+                const double seconds = time_simplification(f);
+                record_simplification(tables, decisions_.back().simulation_seconds,
+                                      seconds);
+            }
+
+            template <typename TableCollectionType, typename F>
+            void
+            timed_simplification(const TableCollectionType& tables,
+                                 const edge_buffer& new_edges, const F& f)
+            /// As above, for tables whose new edges are stored in \a new_edges
+            {
+                const double seconds = time_simplification(f);
+                record_simplification(tables, new_edges,
+                                      decisions_.back().simulation_seconds, seconds);
+            }
+
+            static constexpr double
+            max_growth_step()
+            /// Largest factor by which growth_factor() changes
+            /// after one simplification
+            {
+                return 1.5;
+            }
+
+            const std::vector<simplification_decision>&
+            decisions() const
+            /// Record of all scheduled simplifications
+            {
+                return decisions_;
+            }
+
+            double
+            growth_factor() const
+            /// Current edge table growth factor
+            {
+                return growth_factor_;
+            }
+
+            std::uint32_t
+            min_interval() const
+            {
+                return min_interval_;
+            }
+
+            std::uint32_t
+            max_interval() const
+            {
+                return max_interval_;
+            }
+
+            std::size_t
+            memory_budget() const
+            {
+                return memory_budget_;
+            }
+
+            double
+            target_overhead() const
+            {
+                return target_overhead_;
+            }
+        };
+    } // namespace ts
+} // namespace fwdpp
+
+#endif
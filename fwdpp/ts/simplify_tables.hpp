@@ -163,7 +163,7 @@ namespace fwdpp
             double max_time = -std::numeric_limits<double>::max();
             for (auto a : alive_at_last_simplification)
                 {
-                    max_time = std::max(max_time, input_tables.nodes[a].time);
+                    max_time = std::max<double>(max_time, input_tables.nodes[a].time);
                 }
             auto buffer_rend = buffer.rbegin();
             for (; buffer_rend < buffer.rend(); ++buffer_rend)
@@ -195,7 +195,7 @@ namespace fwdpp
             // parent nodes were alive at the time of the last simplification.
 
             auto existing_edges = find_pre_existing_edges(
-                input_tables, alive_at_last_simplification, buffer);
+                input_tables, alive_at_last_simplification, buffer, state.edge_ranges);
             auto edge_ptr = input_tables.edges.cbegin();
             const auto edge_end = input_tables.edges.cend();
             for (auto& ex : existing_edges)
@@ -305,6 +305,8 @@ namespace fwdpp
             input_tables.edges.resize(state.new_edge_table.size());
             std::move(begin(state.new_edge_table), end(state.new_edge_table),
                       begin(input_tables.edges));
+            input_tables.clear_indexes();
+            state.finalize_edge_ranges(input_tables);
             input_tables.nodes.resize(state.new_node_table.size());
             std::move(begin(state.new_node_table), end(state.new_node_table),
                       begin(input_tables.nodes));
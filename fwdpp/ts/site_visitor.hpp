@@ -14,6 +14,7 @@ namespace fwdpp
         /// For example use, see implementation of ts::generate_data_matrix.
         /// \version 0.8.0 Added to fwdpp
         /// \version 0.9.0 Made a template class
+        /// \version 0.10.0 Added constructor taking a start position
         {
           private:
             const TableCollectionType& tables_;
@@ -58,6 +59,20 @@ namespace fwdpp
                 return tv;
             }
 
+            template <typename SAMPLES>
+            tree_visitor<TableCollectionType>
+            init_tree_visitor(const SAMPLES& samples, double start)
+            {
+                if (!(start > 0.) || !(start < tables_.genome_length()))
+                    {
+                        return init_tree_visitor(samples);
+                    }
+                tree_visitor<TableCollectionType> tv(tables_, samples,
+                                                     update_samples_list(true));
+                tv.seek(start);
+                return tv;
+            }
+
           public:
             template <typename SAMPLES>
             site_visitor(const TableCollectionType& tables, const SAMPLES& samples)
@@ -69,6 +84,27 @@ namespace fwdpp
             {
             }
 
+            template <typename SAMPLES>
+            site_visitor(const TableCollectionType& tables, const SAMPLES& samples,
+                         double start)
+                /// Visit only sites at positions >= start.  The first tree
+                /// is found with tree_visitor::seek rather than by iterating
+                /// over the trees to the left of \a start.
+                : tables_(tables), tv(init_tree_visitor(samples, start)),
+                  current_site(std::lower_bound(
+                      begin(tables.sites), std::end(tables.sites), start,
+                      [](typename TableCollectionType::site_table::const_reference s,
+                         double x) { return s.position < x; })),
+                  current_mutation(std::lower_bound(
+                      begin(tables.mutations), std::end(tables.mutations), start,
+                      [&tables](
+                          typename TableCollectionType::mutation_table::const_reference m,
+                          double x) { return tables.sites[m.site].position < x; })),
+                  mutations_at_current_site(std::end(tables_.mutations),
+                                            std::end(tables_.mutations))
+            {
+            }
+
             typename TableCollectionType::site_table::const_iterator
             operator()()
             {
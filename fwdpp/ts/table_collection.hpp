@@ -1,6 +1,7 @@
 #ifndef FWDPP_TS_TABLE_COLLECTION_HPP
 #define FWDPP_TS_TABLE_COLLECTION_HPP
 
+#include <array>
 #include <vector>
 #include <utility>
 #include <cstdint>
@@ -14,6 +15,8 @@
 #include <fwdpp/forward_types.hpp>
 #include <fwdpp/ts/exceptions.hpp>
 #include "definitions.hpp"
+#include "detail/radix_sort.hpp"
+#include "detail/memory_usage.hpp"
 
 namespace fwdpp
 {
@@ -32,6 +35,8 @@ namespace fwdpp
           private:
             /// Length of the genomic region.
             double L;
+            /// See edge_table_generation()
+            std::uint64_t edge_table_generation_;
 
           public:
             using node_table = NodeTableType;
@@ -64,8 +69,9 @@ namespace fwdpp
             std::vector<table_index_t> preserved_nodes;
 
             explicit table_collection(const double maxpos)
-                : L{maxpos}, nodes{}, edges{}, mutations{}, sites{}, input_left{},
-                  output_right{}, edge_offset{0}, preserved_nodes{}
+                : L{maxpos}, edge_table_generation_{0}, nodes{}, edges{}, mutations{},
+                  sites{}, input_left{}, output_right{}, edge_offset{0},
+                  preserved_nodes{}
             {
                 if (maxpos <= 0 || !std::isfinite(maxpos))
                     {
@@ -76,8 +82,9 @@ namespace fwdpp
             table_collection(const table_index_t num_initial_nodes,
                              const double initial_time, table_index_t pop,
                              const double maxpos)
-                : L{maxpos}, nodes{}, edges{}, mutations{}, sites{}, input_left{},
-                  output_right{}, edge_offset{0}, preserved_nodes{}
+                : L{maxpos}, edge_table_generation_{0}, nodes{}, edges{}, mutations{},
+                  sites{}, input_left{}, output_right{}, edge_offset{0},
+                  preserved_nodes{}
             {
                 if (maxpos <= 0 || !std::isfinite(maxpos))
                     {
@@ -98,6 +105,7 @@ namespace fwdpp
                 mutations.clear();
                 preserved_nodes.clear();
                 sites.clear();
+                clear_indexes();
             }
 
             void
@@ -141,6 +149,7 @@ namespace fwdpp
             push_back_edge(double l, double r, table_index_t parent, table_index_t child)
             {
                 edges.push_back(edge_t{l, r, parent, child});
+                ++edge_table_generation_;
                 return edges.size();
             }
 
@@ -149,6 +158,7 @@ namespace fwdpp
             emplace_back_edge(args&&... Args)
             {
                 edges.emplace_back(edge_t{std::forward<args>(Args)...});
+                ++edge_table_generation_;
                 return edges.size();
             }
 
@@ -184,34 +194,100 @@ namespace fwdpp
                 return mutations.size() - 1;
             }
 
+            void
+            build_indexes(unsigned num_threads)
+            /// Generates the index vectors referred to
+            /// as I and O in Kelleher et al. (2016)
+            ///
+            /// The vectors are filled by a radix sort on
+            /// (position, parent time) keys.  If \a num_threads > 1,
+            /// large tables are sorted in parallel.
+            ///
+            /// \version 0.10.0 Added to library
+            {
+                input_left.clear();
+                output_right.clear();
+                index_edges(0, num_threads, input_left_key(), input_left);
+                index_edges(0, num_threads, output_right_key(), output_right);
+            }
+
             void
             build_indexes()
             /// Generates the index vectors referred to
             /// as I and O in Kelleher et al. (2016)
+            {
+                build_indexes(1);
+            }
+
+            void
+            update_indexes(unsigned num_threads)
+            /// \brief Bring the index vectors up to date after edges are appended.
+            ///
+            /// If input_left and output_right index the first \a k rows
+            /// of the edge table, rows \a k onwards are sorted and then merged
+            /// into the existing indexes.  The result is the same as from
+            /// build_indexes, at the cost of sorting only the new edges.
+            ///
+            /// Rows [0, k) must not have changed since the indexes were built.
+            /// Library functions that rewrite the edge table call clear_indexes,
+            /// in which case this function calls build_indexes.
+            ///
+            /// \version 0.10.0 Added to library
+            {
+                const auto nindexed = input_left.size();
+                if (nindexed == 0 || nindexed > edges.size()
+                    || output_right.size() != nindexed)
+                    {
+                        build_indexes(num_threads);
+                        return;
+                    }
+                merge_new_edges(nindexed, num_threads, input_left_key(), input_left);
+                merge_new_edges(nindexed, num_threads, output_right_key(),
+                                output_right);
+            }
+
+            void
+            update_indexes()
+            /// \version 0.10.0 Added to library
+            {
+                update_indexes(1);
+            }
+
+            void
+            clear_indexes() noexcept
+            /// Empty the index vectors.  Must be called
+            /// when existing rows of the edge table are changed.
+            /// Also increments edge_table_generation().
+            ///
+            /// \version 0.10.0 Added to library
             {
                 input_left.clear();
                 output_right.clear();
-                input_left.resize(edges.size());
-                output_right.resize(edges.size());
-                std::iota(begin(input_left), end(input_left), 0);
-                std::iota(begin(output_right), end(output_right), 0);
-                std::sort(begin(input_left), end(input_left), [this](auto i, auto j) {
-                    if (edges[i].left == edges[j].left)
-                        {
-                            return nodes[edges[i].parent].time
-                                   > nodes[edges[j].parent].time;
-                        }
-                    return edges[i].left < edges[j].left;
-                });
-                std::sort(begin(output_right), end(output_right),
-                          [this](auto i, auto j) {
-                              if (edges[i].right == edges[j].right)
-                                  {
-                                      return nodes[edges[i].parent].time
-                                             < nodes[edges[j].parent].time;
-                                  }
-                              return edges[i].right < edges[j].right;
-                          });
+                ++edge_table_generation_;
+            }
+
+            std::uint64_t
+            edge_table_generation() const noexcept
+            /// A counter that changes whenever rows are added with
+            /// push_back_edge or emplace_back_edge, and whenever
+            /// clear_indexes is called.  Data recorded about the edge
+            /// table, such as fwdpp::ts::parent_edge_ranges, are only
+            /// valid while this value is unchanged.  Code that modifies
+            /// tables.edges directly must call clear_indexes.
+            ///
+            /// \version 0.10.0 Added to library
+            {
+                return edge_table_generation_;
+            }
+
+            bool
+            indexed() const noexcept
+            /// Return true if the index vectors cover the whole edge table
+            ///
+            /// \version 0.10.0 Added to library
+            {
+                return input_left.size() == edges.size()
+                       && output_right.size() == edges.size();
             }
 
             std::size_t
@@ -232,6 +308,21 @@ namespace fwdpp
                 return L;
             }
 
+            std::size_t
+            memory_usage() const
+            /// Bytes allocated by the tables and index vectors.
+            /// Tables stored in memory-mapped files report the
+            /// size of their mappings.
+            ///
+            /// \version 0.10.0 Added to library
+            {
+                return detail::memory_usage(nodes) + detail::memory_usage(edges)
+                       + detail::memory_usage(sites) + detail::memory_usage(mutations)
+                       + detail::memory_usage(input_left)
+                       + detail::memory_usage(output_right)
+                       + detail::memory_usage(preserved_nodes);
+            }
+
             inline bool
             operator==(const table_collection& b) const
             {
@@ -246,6 +337,71 @@ namespace fwdpp
             {
                 return !(*this == b);
             }
+
+          private:
+            using index_key = std::array<std::uint64_t, 2>;
+
+            auto
+            input_left_key() const
+            // I: increasing left, then decreasing parent time
+            {
+                return [this](std::size_t i) {
+                    const auto& e = edges[i];
+                    return index_key{
+                        {detail::radix_key(static_cast<double>(e.left)),
+                         ~detail::radix_key(static_cast<double>(nodes[e.parent].time))}};
+                };
+            }
+
+            auto
+            output_right_key() const
+            // O: increasing right, then increasing parent time
+            {
+                return [this](std::size_t i) {
+                    const auto& e = edges[i];
+                    return index_key{
+                        {detail::radix_key(static_cast<double>(e.right)),
+                         detail::radix_key(static_cast<double>(nodes[e.parent].time))}};
+                };
+            }
+
+            template <typename KeyFunction>
+            void
+            index_edges(std::size_t first, unsigned num_threads, const KeyFunction& key,
+                        std::vector<table_index_t>& index) const
+            // Append ids of edges [first, edges.size()) to index,
+            // sorted by key.  Ties keep table order.
+            {
+                using record = detail::radix_sort_record<2>;
+                std::vector<record> records(edges.size() - first), buffer;
+                for (std::size_t i = first; i < edges.size(); ++i)
+                    {
+                        records[i - first] = record{key(i), i};
+                    }
+                detail::radix_sort(records, buffer, num_threads);
+                index.reserve(edges.size());
+                for (const auto& r : records)
+                    {
+                        index.push_back(static_cast<table_index_t>(r.index));
+                    }
+            }
+
+            template <typename KeyFunction>
+            void
+            merge_new_edges(std::size_t nindexed, unsigned num_threads,
+                            const KeyFunction& key, std::vector<table_index_t>& index) const
+            {
+                if (nindexed == edges.size())
+                    {
+                        return;
+                    }
+                index_edges(nindexed, num_threads, key, index);
+                // Stable: on ties, previously-indexed edges
+                // (which have smaller ids) come first.
+                std::inplace_merge(
+                    begin(index), begin(index) + nindexed, end(index),
+                    [&key](table_index_t i, table_index_t j) { return key(i) < key(j); });
+            }
         };
     } // namespace ts
 } // namespace fwdpp
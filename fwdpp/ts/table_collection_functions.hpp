@@ -2,10 +2,12 @@
 #define FWDPP_TS_TABLE_COLLECTION_FUNCTIONS_HPP
 
 #include <tuple>
+#include <vector>
 #include <cstddef>
 #include <algorithm>
 #include <stdexcept>
 #include <fwdpp/ts/exceptions.hpp>
+#include "detail/radix_sort.hpp"
 
 namespace fwdpp
 {
@@ -18,8 +20,9 @@ namespace fwdpp
          * @version 0.9.0 Added to library
          */
         {
-            return [&tables](const typename TableCollectionType::edge_t& a,
-                             const typename TableCollectionType::edge_t& b) {
+            // Generic arguments allow containers whose
+            // elements are proxies to rows (see fwdpp::ts::column_table)
+            return [&tables](const auto& a, const auto& b) {
                 auto ga = tables.nodes[a.parent].time;
                 auto gb = tables.nodes[b.parent].time;
                 if (ga == gb)
@@ -42,8 +45,7 @@ namespace fwdpp
         inline auto
         get_minimal_edge_sort_cmp(const TableCollectionType& tables)
         {
-            return [&tables](const typename TableCollectionType::edge_t& a,
-                             const typename TableCollectionType::edge_t& b) {
+            return [&tables](const auto& a, const auto& b) {
                 auto ga = tables.nodes[a.parent].time;
                 auto gb = tables.nodes[b.parent].time;
                 return ga > gb
@@ -53,19 +55,111 @@ namespace fwdpp
 
         template <typename TableCollectionType>
         inline void
-        sort_edge_table(std::ptrdiff_t offset, TableCollectionType& tables)
+        sort_edge_table(std::ptrdiff_t offset, TableCollectionType& tables,
+                        unsigned num_threads)
+        /*!
+         * Sort edges from \a offset onwards and move them to the
+         * front of the table.  The order is that of get_edge_sort_cmp.
+         *
+         * Sorting is a radix sort on keys built once per edge,
+         * which avoids looking up parent node times during comparisons.
+         * The key is the rank of the parent in (decreasing time, id)
+         * order followed by the child id.
+         * If \a num_threads > 1, large tables are sorted in parallel.
+         * The keys take 32 bytes per edge while sorting.  The edges
+         * are then permuted in place, without a copy of the table.
+         *
+         * @version 0.10.0 Added to library
+         */
         {
             if (offset < 0 || offset >= static_cast<std::ptrdiff_t>(tables.edges.size()))
                 {
                     throw std::out_of_range("invalid edge table offset");
                 }
-            auto cmp = get_edge_sort_cmp(tables);
-            std::sort(tables.edges.begin() + offset, tables.edges.end(), cmp);
+            using record = detail::radix_sort_record<1>;
+            std::vector<record> records(tables.nodes.size()), buffer;
+            // Rank nodes by decreasing time, breaking ties by id,
+            // so that (time, parent) becomes one integer.
+            for (std::size_t i = 0; i < tables.nodes.size(); ++i)
+                {
+                    records[i] = record{
+                        {~detail::radix_key(static_cast<double>(tables.nodes[i].time))},
+                        i};
+                }
+            detail::radix_sort(records, buffer, num_threads);
+            std::vector<std::uint32_t> node_rank(tables.nodes.size());
+            for (std::size_t i = 0; i < records.size(); ++i)
+                {
+                    node_rank[records[i].index] = static_cast<std::uint32_t>(i);
+                }
+            records.resize(tables.edges.size() - offset);
+            for (std::size_t i = offset; i < tables.edges.size(); ++i)
+                {
+                    const auto& e = tables.edges[i];
+                    records[i - offset] = record{
+                        {(static_cast<std::uint64_t>(node_rank[e.parent]) << 32)
+                         | static_cast<std::uint32_t>(e.child)},
+                        i};
+                }
+            detail::radix_sort(records, buffer, num_threads);
+            // Edges from the same parent to the same child
+            // are few, and are ordered by left.
+            for (auto first = begin(records); first < end(records);)
+                {
+                    auto last = first + 1;
+                    while (last < end(records) && last->key == first->key)
+                        {
+                            ++last;
+                        }
+                    if (last - first > 1)
+                        {
+                            std::stable_sort(first, last,
+                                             [&tables](const record& a, const record& b) {
+                                                 return tables.edges[a.index].left
+                                                        < tables.edges[b.index].left;
+                                             });
+                        }
+                    first = last;
+                }
+            buffer.clear();
+            buffer.shrink_to_fit();
+            // Move edges into place by following the cycles of the
+            // permutation, so that no copy of the table is made.
+            // An edge that is in place is marked by records[i].index
+            // pointing at its own position.
+            using edge_t = typename TableCollectionType::edge_t;
+            for (std::size_t i = 0; i < records.size(); ++i)
+                {
+                    const std::size_t start = i + offset;
+                    if (records[i].index == start)
+                        {
+                            continue;
+                        }
+                    const edge_t first = tables.edges[start];
+                    auto dest = start;
+                    while (records[dest - offset].index != start)
+                        {
+                            const auto src = records[dest - offset].index;
+                            tables.edges[dest] = tables.edges[src];
+                            records[dest - offset].index = dest;
+                            dest = src;
+                        }
+                    tables.edges[dest] = first;
+                    records[dest - offset].index = dest;
+                }
             if (offset > 0)
                 {
                     std::rotate(begin(tables.edges), begin(tables.edges) + offset,
                                 end(tables.edges));
                 }
+            tables.clear_indexes();
+        }
+
+        template <typename TableCollectionType>
+        inline void
+        sort_edge_table(std::ptrdiff_t offset, TableCollectionType& tables)
+        {
+            sort_edge_table(offset, tables, 1);
         }
 
         template <typename TableCollectionType>
@@ -149,28 +243,51 @@ namespace fwdpp
         template <typename TableCollectionType>
         inline void
         sort_tables_for_simplification(std::ptrdiff_t edge_table_offset,
-                                       TableCollectionType& tables)
+                                       TableCollectionType& tables,
+                                       unsigned num_threads)
         /// Sorts the tables for simplification, which means only
         /// sorting edge and mutation tables, as the site table
         /// will be rebuilt during simplification.
         ///
         /// If \a edge_table_offset < 0, the edge table is not sorted.
+        ///
+        /// \a num_threads is passed on to sort_edge_table.
+        ///
+        /// \version 0.10.0 Added \a num_threads
         {
             if (edge_table_offset >= 0)
                 {
-                    sort_edge_table(edge_table_offset, tables);
+                    sort_edge_table(edge_table_offset, tables, num_threads);
                 }
             sort_mutation_table(tables);
         }
 
         template <typename TableCollectionType>
         inline void
-        sort_tables(std::ptrdiff_t edge_table_offset, TableCollectionType& tables)
+        sort_tables_for_simplification(std::ptrdiff_t edge_table_offset,
+                                       TableCollectionType& tables)
+        {
+            sort_tables_for_simplification(edge_table_offset, tables, 1);
+        }
+
+        template <typename TableCollectionType>
+        inline void
+        sort_tables(std::ptrdiff_t edge_table_offset, TableCollectionType& tables,
+                    unsigned num_threads)
         /// Sort all tables.  The site table is rebuilt.
+        ///
+        /// \version 0.10.0 Added \a num_threads
         {
-            sort_edge_table(edge_table_offset, tables);
+            sort_edge_table(edge_table_offset, tables, num_threads);
             sort_mutation_table_and_rebuild_site_table(tables);
         }
+
+        template <typename TableCollectionType>
+        inline void
+        sort_tables(std::ptrdiff_t edge_table_offset, TableCollectionType& tables)
+        {
+            sort_tables(edge_table_offset, tables, 1);
+        }
     }
 }
 
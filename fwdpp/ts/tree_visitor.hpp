@@ -30,9 +30,12 @@ namespace fwdpp
         ///
         /// \version 0.7.0 Added to fwdpp
         /// \version 0.7.4 Updates tree roots during traversal.
+        /// \version 0.10.0 Constructors throw if the index vectors do not
+        /// cover the entire edge table.
+        /// \version 0.10.0 Added seek() and prev().
         {
           private:
-            std::vector<table_index_t>::const_iterator j, jM, k, kM;
+            std::vector<table_index_t>::const_iterator j0, j, jM, k0, k, kM;
             typename TableCollectionType::edge_table::const_iterator beg_edges,
                 end_edges;
             double x, maxpos;
@@ -196,12 +199,186 @@ namespace fwdpp
                     }
             }
 
+            void
+            remove_edge(table_index_t p, table_index_t c)
+            {
+                const auto lsib = marginal.left_sib[c];
+                const auto rsib = marginal.right_sib[c];
+                if (lsib == NULL_INDEX)
+                    {
+                        marginal.left_child[p] = rsib;
+                    }
+                else
+                    {
+                        marginal.right_sib[lsib] = rsib;
+                    }
+                if (rsib == NULL_INDEX)
+                    {
+                        marginal.right_child[p] = lsib;
+                    }
+                else
+                    {
+                        marginal.left_sib[rsib] = lsib;
+                    }
+                marginal.parents[c] = NULL_INDEX;
+                marginal.left_sib[c] = NULL_INDEX;
+                marginal.right_sib[c] = NULL_INDEX;
+                detail::outgoing_leaf_counts(marginal, p, c);
+                if (advancing_sample_list)
+                    {
+                        detail::update_samples_list(marginal, p);
+                    }
+                update_roots_outgoing(p, c, marginal);
+            }
+
+            void
+            insert_edge(table_index_t p, table_index_t c)
+            {
+                const auto rchild = marginal.right_child[p];
+                const auto lsib = marginal.left_sib[c];
+                const auto rsib = marginal.right_sib[c];
+                if (rchild == NULL_INDEX)
+                    {
+                        marginal.left_child[p] = c;
+                        marginal.left_sib[c] = NULL_INDEX;
+                        marginal.right_sib[c] = NULL_INDEX;
+                    }
+                else
+                    {
+                        marginal.right_sib[rchild] = c;
+                        marginal.left_sib[c] = rchild;
+                        marginal.right_sib[c] = NULL_INDEX;
+                    }
+                // The entry for the child refers to
+                // the parent's location in the node table.
+                marginal.parents[c] = p;
+                marginal.right_child[p] = c;
+                detail::incoming_leaf_counts(marginal, p, c);
+                if (advancing_sample_list)
+                    {
+                        detail::update_samples_list(marginal, p);
+                    }
+                update_roots_incoming(p, c, lsib, rsib, marginal);
+            }
+
+            void
+            finish_tree()
+            {
+                // This is a big "gotcha".
+                // The root tracking functions will sometimes
+                // result in left_root not actually being the left_root.
+                // We loop through the left_sibs to fix that.
+                if (marginal.left_root != NULL_INDEX)
+                    {
+                        while (marginal.left_sib[marginal.left_root]
+                               != NULL_INDEX)
+                            {
+                                marginal.left_root
+                                    = marginal.left_sib[marginal.left_root];
+                            }
+                    }
+#ifndef NDEBUG
+                // Validate the roots via brute-force.
+                auto lr = marginal.left_root;
+                if (lr == NULL_INDEX)
+                    {
+                        throw std::runtime_error(
+                            "FWDPP DEBUG: left_root is null");
+                    }
+                std::vector<int> is_root(marginal.sample_index_map.size(), 0);
+                std::vector<int> processed(is_root.size(), 0);
+                for (std::size_t s = 0; s < marginal.sample_index_map.size();
+                     ++s)
+                    {
+                        if (marginal.sample_index_map[s] != NULL_INDEX)
+                            {
+                                table_index_t u = s;
+                                auto root = u;
+                                bool early_exit = false;
+                                while (u != NULL_INDEX)
+                                    {
+                                        if (processed[u])
+                                            {
+                                                early_exit = true;
+                                                break;
+                                            }
+                                        processed[u] = 1;
+                                        root = u;
+                                        u = marginal.parents[u];
+                                    }
+                                if (early_exit == false)
+                                    {
+                                        is_root[root] = 1;
+                                    }
+                            }
+                    }
+                int nroots_brute = 0;
+                for (auto r : is_root)
+                    {
+                        nroots_brute += r;
+                    }
+                if (nroots_brute != marginal.num_roots())
+                    {
+                        throw std::runtime_error("FWDPP DEBUG: num_roots "
+                                                 "disagreement");
+                    }
+                while (lr != NULL_INDEX)
+                    {
+                        if (is_root[lr] != 1)
+                            {
+                                throw std::runtime_error("FWDPP DEBUG: root "
+                                                         "contents "
+                                                         "disagreement");
+                            }
+                        lr = marginal.right_sib[lr];
+                    }
+#endif
+            }
+
+            double
+            next_breakpoint() const
+            /// Right end of the tree whose edges
+            /// have been processed up to j and k.
+            {
+                double right = maxpos;
+                if (j < jM)
+                    {
+                        right = std::min<double>(right, (beg_edges + *j)->left);
+                    }
+                if (k < kM)
+                    {
+                        right = std::min<double>(right, (beg_edges + *k)->right);
+                    }
+                return right;
+            }
+
+            double
+            previous_breakpoint(
+                std::vector<table_index_t>::const_iterator jcurrent,
+                std::vector<table_index_t>::const_iterator kcurrent) const
+            /// Left end of the tree whose edges have been
+            /// processed up to jcurrent and kcurrent.
+            {
+                double left = 0.0;
+                if (jcurrent > j0)
+                    {
+                        left = std::max<double>(left, (beg_edges + *(jcurrent - 1))->left);
+                    }
+                if (kcurrent > k0)
+                    {
+                        left = std::max<double>(left,
+                                                (beg_edges + *(kcurrent - 1))->right);
+                    }
+                return left;
+            }
+
           public:
             template <typename SAMPLES>
             tree_visitor(const TableCollectionType& tables, SAMPLES&& samples,
                          update_samples_list update)
-                : j(tables.input_left.cbegin()), jM(tables.input_left.cend()),
-                  k(tables.output_right.cbegin()), kM(tables.output_right.cend()),
+                : j0(tables.input_left.cbegin()), j(j0), jM(tables.input_left.cend()),
+                  k0(tables.output_right.cbegin()), k(k0),
+                  kM(tables.output_right.cend()),
                   beg_edges(begin(tables.edges)), end_edges(end(tables.edges)), x(0.0),
                   maxpos(tables.genome_length()),
                   marginal(tables.num_nodes(), std::forward<SAMPLES>(samples),
@@ -209,7 +386,7 @@ namespace fwdpp
                   advancing_sample_list(update.get())
             /// \todo Document
             {
-                if ((j == jM || k == kM) && !tables.edges.empty())
+                if (!tables.indexed())
                     {
                         throw std::invalid_argument("tables are not indexed");
                     }
@@ -219,14 +396,15 @@ namespace fwdpp
                          const std::vector<table_index_t>& samples,
                          const std::vector<table_index_t>& preserved_nodes,
                          update_samples_list update)
-                : j(tables.input_left.cbegin()), jM(tables.input_left.cend()),
-                  k(tables.output_right.cbegin()), kM(tables.output_right.cend()),
+                : j0(tables.input_left.cbegin()), j(j0), jM(tables.input_left.cend()),
+                  k0(tables.output_right.cbegin()), k(k0),
+                  kM(tables.output_right.cend()),
                   beg_edges(begin(tables.edges)), end_edges(end(tables.edges)), x(0.0),
                   maxpos(tables.genome_length()),
                   marginal(tables.num_nodes(), samples, preserved_nodes, update.get()),
                   advancing_sample_list(update.get())
             {
-                if ((j == jM || k == kM) && !tables.edges.empty())
+                if (!tables.indexed())
                     {
                         throw std::invalid_argument("tables are not indexed");
                     }
@@ -254,159 +432,26 @@ namespace fwdpp
 
             inline bool
             operator()()
+            /// Advance to the next tree.
+            ///
+            /// \return false if there are no more trees
             {
                 if (j < jM || x < maxpos)
                     {
                         while (k < kM && (beg_edges + *k)->right == x) // T4
                             {
-                                const auto p = (beg_edges + *k)->parent;
-                                const auto c = (beg_edges + *k)->child;
-                                const auto lsib = marginal.left_sib[c];
-                                const auto rsib = marginal.right_sib[c];
-                                if (lsib == NULL_INDEX)
-                                    {
-                                        marginal.left_child[p] = rsib;
-                                    }
-                                else
-                                    {
-                                        marginal.right_sib[lsib] = rsib;
-                                    }
-                                if (rsib == NULL_INDEX)
-                                    {
-                                        marginal.right_child[p] = lsib;
-                                    }
-                                else
-                                    {
-                                        marginal.left_sib[rsib] = lsib;
-                                    }
-                                marginal.parents[c] = NULL_INDEX;
-                                marginal.left_sib[c] = NULL_INDEX;
-                                marginal.right_sib[c] = NULL_INDEX;
-                                detail::outgoing_leaf_counts(marginal,
-                                                             (beg_edges + *k)->parent,
-                                                             (beg_edges + *k)->child);
-                                if (advancing_sample_list)
-                                    {
-                                        detail::update_samples_list(
-                                            marginal, (beg_edges + *k)->parent);
-                                    }
-                                update_roots_outgoing(p, c, marginal);
+                                remove_edge((beg_edges + *k)->parent,
+                                            (beg_edges + *k)->child);
                                 ++k;
                             }
                         while (j < jM && (beg_edges + *j)->left == x) // Step T2
                             {
-                                const auto p = (beg_edges + *j)->parent;
-                                const auto c = (beg_edges + *j)->child;
-                                const auto rchild = marginal.right_child[p];
-                                const auto lsib = marginal.left_sib[c];
-                                const auto rsib = marginal.right_sib[c];
-                                if (rchild == NULL_INDEX)
-                                    {
-                                        marginal.left_child[p] = c;
-                                        marginal.left_sib[c] = NULL_INDEX;
-                                        marginal.right_sib[c] = NULL_INDEX;
-                                    }
-                                else
-                                    {
-                                        marginal.right_sib[rchild] = c;
-                                        marginal.left_sib[c] = rchild;
-                                        marginal.right_sib[c] = NULL_INDEX;
-                                    }
-                                // The entry for the child refers to
-                                // the parent's location in the node table.
-                                marginal.parents[c] = (beg_edges + *j)->parent;
-                                marginal.right_child[p] = c;
-                                detail::incoming_leaf_counts(marginal,
-                                                             (beg_edges + *j)->parent,
-                                                             (beg_edges + *j)->child);
-                                if (advancing_sample_list)
-                                    {
-                                        detail::update_samples_list(
-                                            marginal, (beg_edges + *j)->parent);
-                                    }
-                                update_roots_incoming(p, c, lsib, rsib, marginal);
-
+                                insert_edge((beg_edges + *j)->parent,
+                                            (beg_edges + *j)->child);
                                 ++j;
                             }
-
-                        // This is a big "gotcha".
-                        // The root tracking functions will sometimes
-                        // result in left_root not actually being the left_root.
-                        // We loop through the left_sibs to fix that.
-                        if (marginal.left_root != NULL_INDEX)
-                            {
-                                while (marginal.left_sib[marginal.left_root]
-                                       != NULL_INDEX)
-                                    {
-                                        marginal.left_root
-                                            = marginal.left_sib[marginal.left_root];
-                                    }
-                            }
-#ifndef NDEBUG
-                        // Validate the roots via brute-force.
-                        auto lr = marginal.left_root;
-                        if (lr == NULL_INDEX)
-                            {
-                                throw std::runtime_error(
-                                    "FWDPP DEBUG: left_root is null");
-                            }
-                        std::vector<int> is_root(marginal.sample_index_map.size(), 0);
-                        std::vector<int> processed(is_root.size(), 0);
-                        for (std::size_t s = 0; s < marginal.sample_index_map.size();
-                             ++s)
-                            {
-                                if (marginal.sample_index_map[s] != NULL_INDEX)
-                                    {
-                                        table_index_t u = s;
-                                        auto root = u;
-                                        bool early_exit = false;
-                                        while (u != NULL_INDEX)
-                                            {
-                                                if (processed[u])
-                                                    {
-                                                        early_exit = true;
-                                                        break;
-                                                    }
-                                                processed[u] = 1;
-                                                root = u;
-                                                u = marginal.parents[u];
-                                            }
-                                        if (early_exit == false)
-                                            {
-                                                is_root[root] = 1;
-                                            }
-                                    }
-                            }
-                        int nroots_brute = 0;
-                        for (auto r : is_root)
-                            {
-                                nroots_brute += r;
-                            }
-                        if (nroots_brute != marginal.num_roots())
-                            {
-                                throw std::runtime_error("FWDPP DEBUG: num_roots "
-                                                         "disagreement");
-                            }
-                        while (lr != NULL_INDEX)
-                            {
-                                if (is_root[lr] != 1)
-                                    {
-                                        throw std::runtime_error("FWDPP DEBUG: root "
-                                                                 "contents "
-                                                                 "disagreement");
-                                    }
-                                lr = marginal.right_sib[lr];
-                            }
-#endif
-                        double right = maxpos;
-                        if (j < jM)
-                            {
-                                right = std::min(right, (beg_edges + *j)->left);
-                            }
-                        if (k < kM)
-                            {
-                                right = std::min(right, (beg_edges + *k)->right);
-                            }
+                        finish_tree();
+                        double right = next_breakpoint();
                         marginal.left = x;
                         marginal.right = right;
                         // Must set return value before
@@ -418,6 +463,92 @@ namespace fwdpp
                     }
                 return false;
             }
+
+            bool
+            prev()
+            /*! \brief Move to the previous tree.
+             *
+             *  Edges that start at the left end of the current
+             *  tree are removed and those that end there are
+             *  inserted, which is the forward algorithm run
+             *  in reverse.
+             *
+             *  \return false if the current tree is the first one,
+             *  or if no tree has been visited yet.  In that case,
+             *  the current tree is not changed.
+             *
+             *  \version 0.10.0 Added to fwdpp
+             */
+            {
+                if (!(marginal.left > 0.0))
+                    {
+                        return false;
+                    }
+                const double pos = marginal.left;
+                while (j > j0 && (beg_edges + *(j - 1))->left == pos)
+                    {
+                        --j;
+                        remove_edge((beg_edges + *j)->parent, (beg_edges + *j)->child);
+                    }
+                while (k > k0 && (beg_edges + *(k - 1))->right == pos)
+                    {
+                        --k;
+                        insert_edge((beg_edges + *k)->parent, (beg_edges + *k)->child);
+                    }
+                finish_tree();
+                marginal.left = previous_breakpoint(j, k);
+                marginal.right = pos;
+                x = pos;
+                return true;
+            }
+
+            void
+            seek(double position)
+            /*! \brief Move to the tree containing \a position.
+             *
+             *  The tree is built directly from the index vectors:
+             *  the marginal tree is reset and all edges that overlap
+             *  \a position are inserted.  Edges to the right of
+             *  \a position are not visited, and no edge is removed.
+             *  Calling operator()() or prev() afterwards visits
+             *  the neighboring trees.
+             *
+             *  A visitor per thread, each seeking to the start of
+             *  a different genomic window, can process the
+             *  windows in parallel.
+             *
+             *  \throw std::invalid_argument if \a position is not
+             *  in [0, genome length).
+             *
+             *  \version 0.10.0 Added to fwdpp
+             */
+            {
+                if (!(position >= 0.0 && position < maxpos))
+                    {
+                        throw std::invalid_argument("position out of range");
+                    }
+                marginal.reset();
+                j = std::upper_bound(j0, jM, position,
+                                     [this](double pos, table_index_t e) {
+                                         return pos < (beg_edges + e)->left;
+                                     });
+                k = std::upper_bound(k0, kM, position,
+                                     [this](double pos, table_index_t e) {
+                                         return pos < (beg_edges + e)->right;
+                                     });
+                for (auto i = j0; i < j; ++i)
+                    {
+                        if ((beg_edges + *i)->right > position)
+                            {
+                                insert_edge((beg_edges + *i)->parent,
+                                            (beg_edges + *i)->child);
+                            }
+                    }
+                finish_tree();
+                marginal.left = previous_breakpoint(j, k);
+                marginal.right = next_breakpoint();
+                x = marginal.right;
+            }
         };
     } // namespace ts
 } // namespace fwdpp
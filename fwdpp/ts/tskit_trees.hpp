@@ -0,0 +1,755 @@
+#ifndef FWDPP_TS_TSKIT_TREES_HPP
+#define FWDPP_TS_TSKIT_TREES_HPP
+
+#include <array>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <stdexcept>
+#include "definitions.hpp"
+#include "node.hpp"
+#include "edge.hpp"
+#include "site.hpp"
+#include "mutation_record.hpp"
+#include "exceptions.hpp"
+#include "detail/kastore.hpp"
+
+namespace fwdpp
+{
+    namespace ts
+    {
+        namespace io
+        {
+            /// Node flag marking a sample in the tskit format
+            /// \version 0.10.0 Added to library
+            constexpr std::uint32_t TSKIT_NODE_IS_SAMPLE = 1;
+            /// Node flag marking a fwdpp::ts::table_collection::preserved_nodes
+            /// entry in files written by fwdpp::ts::io::write_tskit_trees.
+            /// tskit leaves bits 16 and up of the node flags to client code.
+            /// \version 0.10.0 Added to library
+            constexpr std::uint32_t FWDPP_NODE_IS_PRESERVED = 1u << 16;
+
+            namespace detail
+            {
+                // Version 12.0 is the newest whose required columns are
+                // exactly those written here.  Later 12.x versions add
+                // columns, such as mutations/time and individuals/parents,
+                // that tskit treats as optional when loading older files.
+                constexpr std::uint32_t tskit_file_format_major = 12;
+                constexpr std::uint32_t tskit_file_format_minor = 0;
+                constexpr std::size_t tskit_uuid_size = 36;
+                // Bytes of mutation metadata: the key as
+                // a little-endian uint64, then neutral as a uint8.
+                constexpr std::size_t mutation_metadata_size = 9;
+
+                inline const char*
+                tskit_file_format_name()
+                {
+                    return "tskit.trees";
+                }
+
+                inline std::string
+                make_uuid()
+                /// A random (version 4) UUID
+                {
+                    std::random_device rd;
+                    std::mt19937_64 gen((std::uint64_t(rd()) << 32) ^ rd());
+                    std::array<unsigned char, 16> b;
+                    for (auto& x : b)
+                        {
+                            x = static_cast<unsigned char>(gen() & 0xff);
+                        }
+                    b[6] = static_cast<unsigned char>((b[6] & 0x0f) | 0x40);
+                    b[8] = static_cast<unsigned char>((b[8] & 0x3f) | 0x80);
+                    char buffer[tskit_uuid_size + 1];
+                    std::snprintf(buffer, sizeof(buffer),
+                                  "%02x%02x%02x%02x-%02x%02x-%02x%02x-%02x%02x-%02x%02x%"
+                                  "02x%02x%02x%02x",
+                                  b[0], b[1], b[2], b[3], b[4], b[5], b[6], b[7], b[8],
+                                  b[9], b[10], b[11], b[12], b[13], b[14], b[15]);
+                    return std::string(buffer, tskit_uuid_size);
+                }
+
+                inline std::string
+                state_to_string(std::int8_t state)
+                /// tskit states are strings.  fwdpp states
+                /// are written as decimal integers.
+                {
+                    return std::to_string(static_cast<int>(state));
+                }
+
+                inline std::int8_t
+                string_to_state(const char* begin, const char* end)
+                {
+                    std::string s(begin, end);
+                    char* stop = nullptr;
+                    long x = std::strtol(s.c_str(), &stop, 10);
+                    if (s.empty() || *stop != '\0'
+                        || x < std::numeric_limits<std::int8_t>::min()
+                        || x > std::numeric_limits<std::int8_t>::max())
+                        {
+                            throw std::runtime_error("allelic state \"" + s
+                                                     + "\" is not an integer that "
+                                                       "fits in 8 bits");
+                        }
+                    return static_cast<std::int8_t>(x);
+                }
+
+                template <typename ostreamtype, typename Table, typename F>
+                inline void
+                add_state_columns(ts::detail::kastore_writer<ostreamtype>& writer,
+                                  const std::string& name, const Table& table,
+                                  const F& get_state)
+                /// Add the ragged column of allelic states and its offsets
+                {
+                    std::uint64_t length = 0;
+                    for (std::size_t i = 0; i < table.size(); ++i)
+                        {
+                            length += state_to_string(get_state(table[i])).size();
+                        }
+                    if (length > std::numeric_limits<std::uint32_t>::max())
+                        {
+                            throw tables_error("too many allelic states for the tskit "
+                                               "format");
+                        }
+                    writer.template add<std::uint8_t>(
+                        name, length, [&table, get_state](auto& sink) {
+                            for (std::size_t i = 0; i < table.size(); ++i)
+                                {
+                                    for (char c : state_to_string(get_state(table[i])))
+                                        {
+                                            sink(static_cast<std::uint8_t>(c));
+                                        }
+                                }
+                        });
+                    writer.template add<std::uint32_t>(
+                        name + "_offset", table.size() + 1,
+                        [&table, get_state](auto& sink) {
+                            std::uint32_t offset = 0;
+                            sink(offset);
+                            for (std::size_t i = 0; i < table.size(); ++i)
+                                {
+                                    offset += static_cast<std::uint32_t>(
+                                        state_to_string(get_state(table[i])).size());
+                                    sink(offset);
+                                }
+                        });
+                }
+
+                template <typename ostreamtype>
+                inline void
+                add_empty_ragged_column(ts::detail::kastore_writer<ostreamtype>& writer,
+                                        const std::string& name, std::size_t num_rows)
+                /// Add an empty ragged column, such as metadata
+                {
+                    writer.template add<std::uint8_t>(name, 0, [](auto&) {});
+                    writer.template add<std::uint32_t>(
+                        name + "_offset", num_rows + 1, [num_rows](auto& sink) {
+                            for (std::size_t i = 0; i <= num_rows; ++i)
+                                {
+                                    sink(std::uint32_t{0});
+                                }
+                        });
+                }
+
+                template <typename TableCollectionType>
+                inline std::vector<std::int32_t>
+                mutation_parents(const TableCollectionType& tables)
+                /// The parent of each mutation is the closest mutation above
+                /// it, at the same site, in the tree at the site's position.
+                /// Mutations on the same node are parents of those that come
+                /// after them in the table.  This is the definition used by
+                /// tsk_table_collection_compute_mutation_parents.  The tree
+                /// sequence is only traversed if a site has more than one
+                /// mutation.
+                {
+                    const std::size_t num_mutations = tables.mutations.size();
+                    std::vector<std::int32_t> rv(num_mutations, -1);
+                    std::vector<std::uint32_t> mutations_per_site(tables.sites.size(), 0);
+                    bool recurrent = false;
+                    for (std::size_t i = 0; i < num_mutations; ++i)
+                        {
+                            mutation_record m = tables.mutations[i];
+                            if (m.site >= mutations_per_site.size())
+                                {
+                                    throw tables_error("invalid site id");
+                                }
+                            recurrent |= ++mutations_per_site[m.site] > 1;
+                        }
+                    if (!recurrent)
+                        {
+                            return rv;
+                        }
+                    std::vector<table_index_t> parent(tables.nodes.size(), NULL_INDEX);
+                    std::vector<std::int32_t> bottom_mutation(tables.nodes.size(), -1);
+                    const std::size_t num_edges = tables.edges.size();
+                    const double L = tables.genome_length();
+                    std::size_t in = 0, out = 0, j = 0;
+                    double left = 0.;
+                    while (j < num_mutations && left < L)
+                        {
+                            while (out < num_edges)
+                                {
+                                    edge e = tables.edges[tables.output_right[out]];
+                                    if (e.right != left)
+                                        {
+                                            break;
+                                        }
+                                    parent[e.child] = NULL_INDEX;
+                                    ++out;
+                                }
+                            while (in < num_edges)
+                                {
+                                    edge e = tables.edges[tables.input_left[in]];
+                                    if (e.left != left)
+                                        {
+                                            break;
+                                        }
+                                    parent[e.child] = e.parent;
+                                    ++in;
+                                }
+                            double right = L;
+                            if (in < num_edges)
+                                {
+                                    edge e = tables.edges[tables.input_left[in]];
+                                    right = std::min(right, e.left);
+                                }
+                            if (out < num_edges)
+                                {
+                                    edge e = tables.edges[tables.output_right[out]];
+                                    right = std::min(right, e.right);
+                                }
+                            while (j < num_mutations)
+                                {
+                                    mutation_record m = tables.mutations[j];
+                                    site s = tables.sites[m.site];
+                                    if (s.position >= right)
+                                        {
+                                            break;
+                                        }
+                                    const std::size_t first = j;
+                                    const std::size_t last = j + mutations_per_site[m.site];
+                                    if (last > num_mutations)
+                                        {
+                                            throw tables_error(
+                                                "mutations are not grouped by site");
+                                        }
+                                    for (; j < last; ++j)
+                                        {
+                                            mutation_record mj = tables.mutations[j];
+                                            if (mj.site != m.site)
+                                                {
+                                                    throw tables_error(
+                                                        "mutations are not grouped by "
+                                                        "site");
+                                                }
+                                            auto u = mj.node;
+                                            while (u != NULL_INDEX
+                                                   && bottom_mutation[u] == -1)
+                                                {
+                                                    u = parent[u];
+                                                }
+                                            if (u != NULL_INDEX)
+                                                {
+                                                    rv[j] = bottom_mutation[u];
+                                                }
+                                            bottom_mutation[mj.node]
+                                                = static_cast<std::int32_t>(j);
+                                        }
+                                    for (auto k = first; k < last; ++k)
+                                        {
+                                            mutation_record mk = tables.mutations[k];
+                                            bottom_mutation[mk.node] = -1;
+                                        }
+                                }
+                            left = right;
+                        }
+                    return rv;
+                }
+
+                inline std::vector<std::string>
+                tskit_trees_keys()
+                /// Keys read by fwdpp::ts::io::read_tskit_trees
+                {
+                    return {"format/name",
+                            "format/version",
+                            "sequence_length",
+                            "nodes/flags",
+                            "nodes/time",
+                            "nodes/population",
+                            "edges/left",
+                            "edges/right",
+                            "edges/parent",
+                            "edges/child",
+                            "sites/position",
+                            "sites/ancestral_state",
+                            "sites/ancestral_state_offset",
+                            "mutations/site",
+                            "mutations/node",
+                            "mutations/derived_state",
+                            "mutations/derived_state_offset",
+                            "mutations/metadata",
+                            "mutations/metadata_offset"};
+                }
+            } // namespace detail
+
+            template <typename TableCollectionType, typename ostreamtype>
+            void
+            write_tskit_trees(ostreamtype& o, const TableCollectionType& tables,
+                              const std::vector<table_index_t>& samples,
+                              double forward_time)
+            /*! \brief Write tables in the tskit ".trees" format
+             *
+             *  \param o A model of std::ostream, opened in binary mode
+             *  \param tables A fwdpp::ts::table_collection
+             *  \param samples Node ids to mark as samples
+             *  \param forward_time The current time of the simulation
+             *
+             *  The file is the kastore format used by tskit, file format
+             *  version 12.  It can be loaded by tskit without conversion.
+             *  Columns are written straight from \a tables in one pass
+             *  over the output, without building tskit tables first.
+             *
+             *  tskit measures time backwards, so node times are written
+             *  as \a forward_time minus the fwdpp time.
+             *
+             *  Nodes in \a samples and in tables.preserved_nodes are
+             *  flagged as samples.  Preserved nodes are also flagged with
+             *  fwdpp::ts::io::FWDPP_NODE_IS_PRESERVED.  Node population
+             *  is the deme, and the population table has a row for each
+             *  deme.  Allelic states are written as decimal strings.
+             *  Mutation metadata are the mutation key, as a little-endian
+             *  uint64, followed by one byte for the neutral flag.
+             *  Mutation parents are computed from the trees, which takes a
+             *  pass over the edges if any site has more than one mutation.
+             *  Mutations at a site must be ordered so that parents come
+             *  before their children, as tskit requires.
+             *
+             *  The file format version is 12.0.  Mutation times and
+             *  individual parents, which later 12.x versions of the
+             *  format can store, are not written.  tskit loads mutation
+             *  times as unknown.
+             *
+             *  \throws fwdpp::ts::tables_error if \a tables are not indexed,
+             *  if a value does not fit in the tskit format, or if mutations
+             *  are not grouped by site.
+             *  \throws std::invalid_argument if a sample id is not a node
+             *
+             *  \version 0.10.0 Added to library
+             */
+            {
+                if (!tables.indexed())
+                    {
+                        throw tables_error("tables are not indexed");
+                    }
+                const std::size_t num_nodes = tables.nodes.size();
+                std::vector<std::uint32_t> flags(num_nodes, 0);
+                for (auto s : samples)
+                    {
+                        if (s < 0 || static_cast<std::size_t>(s) >= num_nodes)
+                            {
+                                throw std::invalid_argument("invalid sample id");
+                            }
+                        flags[s] |= TSKIT_NODE_IS_SAMPLE;
+                    }
+                for (auto p : tables.preserved_nodes)
+                    {
+                        flags[p] |= TSKIT_NODE_IS_SAMPLE | FWDPP_NODE_IS_PRESERVED;
+                    }
+                std::int32_t num_populations = 0;
+                for (std::size_t i = 0; i < num_nodes; ++i)
+                    {
+                        node n = tables.nodes[i];
+                        if (n.deme < -1)
+                            {
+                                throw tables_error("invalid deme for the tskit format");
+                            }
+                        num_populations = std::max(num_populations, n.deme + 1);
+                    }
+                for (std::size_t i = 0; i < tables.mutations.size(); ++i)
+                    {
+                        mutation_record m = tables.mutations[i];
+                        if (m.site > static_cast<std::size_t>(
+                                std::numeric_limits<std::int32_t>::max()))
+                            {
+                                throw tables_error("site id does not fit in 32 bits");
+                            }
+                    }
+                if (tables.mutations.size() * detail::mutation_metadata_size
+                    > std::numeric_limits<std::uint32_t>::max())
+                    {
+                        throw tables_error("too many mutations for the tskit format");
+                    }
+
+                ts::detail::kastore_writer<ostreamtype> w;
+                const std::string name(detail::tskit_file_format_name());
+                w.template add<std::int8_t>("format/name",
+                                            std::vector<std::int8_t>(name.begin(),
+                                                                     name.end()));
+                w.template add<std::uint32_t>(
+                    "format/version", std::vector<std::uint32_t>{
+                                          detail::tskit_file_format_major,
+                                          detail::tskit_file_format_minor});
+                w.template add<double>("sequence_length",
+                                       std::vector<double>{tables.genome_length()});
+                const auto uuid = detail::make_uuid();
+                w.template add<std::int8_t>(
+                    "uuid", std::vector<std::int8_t>(uuid.begin(), uuid.end()));
+
+                // Nodes
+                w.template add<std::uint32_t>("nodes/flags", std::move(flags));
+                w.template add<double>("nodes/time", num_nodes,
+                                       [&tables, forward_time](auto& sink) {
+                                           for (std::size_t i = 0;
+                                                i < tables.nodes.size(); ++i)
+                                               {
+                                                   node n = tables.nodes[i];
+                                                   sink(forward_time - n.time);
+                                               }
+                                       });
+                w.template add<std::int32_t>("nodes/population", num_nodes,
+                                             [&tables](auto& sink) {
+                                                 for (std::size_t i = 0;
+                                                      i < tables.nodes.size(); ++i)
+                                                     {
+                                                         node n = tables.nodes[i];
+                                                         sink(std::int32_t{n.deme});
+                                                     }
+                                             });
+                w.template add<std::int32_t>("nodes/individual", num_nodes,
+                                             [num_nodes](auto& sink) {
+                                                 for (std::size_t i = 0; i < num_nodes;
+                                                      ++i)
+                                                     {
+                                                         sink(std::int32_t{-1});
+                                                     }
+                                             });
+                detail::add_empty_ragged_column(w, "nodes/metadata", num_nodes);
+
+                // Edges
+                const std::size_t num_edges = tables.edges.size();
+                w.template add<double>("edges/left", num_edges, [&tables](auto& sink) {
+                    for (std::size_t i = 0; i < tables.edges.size(); ++i)
+                        {
+                            edge e = tables.edges[i];
+                            sink(e.left);
+                        }
+                });
+                w.template add<double>("edges/right", num_edges, [&tables](auto& sink) {
+                    for (std::size_t i = 0; i < tables.edges.size(); ++i)
+                        {
+                            edge e = tables.edges[i];
+                            sink(e.right);
+                        }
+                });
+                w.template add<std::int32_t>(
+                    "edges/parent", num_edges, [&tables](auto& sink) {
+                        for (std::size_t i = 0; i < tables.edges.size(); ++i)
+                            {
+                                edge e = tables.edges[i];
+                                sink(std::int32_t{e.parent});
+                            }
+                    });
+                w.template add<std::int32_t>(
+                    "edges/child", num_edges, [&tables](auto& sink) {
+                        for (std::size_t i = 0; i < tables.edges.size(); ++i)
+                            {
+                                edge e = tables.edges[i];
+                                sink(std::int32_t{e.child});
+                            }
+                    });
+                detail::add_empty_ragged_column(w, "edges/metadata", num_edges);
+                w.template add<std::int32_t>("indexes/edge_insertion_order", num_edges,
+                                             [&tables](auto& sink) {
+                                                 for (auto i : tables.input_left)
+                                                     {
+                                                         sink(std::int32_t{i});
+                                                     }
+                                             });
+                w.template add<std::int32_t>("indexes/edge_removal_order", num_edges,
+                                             [&tables](auto& sink) {
+                                                 for (auto i : tables.output_right)
+                                                     {
+                                                         sink(std::int32_t{i});
+                                                     }
+                                             });
+
+                // Sites
+                const std::size_t num_sites = tables.sites.size();
+                w.template add<double>("sites/position", num_sites,
+                                       [&tables](auto& sink) {
+                                           for (std::size_t i = 0;
+                                                i < tables.sites.size(); ++i)
+                                               {
+                                                   site s = tables.sites[i];
+                                                   sink(s.position);
+                                               }
+                                       });
+                detail::add_state_columns(w, "sites/ancestral_state", tables.sites,
+                                          [](const site& s) { return s.ancestral_state; });
+                detail::add_empty_ragged_column(w, "sites/metadata", num_sites);
+
+                // Mutations
+                const std::size_t num_mutations = tables.mutations.size();
+                w.template add<std::int32_t>(
+                    "mutations/site", num_mutations, [&tables](auto& sink) {
+                        for (std::size_t i = 0; i < tables.mutations.size(); ++i)
+                            {
+                                mutation_record m = tables.mutations[i];
+                                sink(static_cast<std::int32_t>(m.site));
+                            }
+                    });
+                w.template add<std::int32_t>(
+                    "mutations/node", num_mutations, [&tables](auto& sink) {
+                        for (std::size_t i = 0; i < tables.mutations.size(); ++i)
+                            {
+                                mutation_record m = tables.mutations[i];
+                                sink(std::int32_t{m.node});
+                            }
+                    });
+                w.template add<std::int32_t>("mutations/parent",
+                                             detail::mutation_parents(tables));
+                detail::add_state_columns(
+                    w, "mutations/derived_state", tables.mutations,
+                    [](const mutation_record& m) { return m.derived_state; });
+                w.template add<std::uint8_t>(
+                    "mutations/metadata",
+                    num_mutations * detail::mutation_metadata_size,
+                    [&tables](auto& sink) {
+                        for (std::size_t i = 0; i < tables.mutations.size(); ++i)
+                            {
+                                mutation_record m = tables.mutations[i];
+                                char key[8];
+                                ts::detail::encode_little_endian(
+                                    static_cast<std::uint64_t>(m.key), key);
+                                for (auto c : key)
+                                    {
+                                        sink(static_cast<std::uint8_t>(c));
+                                    }
+                                sink(static_cast<std::uint8_t>(m.neutral));
+                            }
+                    });
+                w.template add<std::uint32_t>(
+                    "mutations/metadata_offset", num_mutations + 1,
+                    [num_mutations](auto& sink) {
+                        for (std::size_t i = 0; i <= num_mutations; ++i)
+                            {
+                                sink(static_cast<std::uint32_t>(
+                                    i * detail::mutation_metadata_size));
+                            }
+                    });
+
+                // Tables that fwdpp does not use
+                w.template add<std::uint32_t>("individuals/flags", 0, [](auto&) {});
+                w.template add<double>("individuals/location", 0, [](auto&) {});
+                w.template add<std::uint32_t>("individuals/location_offset", 1,
+                                              [](auto& sink) { sink(std::uint32_t{0}); });
+                detail::add_empty_ragged_column(w, "individuals/metadata", 0);
+                w.template add<double>("migrations/left", 0, [](auto&) {});
+                w.template add<double>("migrations/right", 0, [](auto&) {});
+                w.template add<std::int32_t>("migrations/node", 0, [](auto&) {});
+                w.template add<std::int32_t>("migrations/source", 0, [](auto&) {});
+                w.template add<std::int32_t>("migrations/dest", 0, [](auto&) {});
+                w.template add<double>("migrations/time", 0, [](auto&) {});
+                detail::add_empty_ragged_column(w, "migrations/metadata", 0);
+                detail::add_empty_ragged_column(w, "populations/metadata",
+                                                static_cast<std::size_t>(num_populations));
+                detail::add_empty_ragged_column(w, "provenances/timestamp", 0);
+                detail::add_empty_ragged_column(w, "provenances/record", 0);
+                w.write(o);
+            }
+
+            template <typename TableCollectionType> struct read_tskit_trees
+            {
+                template <typename istreamtype>
+                inline TableCollectionType
+                operator()(istreamtype& i, double forward_time,
+                           std::vector<table_index_t>& samples)
+                /*! \brief Read tables from the tskit ".trees" format
+                 *
+                 *  \param i A model of std::istream, opened in binary mode
+                 *  \param forward_time Time of the simulation when the file was
+                 *  written.  Node times are \a forward_time minus the tskit time.
+                 *  \param samples Filled with the ids of nodes flagged as samples,
+                 *  but not as fwdpp::ts::io::FWDPP_NODE_IS_PRESERVED.
+                 *
+                 *  This reads files written by fwdpp::ts::io::write_tskit_trees
+                 *  and by tskit.  The file is read in one pass, and arrays of
+                 *  tables that fwdpp does not use are skipped.
+                 *
+                 *  Preserved nodes are recorded in increasing order of node id.
+                 *  If the mutation metadata are not in the format written by
+                 *  fwdpp::ts::io::write_tskit_trees, a mutation's key is its row
+                 *  number and it is marked neutral.
+                 *
+                 *  \note fwdpp stores allelic states as 8-bit integers.  Each
+                 *  ancestral and derived state must be a decimal integer in
+                 *  [-128, 127], as written by fwdpp::ts::io::write_tskit_trees.
+                 *  Files with other states, such as nucleotides written by
+                 *  msprime or SLiM, cannot be read.  Mutation parents and times
+                 *  are not read.
+                 *
+                 *  \return A fwdpp::ts::table_collection with its indexes built.
+                 *
+                 *  \throws std::runtime_error if the input is not a valid file,
+                 *  or if an allelic state is not an integer fitting in 8 bits.
+                 *
+                 *  \version 0.10.0 Added to library
+                 */
+                {
+                    using namespace ts::detail;
+                    auto items = read_kastore(i, detail::tskit_trees_keys());
+                    auto name = kastore_get<std::int8_t>(items, "format/name");
+                    if (std::string(name.begin(), name.end())
+                        != detail::tskit_file_format_name())
+                        {
+                            throw std::runtime_error("input is not a tskit trees file");
+                        }
+                    auto version = kastore_get<std::uint32_t>(items, "format/version");
+                    if (version.size() != 2
+                        || version[0] != detail::tskit_file_format_major)
+                        {
+                            throw std::runtime_error(
+                                "unsupported tskit file format version");
+                        }
+                    auto L = kastore_get<double>(items, "sequence_length");
+                    if (L.size() != 1)
+                        {
+                            throw std::runtime_error("invalid sequence_length");
+                        }
+                    TableCollectionType tables(L[0]);
+                    using node_t = typename TableCollectionType::node_t;
+                    using edge_t = typename TableCollectionType::edge_t;
+                    using site_t = typename TableCollectionType::site_t;
+                    using mutation_t = typename TableCollectionType::mutation_t;
+
+                    auto flags = kastore_get<std::uint32_t>(items, "nodes/flags");
+                    auto time = kastore_get<double>(items, "nodes/time");
+                    auto population = kastore_get<std::int32_t>(items, "nodes/population");
+                    if (time.size() != flags.size() || population.size() != flags.size())
+                        {
+                            throw std::runtime_error("node columns differ in length");
+                        }
+                    samples.clear();
+                    tables.nodes.reserve(flags.size());
+                    for (std::size_t j = 0; j < flags.size(); ++j)
+                        {
+                            tables.nodes.push_back(
+                                node_t(node{population[j], forward_time - time[j]}));
+                            const auto id = static_cast<table_index_t>(j);
+                            if (flags[j] & FWDPP_NODE_IS_PRESERVED)
+                                {
+                                    tables.preserved_nodes.push_back(id);
+                                }
+                            else if (flags[j] & TSKIT_NODE_IS_SAMPLE)
+                                {
+                                    samples.push_back(id);
+                                }
+                        }
+
+                    auto left = kastore_get<double>(items, "edges/left");
+                    auto right = kastore_get<double>(items, "edges/right");
+                    auto parent = kastore_get<std::int32_t>(items, "edges/parent");
+                    auto child = kastore_get<std::int32_t>(items, "edges/child");
+                    if (right.size() != left.size() || parent.size() != left.size()
+                        || child.size() != left.size())
+                        {
+                            throw std::runtime_error("edge columns differ in length");
+                        }
+                    tables.edges.reserve(left.size());
+                    for (std::size_t j = 0; j < left.size(); ++j)
+                        {
+                            tables.edges.push_back(
+                                edge_t(edge{left[j], right[j], parent[j], child[j]}));
+                        }
+
+                    auto position = kastore_get<double>(items, "sites/position");
+                    auto ancestral_state
+                        = kastore_get<std::uint8_t>(items, "sites/ancestral_state");
+                    auto ancestral_state_offset
+                        = kastore_get_offsets(items, "sites/ancestral_state_offset");
+                    check_offsets(ancestral_state_offset, position.size(),
+                                  ancestral_state.size());
+                    tables.sites.reserve(position.size());
+                    for (std::size_t j = 0; j < position.size(); ++j)
+                        {
+                            auto b = reinterpret_cast<const char*>(ancestral_state.data());
+                            tables.sites.push_back(site_t(
+                                site{position[j],
+                                     detail::string_to_state(
+                                         b + ancestral_state_offset[j],
+                                         b + ancestral_state_offset[j + 1])}));
+                        }
+
+                    auto msite = kastore_get<std::int32_t>(items, "mutations/site");
+                    auto mnode = kastore_get<std::int32_t>(items, "mutations/node");
+                    auto derived_state
+                        = kastore_get<std::uint8_t>(items, "mutations/derived_state");
+                    auto derived_state_offset
+                        = kastore_get_offsets(items, "mutations/derived_state_offset");
+                    check_offsets(derived_state_offset, msite.size(),
+                                  derived_state.size());
+                    if (mnode.size() != msite.size())
+                        {
+                            throw std::runtime_error("mutation columns differ in length");
+                        }
+                    std::vector<std::uint8_t> metadata;
+                    std::vector<std::uint64_t> metadata_offset;
+                    if (items.count("mutations/metadata"))
+                        {
+                            metadata
+                                = kastore_get<std::uint8_t>(items, "mutations/metadata");
+                            metadata_offset
+                                = kastore_get_offsets(items, "mutations/metadata_offset");
+                            check_offsets(metadata_offset, msite.size(),
+                                          metadata.size());
+                        }
+                    tables.mutations.reserve(msite.size());
+                    for (std::size_t j = 0; j < msite.size(); ++j)
+                        {
+                            auto b = reinterpret_cast<const char*>(derived_state.data());
+                            mutation_record m{
+                                mnode[j], j, static_cast<std::size_t>(msite[j]),
+                                detail::string_to_state(b + derived_state_offset[j],
+                                                        b + derived_state_offset[j + 1]),
+                                true};
+                            if (!metadata_offset.empty()
+                                && metadata_offset[j + 1] - metadata_offset[j]
+                                       == detail::mutation_metadata_size)
+                                {
+                                    auto md = reinterpret_cast<const char*>(
+                                                  metadata.data())
+                                              + metadata_offset[j];
+                                    m.key = static_cast<std::size_t>(
+                                        decode_little_endian<std::uint64_t>(md));
+                                    m.neutral = md[8] != 0;
+                                }
+                            tables.mutations.push_back(mutation_t(m));
+                        }
+                    tables.build_indexes();
+                    return tables;
+                }
+
+              private:
+                static void
+                check_offsets(const std::vector<std::uint64_t>& offsets,
+                              std::size_t num_rows, std::size_t length)
+                {
+                    if (offsets.size() != num_rows + 1 || offsets.front() != 0
+                        || offsets.back() != length
+                        || !std::is_sorted(offsets.begin(), offsets.end()))
+                        {
+                            throw std::runtime_error("invalid offset column");
+                        }
+                }
+            };
+        } // namespace io
+    }     // namespace ts
+} // namespace fwdpp
+
+#endif
@@ -0,0 +1,157 @@
+#ifndef FWDPP_TS_VARIANT_VISITOR_HPP
+#define FWDPP_TS_VARIANT_VISITOR_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+#include "site_visitor.hpp"
+#include "detail/generate_data_matrix_details.hpp"
+
+namespace fwdpp
+{
+    namespace ts
+    {
+        template <typename TableCollectionType> class variant_visitor
+        /*! \brief Iterate over the genotypes of variable sites one at a time
+         *
+         *  Each call to operator() advances to the next site that
+         *  fwdpp::ts::generate_data_matrix would add as a row of its
+         *  return value, and fills genotypes() with the state of each
+         *  sample at that site.  The genotype vector is reused, so memory
+         *  use is proportional to the number of samples, not to the
+         *  number of sites.
+         *
+         *  \code
+         *  fwdpp::ts::variant_visitor<fwdpp::ts::std_table_collection> vv(
+         *      tables, samples, true, true, false);
+         *  while (vv())
+         *  {
+         *      // use vv.position(), vv.key(), vv.genotypes()
+         *  }
+         *  \endcode
+         *
+         *  \version 0.10.0 Added to library
+         */
+        {
+          private:
+            site_visitor<TableCollectionType> sv;
+            typename TableCollectionType::site_table::const_iterator current_site;
+            std::vector<std::int8_t> genotypes_;
+            std::size_t key_;
+            bool neutral_;
+            const bool record_neutral, record_selected, skip_fixed;
+            const double start, stop;
+
+          public:
+            template <typename SAMPLES>
+            variant_visitor(const TableCollectionType& tables, const SAMPLES& samples,
+                            const bool record_neutral_, const bool record_selected_,
+                            const bool skip_fixed_, const double start_,
+                            const double stop_)
+                /// The arguments have the same meaning as for
+                /// fwdpp::ts::generate_data_matrix
+                : sv(tables, samples, start_), current_site(sv.end()),
+                  genotypes_(samples.size()), key_(0), neutral_(true),
+                  record_neutral(record_neutral_), record_selected(record_selected_),
+                  skip_fixed(skip_fixed_), start(start_), stop(stop_)
+            {
+                if (!(stop > start))
+                    {
+                        throw std::invalid_argument("invalid position range");
+                    }
+            }
+
+            template <typename SAMPLES>
+            variant_visitor(const TableCollectionType& tables, const SAMPLES& samples,
+                            const bool record_neutral_, const bool record_selected_,
+                            const bool skip_fixed_)
+                : variant_visitor(tables, samples, record_neutral_, record_selected_,
+                                  skip_fixed_, 0., tables.genome_length())
+            {
+            }
+
+            bool
+            operator()()
+            /// Advance to the next variant.
+            ///
+            /// \return false if there are no more variants
+            {
+                while ((current_site = sv()) != sv.end())
+                    {
+                        if (current_site->position >= stop)
+                            {
+                                current_site = sv.end();
+                                return false;
+                            }
+                        auto muts = sv.get_mutations();
+                        auto rv = detail::fill_site_genotypes(
+                            sv.current_tree(), current_site, muts, record_neutral,
+                            record_selected, skip_fixed, genotypes_);
+                        if (rv.nsamples)
+                            {
+                                key_ = (muts.second - 1)->key;
+                                neutral_ = rv.neutral;
+                                return true;
+                            }
+                    }
+                return false;
+            }
+
+            const std::vector<std::int8_t>&
+            genotypes() const
+            /// The state of each sample at the current site, in the
+            /// order of the samples passed to the constructor.
+            {
+                return genotypes_;
+            }
+
+            double
+            position() const
+            {
+                return current_site->position;
+            }
+
+            std::int8_t
+            ancestral_state() const
+            {
+                return current_site->ancestral_state;
+            }
+
+            std::size_t
+            key() const
+            /// The key of the last mutation at the current site
+            {
+                return key_;
+            }
+
+            bool
+            neutral() const
+            {
+                return neutral_;
+            }
+
+            typename TableCollectionType::site_table::const_iterator
+            site() const
+            {
+                return current_site;
+            }
+
+            std::pair<typename TableCollectionType::mutation_table::const_iterator,
+                      typename TableCollectionType::mutation_table::const_iterator>
+            mutations() const
+            /// The mutations at the current site
+            {
+                return sv.get_mutations();
+            }
+
+            const marginal_tree&
+            current_tree() const
+            {
+                return sv.current_tree();
+            }
+        };
+    } // namespace ts
+} // namespace fwdpp
+
+#endif
@@ -0,0 +1,686 @@
+#ifndef FWDPP_TS_WINDOWED_STATISTICS_HPP
+#define FWDPP_TS_WINDOWED_STATISTICS_HPP
+
+#include <cmath>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include "definitions.hpp"
+#include "node.hpp"
+#include "edge.hpp"
+#include "site.hpp"
+#include "mutation_record.hpp"
+#include "exceptions.hpp"
+#include "marginal_tree.hpp"
+#include <fwdpp/internal/run_in_threads.hpp>
+
+namespace fwdpp
+{
+    namespace ts
+    {
+        enum class statistic_mode : std::int8_t
+        /// How fwdpp::ts::general_statistic summarizes trees
+        /// \version 0.10.0 Added to library
+        {
+            /// Sum over branches, weighted by length and span
+            branch,
+            /// Sum over sites
+            site
+        };
+
+        namespace detail
+        {
+            inline std::vector<double>
+            sample_group_sizes(const std::vector<sample_group_map>& samples)
+            {
+                std::vector<double> n;
+                for (auto& s : samples)
+                    {
+                        if (s.group < 0)
+                            {
+                                throw samples_error("sample groups must be >= 0");
+                            }
+                        if (static_cast<std::size_t>(s.group) >= n.size())
+                            {
+                                n.resize(s.group + 1, 0.);
+                            }
+                        n[s.group] += 1.;
+                    }
+                return n;
+            }
+
+            template <typename TableCollectionType> struct statistic_input
+            /// Copies of the table columns used by the statistics engine,
+            /// shared read-only by all threads.
+            {
+                std::vector<double> left, right, time;
+                std::vector<table_index_t> parent, child;
+                const std::vector<table_index_t>&input_left, &output_right;
+                std::vector<double> site_position;
+                std::vector<std::int8_t> ancestral_state;
+                // Mutations of site i are mutation_node[j] for j in
+                // [site_mutations[i], site_mutations[i + 1])
+                std::vector<std::size_t> site_mutations;
+                std::vector<table_index_t> mutation_node;
+                std::vector<std::int8_t> derived_state;
+                std::vector<std::int32_t> sample_group;
+                std::vector<double> group_sizes;
+                double genome_length;
+
+                statistic_input(const TableCollectionType& tables,
+                                const std::vector<sample_group_map>& samples)
+                    : left{}, right{}, time{}, parent{}, child{},
+                      input_left(tables.input_left), output_right(tables.output_right),
+                      site_position{}, ancestral_state{}, site_mutations{},
+                      mutation_node{}, derived_state{},
+                      sample_group(tables.num_nodes(), -1),
+                      group_sizes(sample_group_sizes(samples)),
+                      genome_length(tables.genome_length())
+                {
+                    if (!tables.indexed())
+                        {
+                            throw std::invalid_argument("tables are not indexed");
+                        }
+                    if (samples.empty())
+                        {
+                            throw samples_error("empty sample list");
+                        }
+                    for (auto& s : samples)
+                        {
+                            if (s.node_id < 0
+                                || static_cast<std::size_t>(s.node_id)
+                                       >= tables.num_nodes())
+                                {
+                                    throw samples_error("invalid sample node");
+                                }
+                            if (sample_group[s.node_id] != -1)
+                                {
+                                    throw samples_error("invalid sample list");
+                                }
+                            sample_group[s.node_id] = s.group;
+                        }
+                    for (std::size_t i = 0; i < tables.edges.size(); ++i)
+                        {
+                            edge e = tables.edges[i];
+                            left.push_back(e.left);
+                            right.push_back(e.right);
+                            parent.push_back(e.parent);
+                            child.push_back(e.child);
+                        }
+                    for (std::size_t i = 0; i < tables.nodes.size(); ++i)
+                        {
+                            node n = tables.nodes[i];
+                            time.push_back(n.time);
+                        }
+                    for (std::size_t i = 0; i < tables.sites.size(); ++i)
+                        {
+                            site s = tables.sites[i];
+                            if (i > 0 && s.position < site_position.back())
+                                {
+                                    throw std::invalid_argument("sites are not sorted");
+                                }
+                            site_position.push_back(s.position);
+                            ancestral_state.push_back(s.ancestral_state);
+                        }
+                    // Group mutations by site, keeping table order
+                    site_mutations.resize(tables.sites.size() + 1, 0);
+                    for (std::size_t i = 0; i < tables.mutations.size(); ++i)
+                        {
+                            mutation_record m = tables.mutations[i];
+                            if (m.site >= tables.sites.size())
+                                {
+                                    throw std::invalid_argument(
+                                        "mutation refers to an invalid site");
+                                }
+                            ++site_mutations[m.site + 1];
+                        }
+                    for (std::size_t i = 1; i < site_mutations.size(); ++i)
+                        {
+                            site_mutations[i] += site_mutations[i - 1];
+                        }
+                    mutation_node.resize(tables.mutations.size());
+                    derived_state.resize(tables.mutations.size());
+                    auto next = site_mutations;
+                    for (std::size_t i = 0; i < tables.mutations.size(); ++i)
+                        {
+                            mutation_record m = tables.mutations[i];
+                            mutation_node[next[m.site]] = m.node;
+                            derived_state[next[m.site]] = m.derived_state;
+                            ++next[m.site];
+                        }
+                }
+
+                std::size_t
+                num_groups() const
+                {
+                    return group_sizes.size();
+                }
+            };
+
+            template <typename TableCollectionType, typename F> class statistic_worker
+            /// Computes a statistic for a contiguous range of windows.
+            ///
+            /// The state is the tree at the current position, stored as
+            /// a parent array, plus the number of samples from each group
+            /// below each node.  In branch mode, the summary function of
+            /// each node and the sum of the branch summaries of the tree
+            /// are also kept.  All are updated only along the path from
+            /// an inserted or removed edge to the root.
+            {
+              private:
+                const statistic_input<TableCollectionType>& input;
+                const F& f;
+                const std::size_t G, K;
+                const statistic_mode mode;
+                const bool polarised;
+                std::vector<table_index_t> parents;
+                std::vector<double> counts, summaries, running, scratch;
+                // Site mode
+                std::vector<double> values, alleles, state_counts;
+                std::vector<std::int8_t> states;
+
+                double
+                branch_length(table_index_t u) const
+                {
+                    return input.time[u] - input.time[parents[u]];
+                }
+
+                void
+                summarize(const double* x, double* out)
+                /// f, plus f of the complement if unpolarised
+                {
+                    f(x, out);
+                    if (!polarised)
+                        {
+                            for (std::size_t g = 0; g < G; ++g)
+                                {
+                                    scratch[g] = input.group_sizes[g] - x[g];
+                                }
+                            f(scratch.data(), scratch.data() + G);
+                            for (std::size_t k = 0; k < K; ++k)
+                                {
+                                    out[k] += scratch[G + k];
+                                }
+                        }
+                }
+
+                void
+                add_branch(table_index_t u, double sign)
+                {
+                    const double bl = sign * branch_length(u);
+                    const double* s = summaries.data() + u * K;
+                    for (std::size_t k = 0; k < K; ++k)
+                        {
+                            running[k] += bl * s[k];
+                        }
+                }
+
+                void
+                propagate(table_index_t c, table_index_t p, double sign)
+                /// Add sign * counts of c to p and its ancestors
+                {
+                    const double* xc = counts.data() + c * G;
+                    for (auto u = p; u != NULL_INDEX; u = parents[u])
+                        {
+                            const bool has_parent = parents[u] != NULL_INDEX;
+                            if (mode == statistic_mode::branch && has_parent)
+                                {
+                                    add_branch(u, -1.);
+                                }
+                            double* xu = counts.data() + u * G;
+                            for (std::size_t g = 0; g < G; ++g)
+                                {
+                                    xu[g] += sign * xc[g];
+                                }
+                            if (mode == statistic_mode::branch)
+                                {
+                                    summarize(xu, summaries.data() + u * K);
+                                    if (has_parent)
+                                        {
+                                            add_branch(u, 1.);
+                                        }
+                                }
+                        }
+                }
+
+                void
+                insert_edge(std::size_t e)
+                {
+                    const auto p = input.parent[e], c = input.child[e];
+                    parents[c] = p;
+                    if (mode == statistic_mode::branch)
+                        {
+                            add_branch(c, 1.);
+                        }
+                    propagate(c, p, 1.);
+                }
+
+                void
+                remove_edge(std::size_t e)
+                {
+                    const auto p = input.parent[e], c = input.child[e];
+                    if (mode == statistic_mode::branch)
+                        {
+                            add_branch(c, -1.);
+                        }
+                    parents[c] = NULL_INDEX;
+                    propagate(c, p, -1.);
+                }
+
+                void
+                site_summary(std::size_t s)
+                /// Sum f over the allele counts of site s into values.
+                /// A mutation is masked by later mutations at the same
+                /// site on the path from it to the samples.
+                {
+                    const auto first = input.site_mutations[s],
+                               last = input.site_mutations[s + 1];
+                    std::fill(values.begin(), values.end(), 0.);
+                    if (first == last)
+                        {
+                            return;
+                        }
+                    // Samples carrying each allele.  The ancestral allele
+                    // is first, followed by one entry per mutation.
+                    alleles.assign((last - first + 1) * G, 0.);
+                    std::copy(input.group_sizes.begin(), input.group_sizes.end(),
+                              alleles.begin());
+                    for (auto m = first; m < last; ++m)
+                        {
+                            const auto node = input.mutation_node[m];
+                            const double* x = counts.data() + node * G;
+                            std::copy(x, x + G, alleles.begin() + (m - first + 1) * G);
+                            // The allele that this mutation replaces is that of
+                            // the latest earlier mutation at or above node.
+                            std::size_t replaced = 0;
+                            for (auto u = node; u != NULL_INDEX && replaced == 0;
+                                 u = parents[u])
+                                {
+                                    for (auto n = m; n > first; --n)
+                                        {
+                                            if (input.mutation_node[n - 1] == u)
+                                                {
+                                                    replaced = n - first;
+                                                    break;
+                                                }
+                                        }
+                                }
+                            for (std::size_t g = 0; g < G; ++g)
+                                {
+                                    alleles[replaced * G + g] -= x[g];
+                                }
+                        }
+                    // Merge alleles by state, so that each
+                    // state is summarized once.
+                    states.assign(1, input.ancestral_state[s]);
+                    state_counts.assign(alleles.begin(), alleles.begin() + G);
+                    for (auto m = first; m < last; ++m)
+                        {
+                            const auto i = static_cast<std::size_t>(
+                                std::find(states.begin(), states.end(),
+                                          input.derived_state[m])
+                                - states.begin());
+                            if (i == states.size())
+                                {
+                                    states.push_back(input.derived_state[m]);
+                                    state_counts.resize(state_counts.size() + G, 0.);
+                                }
+                            for (std::size_t g = 0; g < G; ++g)
+                                {
+                                    state_counts[i * G + g]
+                                        += alleles[(m - first + 1) * G + g];
+                                }
+                        }
+                    for (std::size_t i = polarised ? 1 : 0; i < states.size(); ++i)
+                        {
+                            f(state_counts.data() + i * G, scratch.data() + G);
+                            for (std::size_t k = 0; k < K; ++k)
+                                {
+                                    values[k] += scratch[G + k];
+                                }
+                        }
+                }
+
+              public:
+                statistic_worker(const statistic_input<TableCollectionType>& i,
+                                 const F& fn, std::size_t output_dim,
+                                 statistic_mode m, bool p)
+                    : input(i), f(fn), G(i.num_groups()), K(output_dim), mode(m),
+                      polarised(p), parents(i.time.size(), NULL_INDEX),
+                      counts(i.time.size() * G, 0.),
+                      summaries(m == statistic_mode::branch ? i.time.size() * K : 0,
+                                0.),
+                      running(K, 0.), scratch(G + K, 0.), values(K, 0.), alleles{},
+                      state_counts{}, states{}
+                {
+                    for (std::size_t u = 0; u < input.sample_group.size(); ++u)
+                        {
+                            if (input.sample_group[u] >= 0)
+                                {
+                                    counts[u * G + input.sample_group[u]] = 1.;
+                                }
+                        }
+                    if (mode == statistic_mode::branch)
+                        {
+                            for (std::size_t u = 0; u < input.time.size(); ++u)
+                                {
+                                    summarize(counts.data() + u * G,
+                                              summaries.data() + u * K);
+                                }
+                        }
+                }
+
+                void
+                run(const std::vector<double>& windows, std::size_t first_window,
+                    std::size_t last_window, std::vector<std::vector<double>>& result)
+                /// Fill result[first_window, last_window)
+                {
+                    const double start = windows[first_window];
+                    const double stop = windows[last_window];
+                    const auto& L = input.left;
+                    const auto& R = input.right;
+                    // Build the tree at start, as tree_visitor::seek does
+                    auto j = std::upper_bound(
+                        input.input_left.begin(), input.input_left.end(), start,
+                        [&L](double pos, table_index_t e) { return pos < L[e]; });
+                    auto k = std::upper_bound(
+                        input.output_right.begin(), input.output_right.end(), start,
+                        [&R](double pos, table_index_t e) { return pos < R[e]; });
+                    for (auto i = input.input_left.begin(); i < j; ++i)
+                        {
+                            if (R[*i] > start)
+                                {
+                                    insert_edge(*i);
+                                }
+                        }
+                    auto s = static_cast<std::size_t>(
+                        std::lower_bound(input.site_position.begin(),
+                                         input.site_position.end(), start)
+                        - input.site_position.begin());
+                    auto w = first_window;
+                    double x = start;
+                    while (x < stop)
+                        {
+                            double tree_right = input.genome_length;
+                            if (j < input.input_left.end())
+                                {
+                                    tree_right = std::min(tree_right, L[*j]);
+                                }
+                            if (k < input.output_right.end())
+                                {
+                                    tree_right = std::min(tree_right, R[*k]);
+                                }
+                            tree_right = std::min(tree_right, stop);
+                            if (mode == statistic_mode::branch)
+                                {
+                                    // The tree may span several windows
+                                    double a = x;
+                                    while (a < tree_right)
+                                        {
+                                            const double b
+                                                = std::min(tree_right, windows[w + 1]);
+                                            for (std::size_t i = 0; i < K; ++i)
+                                                {
+                                                    result[w][i] += running[i] * (b - a);
+                                                }
+                                            a = b;
+                                            if (a == windows[w + 1])
+                                                {
+                                                    ++w;
+                                                }
+                                        }
+                                }
+                            else
+                                {
+                                    for (; s < input.site_position.size()
+                                           && input.site_position[s] < tree_right;
+                                         ++s)
+                                        {
+                                            while (input.site_position[s]
+                                                   >= windows[w + 1])
+                                                {
+                                                    ++w;
+                                                }
+                                            site_summary(s);
+                                            for (std::size_t i = 0; i < K; ++i)
+                                                {
+                                                    result[w][i] += values[i];
+                                                }
+                                        }
+                                }
+                            x = tree_right;
+                            while (k < input.output_right.end() && R[*k] == x)
+                                {
+                                    remove_edge(*k);
+                                    ++k;
+                                }
+                            while (j < input.input_left.end() && L[*j] == x)
+                                {
+                                    insert_edge(*j);
+                                    ++j;
+                                }
+                        }
+                }
+            };
+        } // namespace detail
+
+        template <typename TableCollectionType, typename F>
+        std::vector<std::vector<double>>
+        general_statistic(const TableCollectionType& tables,
+                          const std::vector<sample_group_map>& samples,
+                          std::size_t output_dim, const F& f,
+                          const std::vector<double>& windows, statistic_mode mode,
+                          bool polarised, bool span_normalise, unsigned num_threads)
+        /*! \brief Compute a statistic of sample counts in genomic windows
+         *
+         *  This is the general statistics framework of tskit.  Sample
+         *  nodes are assigned to groups 0, 1, ..., G - 1 by \a samples.
+         *  A summary function maps the number of samples from each group
+         *  carrying an allele, x, to a vector of \a output_dim values.
+         *
+         *  In branch mode, each tree contributes, for each branch above a
+         *  node u, the branch length times the span of the tree in the
+         *  window times f(x), where x counts the samples below u.
+         *  In site mode, each site contributes f(x) for each allele.
+         *  If \a polarised is false, branch mode adds f(n - x), where n
+         *  is the number of samples in each group, and site mode includes
+         *  the ancestral allele.
+         *
+         *  The trees are not rebuilt from scratch.  Sample counts, and
+         *  in branch mode the per-node summaries, are updated only for
+         *  the ancestors of edges that are inserted or removed, as
+         *  fwdpp::ts::tree_visitor advances.
+         *
+         *  \param tables An indexed table collection.  The site table must
+         *  be sorted by position.
+         *  \param samples Sample nodes and their groups.  Groups must be >= 0.
+         *  \param output_dim Length of the output of \a f
+         *  \param f Summary function with signature
+         *  void(const double * x, double * output), where x has one
+         *  element per group.
+         *  \param windows Window breakpoints: 0, ..., genome length,
+         *  strictly increasing.
+         *  \param mode branch or site
+         *  \param polarised See above
+         *  \param span_normalise If true, divide each value by the window length.
+         *  \param num_threads Windows are divided among this many threads.
+         *  Each thread builds the tree at the start of its first window directly,
+         *  as fwdpp::ts::tree_visitor::seek does.  \a f must be safe to call
+         *  from several threads.
+         *
+         *  \return One vector of \a output_dim values per window
+         *
+         *  \version 0.10.0 Added to library
+         */
+        {
+            if (windows.size() < 2 || windows.front() != 0.
+                || windows.back() != tables.genome_length())
+                {
+                    throw std::invalid_argument(
+                        "windows must start at 0 and end at the genome length");
+                }
+            for (std::size_t i = 1; i < windows.size(); ++i)
+                {
+                    if (!(windows[i] > windows[i - 1]))
+                        {
+                            throw std::invalid_argument(
+                                "windows must be strictly increasing");
+                        }
+                }
+            if (output_dim == 0)
+                {
+                    throw std::invalid_argument("output_dim must be > 0");
+                }
+            const std::size_t num_windows = windows.size() - 1;
+            num_threads = static_cast<unsigned>(std::max<std::size_t>(
+                1, std::min<std::size_t>(num_threads, num_windows)));
+            detail::statistic_input<TableCollectionType> input(tables, samples);
+            std::vector<std::vector<double>> result(num_windows,
+                                                    std::vector<double>(output_dim, 0.));
+            fwdpp_internal::run_in_threads(num_threads, [&](unsigned t) {
+                const auto first = num_windows * t / num_threads;
+                const auto last = num_windows * (t + 1) / num_threads;
+                detail::statistic_worker<TableCollectionType, F> worker(
+                    input, f, output_dim, mode, polarised);
+                worker.run(windows, first, last, result);
+            });
+            if (span_normalise)
+                {
+                    for (std::size_t w = 0; w < num_windows; ++w)
+                        {
+                            for (auto& v : result[w])
+                                {
+                                    v /= windows[w + 1] - windows[w];
+                                }
+                        }
+                }
+            return result;
+        }
+
+        template <typename TableCollectionType>
+        std::vector<std::vector<double>>
+        diversity(const TableCollectionType& tables,
+                  const std::vector<sample_group_map>& samples,
+                  const std::vector<double>& windows, statistic_mode mode,
+                  unsigned num_threads = 1)
+        /*! \brief Mean pairwise diversity within each sample group
+         *
+         *  Element g of each window's output is the mean number of
+         *  differences (site mode) or the mean branch length separating
+         *  (branch mode) two distinct samples from group g, per unit of
+         *  genome length.  Groups with fewer than two samples get 0.
+         *
+         *  See fwdpp::ts::general_statistic for the parameters.
+         *
+         *  \version 0.10.0 Added to library
+         */
+        {
+            const auto n = detail::sample_group_sizes(samples);
+            const auto G = n.size();
+            auto f = [n, G](const double* x, double* out) {
+                for (std::size_t g = 0; g < G; ++g)
+                    {
+                        out[g] = n[g] > 1. ? x[g] * (n[g] - x[g]) / (n[g] * (n[g] - 1.))
+                                           : 0.;
+                    }
+            };
+            return general_statistic(tables, samples, G, f, windows, mode, false, true,
+                                     num_threads);
+        }
+
+        template <typename TableCollectionType>
+        std::vector<std::vector<double>>
+        divergence(const TableCollectionType& tables,
+                   const std::vector<sample_group_map>& samples,
+                   const std::vector<double>& windows, statistic_mode mode,
+                   unsigned num_threads = 1)
+        /*! \brief Mean pairwise divergence between sample groups
+         *
+         *  The output for each window has one element for each pair
+         *  of groups a < b, in the order (0, 1), (0, 2), ..., (1, 2), ...
+         *  Each is the mean number of differences (site mode) or
+         *  the mean branch length separating (branch mode) a sample
+         *  from group a and a sample from group b, per unit of genome
+         *  length.
+         *
+         *  See fwdpp::ts::general_statistic for the parameters.
+         *
+         *  \version 0.10.0 Added to library
+         */
+        {
+            const auto n = detail::sample_group_sizes(samples);
+            const auto G = n.size();
+            if (G < 2)
+                {
+                    throw std::invalid_argument("divergence requires two or more groups");
+                }
+            auto f = [n, G](const double* x, double* out) {
+                std::size_t k = 0;
+                for (std::size_t a = 0; a < G; ++a)
+                    {
+                        for (std::size_t b = a + 1; b < G; ++b)
+                            {
+                                out[k++] = n[a] > 0. && n[b] > 0.
+                                               ? x[a] * (n[b] - x[b]) / (n[a] * n[b])
+                                               : 0.;
+                            }
+                    }
+            };
+            return general_statistic(tables, samples, G * (G - 1) / 2, f, windows, mode,
+                                     false, true, num_threads);
+        }
+
+        template <typename TableCollectionType>
+        std::vector<std::vector<double>>
+        site_frequency_spectrum(const TableCollectionType& tables,
+                                const std::vector<sample_group_map>& samples,
+                                std::int32_t group, const std::vector<double>& windows,
+                                statistic_mode mode, bool polarised,
+                                unsigned num_threads = 1)
+        /*! \brief Site frequency spectrum of one sample group
+         *
+         *  If \a polarised is true, element i of each window's output is
+         *  the number of derived alleles (site mode), or the total length
+         *  of branches (branch mode), carried by i samples from \a group,
+         *  for i = 0, ..., n.  Otherwise, the spectrum is folded: element i
+         *  is for i or n - i samples, for i = 0, ..., n / 2, and a
+         *  biallelic site adds 1 to the class of its minor allele.
+         *
+         *  Values are not divided by the window length.
+         *
+         *  See fwdpp::ts::general_statistic for the other parameters.
+         *
+         *  \version 0.10.0 Added to library
+         */
+        {
+            const auto sizes = detail::sample_group_sizes(samples);
+            if (group < 0 || static_cast<std::size_t>(group) >= sizes.size())
+                {
+                    throw std::invalid_argument("invalid sample group");
+                }
+            const auto n = static_cast<std::size_t>(sizes[group]);
+            const std::size_t K = polarised ? n + 1 : n / 2 + 1;
+            // Unpolarised statistics summarize each allele and its
+            // complement, which fold to the same class.
+            auto f = [group, n, K, polarised](const double* x, double* out) {
+                std::fill(out, out + K, 0.);
+                auto i = static_cast<std::size_t>(std::lround(x[group]));
+                if (polarised)
+                    {
+                        out[i] = 1.;
+                    }
+                else
+                    {
+                        out[std::min(i, n - i)] = 0.5;
+                    }
+            };
+            return general_statistic(tables, samples, K, f, windows, mode, polarised,
+                                     false, num_threads);
+        }
+    } // namespace ts
+} // namespace fwdpp
+
+#endif
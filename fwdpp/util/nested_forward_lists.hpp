@@ -173,6 +173,27 @@ namespace fwdpp
             return data[static_cast<std::size_t>(at)];
         }
 
+        std::size_t
+        size() const
+        /// Number of records stored, including those of lists
+        /// removed by nullify_list.
+        ///
+        /// \version 0.10.0 Added to library
+        {
+            return data.size();
+        }
+
+        std::size_t
+        memory_usage() const
+        /// Bytes allocated for records and indexes
+        ///
+        /// \version 0.10.0 Added to library
+        {
+            return data.capacity() * sizeof(T)
+                   + (_head.capacity() + _tail.capacity() + _next.capacity())
+                         * sizeof(Index);
+        }
+
         void
         nullify_list(Index at)
         // In future, we can recycle indexes in the
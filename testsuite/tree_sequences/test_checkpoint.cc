@@ -0,0 +1,173 @@
+#include <sstream>
+#include <stdexcept>
+#include <boost/test/unit_test.hpp>
+#include <fwdpp/ts/std_table_collection.hpp>
+#include <fwdpp/ts/columnar_table_collection.hpp>
+#include <fwdpp/ts/table_collection_functions.hpp>
+#include <fwdpp/ts/checkpoint.hpp>
+
+namespace
+{
+    struct checkpoint_fixture
+    {
+        fwdpp::ts::std_table_collection tables;
+        std::ostringstream out;
+        fwdpp::ts::io::checkpoint_writer writer;
+        std::vector<fwdpp::ts::std_table_collection> expected;
+
+        checkpoint_fixture() : tables(100.), out{}, writer{}, expected{}
+        {
+        }
+
+        void
+        add_generation(double time, std::size_t n)
+        {
+            const auto first_parent
+                = static_cast<fwdpp::ts::table_index_t>(tables.nodes.size() - n);
+            const auto num_parents = static_cast<fwdpp::ts::table_index_t>(n);
+            for (fwdpp::ts::table_index_t i = 0; i < num_parents; ++i)
+                {
+                    auto child = tables.push_back_node(time, 0);
+                    tables.push_back_edge(0., 50., first_parent + i, child);
+                    tables.push_back_edge(50., 100., first_parent + (i + 1) % num_parents,
+                                          child);
+                }
+        }
+
+        std::size_t
+        checkpoint()
+        /// Returns the number of bytes written
+        {
+            const auto before = out.str().size();
+            writer.write(out, tables);
+            auto copy(tables);
+            copy.build_indexes();
+            expected.push_back(copy);
+            return out.str().size() - before;
+        }
+    };
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(test_incremental_checkpoints, checkpoint_fixture)
+
+BOOST_AUTO_TEST_CASE(test_appended_rows)
+{
+    for (std::size_t i = 0; i < 100; ++i)
+        {
+            tables.push_back_node(0., 0);
+        }
+    checkpoint();
+    std::vector<std::size_t> checkpoint_sizes;
+    for (int generation = 1; generation < 30; ++generation)
+        {
+            add_generation(static_cast<double>(generation), 100);
+            tables.emplace_back_site(static_cast<double>(generation),
+                                     fwdpp::ts::default_ancestral_state);
+            tables.emplace_back_mutation(
+                static_cast<fwdpp::ts::table_index_t>(tables.nodes.size() - 1),
+                static_cast<std::size_t>(generation), tables.sites.size() - 1,
+                fwdpp::ts::default_derived_state, true);
+            checkpoint_sizes.push_back(checkpoint());
+        }
+    // Each checkpoint writes one generation of rows, not the
+    // whole, growing, table collection.
+    BOOST_REQUIRE(checkpoint_sizes.back() < 2 * checkpoint_sizes.front());
+    std::ostringstream full;
+    fwdpp::ts::io::serialize_tables(full, tables);
+    BOOST_REQUIRE(checkpoint_sizes.back() < full.str().size() / 10);
+
+    std::istringstream in(out.str());
+    fwdpp::ts::io::checkpoint_reader<fwdpp::ts::std_table_collection> reader;
+    std::size_t i = 0;
+    while (reader.next(in))
+        {
+            BOOST_REQUIRE(reader.tables() == expected[i]);
+            ++i;
+        }
+    BOOST_REQUIRE_EQUAL(i, expected.size());
+    BOOST_REQUIRE_EQUAL(reader.checkpoints_read(), expected.size());
+}
+
+BOOST_AUTO_TEST_CASE(test_rewritten_rows)
+{
+    for (std::size_t i = 0; i < 2000; ++i)
+        {
+            tables.push_back_node(0., 0);
+        }
+    for (int generation = 1; generation < 3; ++generation)
+        {
+            add_generation(static_cast<double>(generation), 2000);
+            checkpoint();
+        }
+    // Change one row, then remove rows, as simplification would
+    tables.nodes[1500].time = -1.;
+    writer.mark_changed(fwdpp::ts::io::checkpoint_table::nodes, 1500);
+    tables.edges.resize(tables.edges.size() / 2);
+    tables.preserved_nodes.push_back(3);
+    tables.edge_offset = 17;
+    const auto rewritten_size = checkpoint();
+    // Unchanged tables
+    checkpoint();
+    // The shrunk edge table was rewritten in full, but the
+    // nodes only from the changed row onwards.
+    tables.sites.clear();
+    tables.mutations.clear();
+    writer.mark_all_changed();
+    const auto full_size = checkpoint();
+    BOOST_REQUIRE(full_size > rewritten_size);
+    add_generation(3., 2000);
+    checkpoint();
+
+    for (std::size_t k = 0; k < expected.size(); ++k)
+        {
+            std::istringstream in(out.str());
+            auto t = fwdpp::ts::io::read_checkpoint<fwdpp::ts::std_table_collection>(
+                in, k);
+            BOOST_REQUIRE(t == expected[k]);
+            BOOST_REQUIRE_EQUAL(t.edge_offset, expected[k].edge_offset);
+        }
+    std::istringstream in(out.str());
+    BOOST_REQUIRE_THROW(fwdpp::ts::io::read_checkpoint<fwdpp::ts::std_table_collection>(
+                            in, expected.size()),
+                        std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(test_columnar_reader)
+{
+    for (std::size_t i = 0; i < 10; ++i)
+        {
+            tables.push_back_node(0., 0);
+        }
+    add_generation(1., 10);
+    checkpoint();
+    add_generation(2., 10);
+    checkpoint();
+    std::istringstream in(out.str());
+    auto t = fwdpp::ts::io::read_checkpoint<fwdpp::ts::columnar_table_collection>(in,
+                                                                                  1);
+    BOOST_REQUIRE_EQUAL(t.edges.size(), tables.edges.size());
+    for (std::size_t i = 0; i < t.edges.size(); ++i)
+        {
+            fwdpp::ts::edge e = t.edges[i];
+            BOOST_REQUIRE(e == tables.edges[i]);
+        }
+}
+
+BOOST_AUTO_TEST_CASE(test_invalid_input)
+{
+    tables.push_back_node(0., 0);
+    checkpoint();
+    {
+        std::istringstream in("fwdppts");
+        fwdpp::ts::io::checkpoint_reader<fwdpp::ts::std_table_collection> reader;
+        BOOST_REQUIRE_THROW(reader.next(in), std::runtime_error);
+    }
+    {
+        auto buffer = out.str();
+        std::istringstream in(buffer.substr(0, buffer.size() - 4));
+        fwdpp::ts::io::checkpoint_reader<fwdpp::ts::std_table_collection> reader;
+        BOOST_REQUIRE_THROW(reader.next(in), std::runtime_error);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
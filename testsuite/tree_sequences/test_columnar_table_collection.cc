@@ -0,0 +1,195 @@
+#include <sstream>
+#include <algorithm>
+#include <boost/test/unit_test.hpp>
+#include <fwdpp/ts/std_table_collection.hpp>
+#include <fwdpp/ts/columnar_table_collection.hpp>
+#include <fwdpp/ts/table_collection_functions.hpp>
+#include <fwdpp/ts/tree_visitor.hpp>
+#include <fwdpp/ts/serialization.hpp>
+#include "wfevolve_table_collection.hpp"
+
+namespace
+{
+    template <typename TableCollectionType>
+    TableCollectionType
+    make_simple_tables()
+    // Same topology as simple_table_collection
+    {
+        TableCollectionType t(1.);
+        t.push_back_node(3, 0);
+        t.push_back_node(3, 0);
+        t.push_back_node(3, 0);
+        t.push_back_node(3, 0);
+        t.push_back_node(2, 0);
+        t.push_back_node(1, 0);
+        t.push_back_node(0, 0);
+        t.push_back_edge(0, 1, 6, 5);
+        t.push_back_edge(0, 1, 6, 4);
+        t.push_back_edge(0, 1, 5, 2);
+        t.push_back_edge(0, 1, 5, 3);
+        t.push_back_edge(0, 1, 4, 1);
+        t.push_back_edge(0, 1, 4, 0);
+        fwdpp::ts::sort_edge_table(t);
+        t.build_indexes();
+        return t;
+    }
+
+    template <typename A, typename B>
+    bool
+    same_rows(const A& a, const B& b)
+    {
+        if (a.size() != b.size())
+            {
+                return false;
+            }
+        for (std::size_t i = 0; i < a.size(); ++i)
+            {
+                typename A::value_type x = a[i];
+                typename B::value_type y = b[i];
+                if (!(x == y))
+                    {
+                        return false;
+                    }
+            }
+        return true;
+    }
+
+    template <typename A, typename B>
+    bool
+    same_tables(const A& a, const B& b)
+    {
+        return a.genome_length() == b.genome_length() && same_rows(a.nodes, b.nodes)
+               && same_rows(a.edges, b.edges) && same_rows(a.sites, b.sites)
+               && same_rows(a.mutations, b.mutations)
+               && a.preserved_nodes == b.preserved_nodes;
+    }
+
+    struct wf_columnar_fixture
+    {
+        fwdpp::ts::std_table_collection std_tables;
+        fwdpp::ts::columnar_table_collection columnar_tables;
+        wf_columnar_fixture() : std_tables(1.), columnar_tables(1.)
+        {
+        }
+
+        void
+        evolve(bool buffer_new_edges, bool simplify_from_buffer)
+        {
+            wfevolve_table_collection(42, 100, 500, 0., 10., 50, buffer_new_edges,
+                                      simplify_from_buffer, false, empty_policies{},
+                                      std_tables);
+            wfevolve_table_collection(42, 100, 500, 0., 10., 50, buffer_new_edges,
+                                      simplify_from_buffer, false, empty_policies{},
+                                      columnar_tables);
+        }
+    };
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(test_column_table)
+
+BOOST_AUTO_TEST_CASE(test_row_access)
+{
+    fwdpp::ts::edge_column_table edges;
+    edges.push_back(fwdpp::ts::edge{0., 1., 2, 3});
+    edges.emplace_back(0.5, 1., 4, 5);
+    BOOST_REQUIRE_EQUAL(edges.size(), 2);
+    BOOST_REQUIRE_EQUAL(edges[1].left, 0.5);
+    BOOST_REQUIRE_EQUAL(edges[1].parent, 4);
+    edges[0].right = 0.25;
+    BOOST_REQUIRE_EQUAL(
+        edges.column<fwdpp::ts::edge_column_traits::right>()[0], 0.25);
+    BOOST_REQUIRE_EQUAL(edges.begin()->child, 3);
+    BOOST_REQUIRE_EQUAL(edges.rbegin()->child, 5);
+    fwdpp::ts::edge e = edges.back();
+    BOOST_REQUIRE(e == (fwdpp::ts::edge{0.5, 1., 4, 5}));
+    edges.erase(edges.begin());
+    BOOST_REQUIRE_EQUAL(edges.size(), 1);
+    BOOST_REQUIRE_EQUAL(edges[0].child, 5);
+}
+
+BOOST_AUTO_TEST_CASE(test_sort_matches_std_vector)
+{
+    std::vector<fwdpp::ts::edge> v;
+    fwdpp::ts::edge_column_table c;
+    for (int i = 0; i < 1000; ++i)
+        {
+            fwdpp::ts::edge e{static_cast<double>((i * 7919) % 101), 200.,
+                              (i * 31) % 17, (i * 13) % 29};
+            v.push_back(e);
+            c.push_back(e);
+        }
+    auto cmp = [](const auto& a, const auto& b) {
+        return std::tie(a.parent, a.child, a.left) < std::tie(b.parent, b.child, b.left);
+    };
+    std::sort(v.begin(), v.end(), cmp);
+    std::sort(c.begin(), c.end(), cmp);
+    BOOST_REQUIRE(same_rows(v, c));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(test_columnar_table_collection)
+
+BOOST_AUTO_TEST_CASE(test_tree_traversal)
+{
+    auto std_tables = make_simple_tables<fwdpp::ts::std_table_collection>();
+    auto columnar_tables = make_simple_tables<fwdpp::ts::columnar_table_collection>();
+    BOOST_REQUIRE(same_tables(std_tables, columnar_tables));
+    BOOST_REQUIRE(std_tables.input_left == columnar_tables.input_left);
+    BOOST_REQUIRE(std_tables.output_right == columnar_tables.output_right);
+
+    std::vector<fwdpp::ts::table_index_t> samples{0, 1, 2, 3};
+    fwdpp::ts::tree_visitor<fwdpp::ts::std_table_collection> tv_std(
+        std_tables, samples, fwdpp::ts::update_samples_list(true));
+    fwdpp::ts::tree_visitor<fwdpp::ts::columnar_table_collection> tv_columnar(
+        columnar_tables, samples, fwdpp::ts::update_samples_list(true));
+    while (tv_std())
+        {
+            BOOST_REQUIRE(tv_columnar());
+            BOOST_REQUIRE(tv_std.tree().parents == tv_columnar.tree().parents);
+            BOOST_REQUIRE(tv_std.tree().leaf_counts == tv_columnar.tree().leaf_counts);
+        }
+    BOOST_REQUIRE(!tv_columnar());
+}
+
+BOOST_FIXTURE_TEST_CASE(test_simplification_sorting, wf_columnar_fixture)
+{
+    evolve(false, false);
+    BOOST_REQUIRE(same_tables(std_tables, columnar_tables));
+}
+
+BOOST_FIXTURE_TEST_CASE(test_simplification_edge_buffering, wf_columnar_fixture)
+{
+    evolve(true, false);
+    BOOST_REQUIRE(same_tables(std_tables, columnar_tables));
+}
+
+BOOST_FIXTURE_TEST_CASE(test_simplification_from_buffer, wf_columnar_fixture)
+{
+    evolve(true, true);
+    BOOST_REQUIRE(same_tables(std_tables, columnar_tables));
+}
+
+BOOST_AUTO_TEST_CASE(test_serialization_round_trip)
+{
+    auto columnar_tables = make_simple_tables<fwdpp::ts::columnar_table_collection>();
+    columnar_tables.emplace_back_site(0.5, fwdpp::ts::default_ancestral_state);
+    columnar_tables.emplace_back_mutation(4, 0lu, 0lu, fwdpp::ts::default_derived_state,
+                                          true);
+    std::ostringstream o;
+    fwdpp::ts::io::serialize_tables(o, columnar_tables);
+    std::istringstream i(o.str());
+    auto std_tables
+        = fwdpp::ts::io::deserialize_tables<fwdpp::ts::std_table_collection>()(i);
+    BOOST_REQUIRE(same_tables(std_tables, columnar_tables));
+
+    std::ostringstream o2;
+    fwdpp::ts::io::serialize_tables(o2, std_tables);
+    std::istringstream i2(o2.str());
+    auto columnar_tables2
+        = fwdpp::ts::io::deserialize_tables<fwdpp::ts::columnar_table_collection>()(
+            i2);
+    BOOST_REQUIRE(columnar_tables == columnar_tables2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,224 @@
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <boost/test/unit_test.hpp>
+#include <fwdpp/ts/std_table_collection.hpp>
+#include <fwdpp/ts/compact_table_collection.hpp>
+#include <fwdpp/ts/table_collection_functions.hpp>
+#include <fwdpp/ts/simplify_tables.hpp>
+#include <fwdpp/ts/tree_visitor.hpp>
+#include <fwdpp/ts/serialization.hpp>
+#include "wfevolve_table_collection.hpp"
+
+namespace
+{
+    template <typename A, typename B>
+    bool
+    same_rows(const A& a, const B& b)
+    {
+        if (a.size() != b.size())
+            {
+                return false;
+            }
+        for (std::size_t i = 0; i < a.size(); ++i)
+            {
+                typename B::value_type x{a[i]};
+                if (!(x == b[i]))
+                    {
+                        return false;
+                    }
+            }
+        return true;
+    }
+
+    template <typename TableCollectionType>
+    std::vector<fwdpp::ts::table_index_t>
+    evolve_discrete_genome(unsigned N, unsigned ngenerations, TableCollectionType& tables)
+    // Wright-Fisher model with crossovers and mutations at integer
+    // positions, so that the same history can be recorded in
+    // compact tables.  The random number stream does not depend on
+    // the table type.  Returns the nodes of the last generation.
+    {
+        std::mt19937 generator(101);
+        const auto L = static_cast<int>(tables.genome_length());
+        std::uniform_int_distribution<int> parent(0, N - 1), breakpoint(1, L - 1),
+            position(0, L - 1), coin(0, 1);
+        std::poisson_distribution<int> nxovers(1.), nmuts(0.5);
+        std::vector<bool> used_positions(L, false);
+        std::vector<fwdpp::ts::table_index_t> nodes, next_nodes;
+        std::vector<int> breakpoints;
+        for (unsigned i = 0; i < 2 * N; ++i)
+            {
+                nodes.push_back(tables.emplace_back_node(0, 0.));
+            }
+        std::size_t key = 0;
+        for (unsigned gen = 1; gen <= ngenerations; ++gen)
+            {
+                next_nodes.clear();
+                for (unsigned i = 0; i < 2 * N; ++i)
+                    {
+                        auto p = parent(generator);
+                        auto child = tables.emplace_back_node(0, gen);
+                        next_nodes.push_back(child);
+                        breakpoints.clear();
+                        for (int x = nxovers(generator); x > 0; --x)
+                            {
+                                breakpoints.push_back(breakpoint(generator));
+                            }
+                        std::sort(begin(breakpoints), end(breakpoints));
+                        breakpoints.erase(
+                            std::unique(begin(breakpoints), end(breakpoints)),
+                            end(breakpoints));
+                        breakpoints.push_back(L);
+                        auto pnode = coin(generator);
+                        int left = 0;
+                        for (auto b : breakpoints)
+                            {
+                                tables.push_back_edge(left, b, nodes[2 * p + pnode],
+                                                      child);
+                                left = b;
+                                pnode = !pnode;
+                            }
+                        for (int m = nmuts(generator); m > 0; --m)
+                            {
+                                auto pos = position(generator);
+                                if (!used_positions[pos])
+                                    {
+                                        used_positions[pos] = true;
+                                        auto site = tables.emplace_back_site(
+                                            pos, fwdpp::ts::default_ancestral_state);
+                                        tables.emplace_back_mutation(
+                                            child, key, site,
+                                            fwdpp::ts::default_derived_state,
+                                            key % 3 != 0);
+                                        ++key;
+                                    }
+                            }
+                    }
+                nodes.swap(next_nodes);
+            }
+        fwdpp::ts::sort_tables_for_simplification(0, tables);
+        std::vector<fwdpp::ts::table_index_t> idmap;
+        std::vector<std::size_t> preserved_variants;
+        fwdpp::ts::simplify_tables(nodes, tables, fwdpp::ts::simplification_flags{},
+                                   idmap, preserved_variants);
+        tables.build_indexes();
+        for (auto& n : nodes)
+            {
+                n = idmap[n];
+            }
+        return nodes;
+    }
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(test_compact_table_collection)
+
+BOOST_AUTO_TEST_CASE(test_record_sizes)
+{
+    BOOST_REQUIRE(sizeof(fwdpp::ts::compact_node) * 2 <= sizeof(fwdpp::ts::node));
+    BOOST_REQUIRE(sizeof(fwdpp::ts::compact_edge) < sizeof(fwdpp::ts::edge));
+    BOOST_REQUIRE(sizeof(fwdpp::ts::compact_site) * 2 <= sizeof(fwdpp::ts::site));
+    BOOST_REQUIRE(sizeof(fwdpp::ts::compact_mutation_record) * 2
+                  <= sizeof(fwdpp::ts::mutation_record));
+}
+
+BOOST_AUTO_TEST_CASE(test_validation)
+{
+    fwdpp::ts::compact_table_collection tables(100.);
+    BOOST_REQUIRE_NO_THROW(tables.push_back_node(3, 0));
+    BOOST_REQUIRE_THROW(tables.push_back_node(3.5, 0), std::invalid_argument);
+    BOOST_REQUIRE_THROW(tables.push_back_node(1e10, 0), std::invalid_argument);
+    BOOST_REQUIRE_NO_THROW(tables.push_back_edge(0, 100, 0, 1));
+    BOOST_REQUIRE_THROW(tables.push_back_edge(0.25, 100, 0, 1), std::invalid_argument);
+    BOOST_REQUIRE_THROW(
+        tables.push_back_edge(0, std::numeric_limits<double>::infinity(), 0, 1),
+        std::invalid_argument);
+    BOOST_REQUIRE_THROW(tables.emplace_back_site(1.5, fwdpp::ts::default_ancestral_state),
+                        std::invalid_argument);
+    BOOST_REQUIRE_THROW(tables.emplace_back_mutation(
+                            0, std::numeric_limits<std::size_t>::max(), 0lu,
+                            fwdpp::ts::default_derived_state, true),
+                        std::invalid_argument);
+    BOOST_REQUIRE_EQUAL(tables.num_nodes(), 1);
+    BOOST_REQUIRE_EQUAL(tables.num_edges(), 1);
+    BOOST_REQUIRE(tables.sites.empty());
+    BOOST_REQUIRE(tables.mutations.empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_simplification_matches_std_tables)
+// No recombination, so that all edges span the
+// (integer) genome length.
+{
+    for (bool buffer_new_edges : {false, true})
+        {
+            fwdpp::ts::std_table_collection std_tables(1000.);
+            fwdpp::ts::compact_table_collection compact_tables(1000.);
+            wfevolve_table_collection(42, 100, 500, 0., 0., 50, buffer_new_edges, false,
+                                      false, empty_policies{}, std_tables);
+            wfevolve_table_collection(42, 100, 500, 0., 0., 50, buffer_new_edges, false,
+                                      false, empty_policies{}, compact_tables);
+            BOOST_REQUIRE(same_rows(std_tables.nodes, compact_tables.nodes));
+            BOOST_REQUIRE(same_rows(std_tables.edges, compact_tables.edges));
+        }
+}
+
+BOOST_AUTO_TEST_CASE(test_simplification_with_recombination_and_mutation)
+{
+    fwdpp::ts::std_table_collection std_tables(1000.);
+    fwdpp::ts::compact_table_collection compact_tables(1000.);
+    auto samples = evolve_discrete_genome(50, 200, std_tables);
+    BOOST_REQUIRE(evolve_discrete_genome(50, 200, compact_tables) == samples);
+
+    BOOST_REQUIRE(same_rows(std_tables.nodes, compact_tables.nodes));
+    BOOST_REQUIRE(same_rows(std_tables.edges, compact_tables.edges));
+    BOOST_REQUIRE(same_rows(std_tables.sites, compact_tables.sites));
+    BOOST_REQUIRE(same_rows(std_tables.mutations, compact_tables.mutations));
+    // Recombination left more than one tree and mutation
+    // left variants after simplification.
+    BOOST_REQUIRE(std::any_of(begin(std_tables.edges), end(std_tables.edges),
+                              [&std_tables](const fwdpp::ts::edge& e) {
+                                  return e.left > 0.
+                                         || e.right < std_tables.genome_length();
+                              }));
+    BOOST_REQUIRE(!std_tables.mutations.empty());
+
+    fwdpp::ts::tree_visitor<fwdpp::ts::std_table_collection> tv_std(
+        std_tables, samples, fwdpp::ts::update_samples_list(true));
+    fwdpp::ts::tree_visitor<fwdpp::ts::compact_table_collection> tv_compact(
+        compact_tables, samples, fwdpp::ts::update_samples_list(true));
+    unsigned ntrees = 0;
+    while (tv_std())
+        {
+            BOOST_REQUIRE(tv_compact());
+            BOOST_REQUIRE_EQUAL(tv_std.tree().left, tv_compact.tree().left);
+            BOOST_REQUIRE_EQUAL(tv_std.tree().right, tv_compact.tree().right);
+            BOOST_REQUIRE(tv_std.tree().parents == tv_compact.tree().parents);
+            BOOST_REQUIRE(tv_std.tree().leaf_counts == tv_compact.tree().leaf_counts);
+            ++ntrees;
+        }
+    BOOST_REQUIRE(!tv_compact());
+    BOOST_REQUIRE(ntrees > 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_serialization_round_trip)
+{
+    fwdpp::ts::compact_table_collection tables(100.);
+    tables.push_back_node(1, 0);
+    tables.push_back_node(1, 0);
+    tables.push_back_node(0, 0);
+    tables.push_back_edge(0, 100, 2, 0);
+    tables.push_back_edge(0, 100, 2, 1);
+    tables.emplace_back_site(50., fwdpp::ts::default_ancestral_state);
+    tables.emplace_back_mutation(0, 7lu, 0lu, fwdpp::ts::default_derived_state, true);
+    std::ostringstream o;
+    fwdpp::ts::io::serialize_tables(o, tables);
+    std::istringstream i(o.str());
+    auto tables2
+        = fwdpp::ts::io::deserialize_tables<fwdpp::ts::compact_table_collection>()(i);
+    BOOST_REQUIRE(tables == tables2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
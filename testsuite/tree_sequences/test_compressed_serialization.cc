@@ -0,0 +1,170 @@
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <boost/test/unit_test.hpp>
+#include <fwdpp/ts/std_table_collection.hpp>
+#include <fwdpp/ts/columnar_table_collection.hpp>
+#include <fwdpp/ts/compressed_serialization.hpp>
+#include "wfevolve_table_collection.hpp"
+
+namespace
+{
+    struct wf_compression_fixture
+    {
+        fwdpp::ts::std_table_collection tables;
+        wf_compression_fixture() : tables(1.)
+        {
+            wfevolve_table_collection(42, 100, 500, 0., 10., 50, false, false, false,
+                                      empty_policies{}, tables);
+            tables.build_indexes();
+        }
+
+        template <typename TableCollectionType>
+        std::string
+        compress(const TableCollectionType& t)
+        {
+            std::ostringstream o;
+            fwdpp::ts::io::serialize_tables_compressed(o, t);
+            return o.str();
+        }
+    };
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(test_varint_encoding)
+
+BOOST_AUTO_TEST_CASE(test_zigzag)
+{
+    using namespace fwdpp::ts::io::detail;
+    BOOST_REQUIRE_EQUAL(zigzag_encode(0), 0);
+    BOOST_REQUIRE_EQUAL(zigzag_encode(static_cast<std::uint64_t>(-1)), 1);
+    BOOST_REQUIRE_EQUAL(zigzag_encode(1), 2);
+    BOOST_REQUIRE_EQUAL(zigzag_encode(static_cast<std::uint64_t>(-2)), 3);
+    for (std::int64_t x : {std::numeric_limits<std::int64_t>::min(), std::int64_t{-300},
+                           std::int64_t{0}, std::int64_t{127},
+                           std::numeric_limits<std::int64_t>::max()})
+        {
+            const auto u = static_cast<std::uint64_t>(x);
+            BOOST_REQUIRE_EQUAL(zigzag_decode(zigzag_encode(u)), u);
+        }
+}
+
+BOOST_AUTO_TEST_CASE(test_varint)
+{
+    using namespace fwdpp::ts::io::detail;
+    std::vector<char> buffer;
+    encode_varint(127, buffer);
+    BOOST_REQUIRE_EQUAL(buffer.size(), 1);
+    encode_varint(128, buffer);
+    BOOST_REQUIRE_EQUAL(buffer.size(), 3);
+    encode_varint(std::numeric_limits<std::uint64_t>::max(), buffer);
+    BOOST_REQUIRE_EQUAL(buffer.size(), 13);
+    const char* p = buffer.data();
+    const char* end = buffer.data() + buffer.size();
+    BOOST_REQUIRE_EQUAL(decode_varint(p, end), 127);
+    BOOST_REQUIRE_EQUAL(decode_varint(p, end), 128);
+    BOOST_REQUIRE_EQUAL(decode_varint(p, end),
+                        std::numeric_limits<std::uint64_t>::max());
+    BOOST_REQUIRE(p == end);
+    // The last byte of a varint has its high bit cleared
+    buffer.pop_back();
+    p = buffer.data() + 3;
+    end = buffer.data() + buffer.size();
+    BOOST_REQUIRE_THROW(decode_varint(p, end), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_FIXTURE_TEST_SUITE(test_compressed_serialization, wf_compression_fixture)
+
+BOOST_AUTO_TEST_CASE(test_round_trip)
+{
+    std::istringstream i(compress(tables));
+    auto tables2 = fwdpp::ts::io::deserialize_tables_compressed<
+        fwdpp::ts::std_table_collection>()(i);
+    BOOST_REQUIRE(tables == tables2);
+    BOOST_REQUIRE(tables2.indexed());
+}
+
+BOOST_AUTO_TEST_CASE(test_smaller_than_uncompressed)
+{
+    std::ostringstream o;
+    fwdpp::ts::io::serialize_tables(o, tables);
+    BOOST_REQUIRE(compress(tables).size() < o.str().size());
+}
+
+BOOST_AUTO_TEST_CASE(test_integer_genome)
+{
+    // Node times and breakpoints are integers, and the
+    // edge table is sorted, so each value takes one or
+    // two bytes.
+    fwdpp::ts::std_table_collection t(1000.);
+    for (int generation = 0; generation < 100; ++generation)
+        {
+            t.push_back_node(generation, 0);
+        }
+    for (int parent = 98; parent >= 0; --parent)
+        {
+            for (int left = 0; left < 1000; left += 100)
+                {
+                    t.push_back_edge(left, left + 100, parent, parent + 1);
+                }
+        }
+    t.build_indexes();
+    std::ostringstream o;
+    fwdpp::ts::io::serialize_tables(o, t);
+    auto compressed = compress(t);
+    BOOST_REQUIRE(compressed.size() < o.str().size() / 3);
+    std::istringstream i(compressed);
+    auto t2 = fwdpp::ts::io::deserialize_tables_compressed<
+        fwdpp::ts::std_table_collection>()(i);
+    BOOST_REQUIRE(t == t2);
+}
+
+BOOST_AUTO_TEST_CASE(test_columnar_round_trip)
+{
+    std::istringstream i(compress(tables));
+    auto columnar = fwdpp::ts::io::deserialize_tables_compressed<
+        fwdpp::ts::columnar_table_collection>()(i);
+    BOOST_REQUIRE_EQUAL(columnar.edges.size(), tables.edges.size());
+    BOOST_REQUIRE_EQUAL(compress(columnar), compress(tables));
+}
+
+BOOST_AUTO_TEST_CASE(test_non_integer_values)
+{
+    fwdpp::ts::std_table_collection t(1.);
+    t.push_back_node(1.5, 0);
+    t.push_back_node(-0., 0);
+    t.push_back_node(0., -1);
+    t.push_back_edge(0., 1. / 3., 0, 1);
+    t.push_back_edge(1. / 3., 1., 0, 2);
+    t.emplace_back_site(0.1, fwdpp::ts::default_ancestral_state);
+    t.emplace_back_mutation(1, std::numeric_limits<std::size_t>::max(), 0lu,
+                            std::int8_t{-3}, false);
+    t.build_indexes();
+    std::istringstream i(compress(t));
+    auto t2 = fwdpp::ts::io::deserialize_tables_compressed<
+        fwdpp::ts::std_table_collection>()(i);
+    BOOST_REQUIRE(t == t2);
+    BOOST_REQUIRE(std::signbit(t2.nodes[1].time));
+}
+
+BOOST_AUTO_TEST_CASE(test_invalid_input)
+{
+    auto buffer = compress(tables);
+    {
+        std::istringstream i(buffer.substr(0, buffer.size() / 2));
+        BOOST_REQUIRE_THROW(fwdpp::ts::io::deserialize_tables_compressed<
+                                fwdpp::ts::std_table_collection>()(i),
+                            std::runtime_error);
+    }
+    {
+        std::ostringstream o;
+        fwdpp::ts::io::serialize_tables(o, tables);
+        std::istringstream i(o.str());
+        BOOST_REQUIRE_THROW(fwdpp::ts::io::deserialize_tables_compressed<
+                                fwdpp::ts::std_table_collection>()(i),
+                            std::runtime_error);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
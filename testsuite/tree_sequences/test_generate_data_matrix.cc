@@ -56,4 +56,37 @@ BOOST_FIXTURE_TEST_CASE(simple_multiple_mutations_test,
         fwdpp::ts::num_samples(tv.tree(), 4));
 }
 
+BOOST_FIXTURE_TEST_CASE(test_multithreaded, simple_table_collection_infinite_sites)
+{
+    for (std::size_t i = 0; i < tables.mutations.size(); i += 3)
+        {
+            tables.mutations[i].neutral = false;
+        }
+    const auto L = tables.genome_length();
+    for (bool skip_fixed : {false, true})
+        {
+            auto dm = fwdpp::ts::generate_data_matrix(tables, samples, true, true,
+                                                      skip_fixed);
+            for (unsigned num_threads : {1u, 2u, 3u, 64u})
+                {
+                    auto dm2 = fwdpp::ts::generate_data_matrix(
+                        tables, samples, true, true, skip_fixed, 0., L, num_threads);
+                    BOOST_REQUIRE(dm2.neutral.data == dm.neutral.data);
+                    BOOST_REQUIRE(dm2.neutral.positions == dm.neutral.positions);
+                    BOOST_REQUIRE(dm2.neutral_keys == dm.neutral_keys);
+                    BOOST_REQUIRE(dm2.selected.data == dm.selected.data);
+                    BOOST_REQUIRE(dm2.selected.positions == dm.selected.positions);
+                    BOOST_REQUIRE(dm2.selected_keys == dm.selected_keys);
+                }
+        }
+    const double start = tables.sites[1].position, stop = tables.sites[5].position;
+    auto dm = fwdpp::ts::generate_data_matrix(tables, samples, true, true, false, start,
+                                              stop);
+    auto dm2 = fwdpp::ts::generate_data_matrix(tables, samples, true, true, false, start,
+                                               stop, 4);
+    BOOST_REQUIRE(dm2.neutral.positions == dm.neutral.positions);
+    BOOST_REQUIRE(dm2.selected.positions == dm.selected.positions);
+    BOOST_REQUIRE_EQUAL(dm2.neutral.positions.size() + dm2.selected.positions.size(), 4);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
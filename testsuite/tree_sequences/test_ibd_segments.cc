@@ -0,0 +1,158 @@
+#include <cmath>
+#include <tuple>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include <boost/test/unit_test.hpp>
+#include <fwdpp/ts/std_table_collection.hpp>
+#include <fwdpp/ts/tree_visitor.hpp>
+#include <fwdpp/ts/ibd_segments.hpp>
+#include "wfevolve_table_collection.hpp"
+
+namespace
+{
+    using segment_tuple = std::tuple<fwdpp::ts::table_index_t, fwdpp::ts::table_index_t,
+                                     double, double, fwdpp::ts::table_index_t>;
+
+    struct wf_ibd_fixture
+    {
+        fwdpp::ts::std_table_collection tables;
+        std::vector<fwdpp::ts::table_index_t> samples;
+
+        wf_ibd_fixture() : tables(1.), samples(200)
+        {
+            wfevolve_table_collection(42, 100, 500, 0., 10., 50, false, false, false,
+                                      empty_policies{}, tables);
+            tables.build_indexes();
+            std::iota(begin(samples), end(samples), 0);
+        }
+
+        std::vector<segment_tuple>
+        naive_segments(
+            const std::vector<std::pair<fwdpp::ts::table_index_t,
+                                        fwdpp::ts::table_index_t>>& pairs,
+            double min_length, double max_tmrca) const
+        // Find the MRCA of every pair in every tree
+        {
+            std::vector<segment_tuple> rv;
+            for (auto& p : pairs)
+                {
+                    fwdpp::ts::tree_visitor<fwdpp::ts::std_table_collection> tv(
+                        tables, samples, fwdpp::ts::update_samples_list(false));
+                    fwdpp::ts::table_index_t current = fwdpp::ts::NULL_INDEX;
+                    double left = 0.;
+                    auto end_segment = [&](double right) {
+                        if (current == fwdpp::ts::NULL_INDEX || right - left < min_length)
+                            {
+                                return;
+                            }
+                        auto t = std::max(tables.nodes[p.first].time,
+                                          tables.nodes[p.second].time)
+                                 - tables.nodes[current].time;
+                        if (t <= max_tmrca)
+                            {
+                                rv.emplace_back(p.first, p.second, left, right, current);
+                            }
+                    };
+                    while (tv())
+                        {
+                            const auto& m = tv.tree();
+                            std::vector<int> ancestor(m.size(), 0);
+                            for (auto u = p.first; u != fwdpp::ts::NULL_INDEX;
+                                 u = m.parents[u])
+                                {
+                                    ancestor[u] = 1;
+                                }
+                            auto u = p.second;
+                            while (u != fwdpp::ts::NULL_INDEX && !ancestor[u])
+                                {
+                                    u = m.parents[u];
+                                }
+                            if (u != current)
+                                {
+                                    end_segment(m.left);
+                                    current = u;
+                                    left = m.left;
+                                }
+                        }
+                    end_segment(tables.genome_length());
+                }
+            std::sort(begin(rv), end(rv));
+            return rv;
+        }
+
+        void
+        compare(const std::vector<std::pair<fwdpp::ts::table_index_t,
+                                            fwdpp::ts::table_index_t>>& pairs,
+                double min_length, double max_tmrca) const
+        {
+            auto segments
+                = fwdpp::ts::ibd_segments(tables, pairs, min_length, max_tmrca);
+            std::vector<segment_tuple> found;
+            for (std::size_t i = 0; i < segments.size(); ++i)
+                {
+                    auto& s = segments[i];
+                    found.emplace_back(s.a, s.b, s.left, s.right, s.node);
+                    BOOST_REQUIRE(s.right - s.left >= min_length);
+                    BOOST_REQUIRE(s.tmrca <= max_tmrca);
+                    BOOST_REQUIRE_EQUAL(s.tmrca, std::max(tables.nodes[s.a].time,
+                                                          tables.nodes[s.b].time)
+                                                     - tables.nodes[s.node].time);
+                    if (i > 0)
+                        {
+                            BOOST_REQUIRE(segments[i - 1].right <= s.right);
+                        }
+                }
+            std::sort(begin(found), end(found));
+            auto expected = naive_segments(pairs, min_length, max_tmrca);
+            BOOST_REQUIRE(!expected.empty());
+            BOOST_REQUIRE(found == expected);
+        }
+    };
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(test_ibd_segments, wf_ibd_fixture)
+
+BOOST_AUTO_TEST_CASE(test_all_pairs)
+{
+    std::vector<fwdpp::ts::table_index_t> group{0, 5, 17, 33, 64, 101, 150, 199};
+    auto pairs = fwdpp::ts::all_pairs(group);
+    BOOST_REQUIRE_EQUAL(pairs.size(), group.size() * (group.size() - 1) / 2);
+    compare(pairs, 0., std::numeric_limits<double>::infinity());
+}
+
+BOOST_AUTO_TEST_CASE(test_two_groups)
+{
+    auto pairs = fwdpp::ts::all_pairs({1, 2, 3, 4}, {100, 120, 140});
+    BOOST_REQUIRE_EQUAL(pairs.size(), 12);
+    compare(pairs, 0., std::numeric_limits<double>::infinity());
+}
+
+BOOST_AUTO_TEST_CASE(test_filters)
+{
+    std::vector<fwdpp::ts::table_index_t> group(20);
+    std::iota(begin(group), end(group), 40);
+    auto pairs = fwdpp::ts::all_pairs(group);
+    compare(pairs, 0.05, std::numeric_limits<double>::infinity());
+    compare(pairs, 0., 100.);
+    compare(pairs, 0.01, 50.);
+}
+
+BOOST_AUTO_TEST_CASE(test_invalid_input)
+{
+    using pairs_t = std::vector<std::pair<fwdpp::ts::table_index_t,
+                                          fwdpp::ts::table_index_t>>;
+    BOOST_REQUIRE_THROW(fwdpp::ts::ibd_segments(tables, pairs_t{}),
+                        std::invalid_argument);
+    BOOST_REQUIRE_THROW(fwdpp::ts::ibd_segments(tables, pairs_t{{1, 1}}),
+                        std::invalid_argument);
+    BOOST_REQUIRE_THROW(
+        fwdpp::ts::ibd_segments(
+            tables, pairs_t{{0, static_cast<fwdpp::ts::table_index_t>(
+                                    tables.nodes.size())}}),
+        std::invalid_argument);
+    BOOST_REQUIRE_THROW(fwdpp::ts::ibd_segments(tables, pairs_t{{0, 1}}, -1.),
+                        std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
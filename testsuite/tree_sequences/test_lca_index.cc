@@ -0,0 +1,161 @@
+#include <cmath>
+#include <vector>
+#include <numeric>
+#include <boost/test/unit_test.hpp>
+#include <fwdpp/ts/std_table_collection.hpp>
+#include <fwdpp/ts/table_collection_functions.hpp>
+#include <fwdpp/ts/tree_visitor.hpp>
+#include <fwdpp/ts/marginal_tree_functions/lca.hpp>
+#include "wfevolve_table_collection.hpp"
+
+namespace
+{
+    fwdpp::ts::table_index_t
+    naive_lca(const fwdpp::ts::marginal_tree& m, fwdpp::ts::table_index_t u,
+              fwdpp::ts::table_index_t v)
+    {
+        std::vector<int> ancestor(m.size(), 0);
+        for (auto x = u; x != fwdpp::ts::NULL_INDEX; x = m.parents[x])
+            {
+                ancestor[x] = 1;
+            }
+        for (auto x = v; x != fwdpp::ts::NULL_INDEX; x = m.parents[x])
+            {
+                if (ancestor[x])
+                    {
+                        return x;
+                    }
+            }
+        return fwdpp::ts::NULL_INDEX;
+    }
+
+    struct wf_lca_fixture
+    {
+        fwdpp::ts::std_table_collection tables;
+        std::vector<fwdpp::ts::table_index_t> samples;
+
+        wf_lca_fixture() : tables(1.), samples(200)
+        {
+            wfevolve_table_collection(42, 100, 500, 0., 10., 50, false, false, false,
+                                      empty_policies{}, tables);
+            tables.build_indexes();
+            std::iota(begin(samples), end(samples), 0);
+        }
+    };
+
+    struct forest_fixture
+    //  4     5
+    // ---   ---
+    // 0 1   2 3
+    {
+        fwdpp::ts::std_table_collection tables;
+        std::vector<fwdpp::ts::table_index_t> samples;
+
+        forest_fixture() : tables(1.), samples{0, 1, 2, 3}
+        {
+            for (int i = 0; i < 4; ++i)
+                {
+                    tables.push_back_node(2, 0);
+                }
+            tables.push_back_node(1, 0);
+            tables.push_back_node(0, 0);
+            tables.push_back_edge(0, 1, 4, 0);
+            tables.push_back_edge(0, 1, 4, 1);
+            tables.push_back_edge(0, 1, 5, 2);
+            tables.push_back_edge(0, 1, 5, 3);
+            fwdpp::ts::sort_edge_table(tables);
+            tables.build_indexes();
+        }
+    };
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(test_lca_index_wf, wf_lca_fixture)
+
+BOOST_AUTO_TEST_CASE(test_same_as_naive)
+{
+    fwdpp::ts::tree_visitor<fwdpp::ts::std_table_collection> tv(
+        tables, samples, fwdpp::ts::update_samples_list(false));
+    fwdpp::ts::lca_index index;
+    int ntrees = 0;
+    while (tv())
+        {
+            BOOST_REQUIRE(index.update(tv.tree()));
+            BOOST_REQUIRE(!index.update(tv.tree()));
+            const auto& m = tv.tree();
+            // Samples and some internal nodes
+            for (fwdpp::ts::table_index_t u = 0;
+                 u < static_cast<fwdpp::ts::table_index_t>(m.size()); u += 7)
+                {
+                    for (fwdpp::ts::table_index_t v = 0;
+                         v < static_cast<fwdpp::ts::table_index_t>(m.size()); v += 11)
+                        {
+                            auto expected = naive_lca(m, u, v);
+                            // Nodes that are not above samples are not in the tree
+                            if (m.above_sample[u] && m.above_sample[v])
+                                {
+                                    BOOST_REQUIRE_EQUAL(index.lca(u, v), expected);
+                                }
+                            else
+                                {
+                                    BOOST_REQUIRE_EQUAL(index.lca(u, v),
+                                                        fwdpp::ts::NULL_INDEX);
+                                }
+                        }
+                }
+            ++ntrees;
+        }
+    BOOST_REQUIRE(ntrees > 1);
+    BOOST_REQUIRE_THROW(index.lca(0, static_cast<fwdpp::ts::table_index_t>(
+                                         tables.nodes.size())),
+                        std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(test_pairwise_tmrca)
+{
+    fwdpp::ts::tree_visitor<fwdpp::ts::std_table_collection> tv(
+        tables, samples, fwdpp::ts::update_samples_list(false));
+    BOOST_REQUIRE(tv());
+    fwdpp::ts::lca_index index(tv.tree());
+    std::vector<fwdpp::ts::table_index_t> subset{3, 17, 42, 99, 150};
+    std::vector<double> tmrca;
+    fwdpp::ts::pairwise_tmrca(index, tables.nodes, subset, tmrca);
+    BOOST_REQUIRE_EQUAL(tmrca.size(), 10);
+    std::size_t k = 0;
+    for (std::size_t i = 0; i < subset.size(); ++i)
+        {
+            for (std::size_t j = i + 1; j < subset.size(); ++j, ++k)
+                {
+                    auto m = naive_lca(tv.tree(), subset[i], subset[j]);
+                    BOOST_REQUIRE_EQUAL(tmrca[k], tables.nodes[subset[i]].time
+                                                      - tables.nodes[m].time);
+                    BOOST_REQUIRE(tmrca[k] > 0.);
+                }
+        }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_FIXTURE_TEST_SUITE(test_lca_index_forest, forest_fixture)
+
+BOOST_AUTO_TEST_CASE(test_multiple_roots)
+{
+    fwdpp::ts::tree_visitor<fwdpp::ts::std_table_collection> tv(
+        tables, samples, fwdpp::ts::update_samples_list(false));
+    BOOST_REQUIRE(tv());
+    BOOST_REQUIRE_EQUAL(tv.tree().num_roots(), 2);
+    fwdpp::ts::lca_index index(tv.tree());
+    BOOST_REQUIRE_EQUAL(index.lca(0, 1), 4);
+    BOOST_REQUIRE_EQUAL(index.lca(2, 3), 5);
+    BOOST_REQUIRE_EQUAL(index.lca(0, 4), 4);
+    BOOST_REQUIRE_EQUAL(index.lca(2, 2), 2);
+    BOOST_REQUIRE_EQUAL(index.lca(1, 2), fwdpp::ts::NULL_INDEX);
+    BOOST_REQUIRE_EQUAL(index.lca(4, 5), fwdpp::ts::NULL_INDEX);
+    std::vector<double> tmrca;
+    fwdpp::ts::pairwise_tmrca(index, tables.nodes, samples, tmrca);
+    BOOST_REQUIRE_EQUAL(tmrca.size(), 6);
+    BOOST_REQUIRE_EQUAL(tmrca[0], 1.);
+    BOOST_REQUIRE(std::isnan(tmrca[1]));
+    BOOST_REQUIRE_EQUAL(tmrca[5], 2.);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,193 @@
+#include <sstream>
+#include <numeric>
+#include <iterator>
+#include <algorithm>
+#include <boost/test/unit_test.hpp>
+#include <fwdpp/ts/std_table_collection.hpp>
+#include <fwdpp/ts/mmap_table_collection.hpp>
+#include <fwdpp/ts/table_collection_functions.hpp>
+#include <fwdpp/ts/tree_visitor.hpp>
+#include <fwdpp/ts/serialization.hpp>
+#include "wfevolve_table_collection.hpp"
+
+namespace
+{
+    template <typename A, typename B>
+    bool
+    same_rows(const A& a, const B& b)
+    {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+    }
+
+    template <typename A, typename B>
+    bool
+    same_tables(const A& a, const B& b)
+    {
+        return a.genome_length() == b.genome_length() && same_rows(a.nodes, b.nodes)
+               && same_rows(a.edges, b.edges) && same_rows(a.sites, b.sites)
+               && same_rows(a.mutations, b.mutations)
+               && a.preserved_nodes == b.preserved_nodes
+               && a.input_left == b.input_left && a.output_right == b.output_right;
+    }
+
+    struct wf_mmap_fixture
+    {
+        fwdpp::ts::std_table_collection std_tables;
+        fwdpp::ts::mmap_table_collection mmap_tables;
+        wf_mmap_fixture() : std_tables(1.), mmap_tables(1.)
+        {
+        }
+
+        void
+        evolve(bool buffer_new_edges, bool simplify_from_buffer)
+        {
+            wfevolve_table_collection(42, 100, 500, 0., 10., 50, buffer_new_edges,
+                                      simplify_from_buffer, false, empty_policies{},
+                                      std_tables);
+            wfevolve_table_collection(42, 100, 500, 0., 10., 50, buffer_new_edges,
+                                      simplify_from_buffer, false, empty_policies{},
+                                      mmap_tables);
+            std_tables.build_indexes();
+            mmap_tables.build_indexes();
+        }
+    };
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(test_mmap_vector)
+
+BOOST_AUTO_TEST_CASE(test_vector_operations)
+{
+    std::vector<int> v;
+    fwdpp::ts::mmap_vector<int> m;
+    BOOST_REQUIRE_EQUAL(m.capacity(), 0);
+    for (int i = 0; i < 10000; ++i)
+        {
+            v.push_back(i);
+            m.push_back(i);
+        }
+    BOOST_REQUIRE(same_rows(v, m));
+    // push_back of an element of the container
+    // when the container must grow
+    while (m.size() < m.capacity())
+        {
+            v.push_back(v.front());
+            m.push_back(m.front());
+        }
+    v.push_back(v.front());
+    m.push_back(m.front());
+    BOOST_REQUIRE(same_rows(v, m));
+
+    v.erase(v.begin() + 10, v.begin() + 100);
+    m.erase(m.begin() + 10, m.begin() + 100);
+    std::vector<int> source(v.begin() + 1000, v.begin() + 1100);
+    v.insert(v.begin() + 5, source.begin(), source.end());
+    // Insert a range of the container into itself
+    m.insert(m.begin() + 5, m.begin() + 1000, m.begin() + 1100);
+    v.insert(v.begin(), -1);
+    m.insert(m.begin(), -1);
+    BOOST_REQUIRE(same_rows(v, m));
+
+    v.resize(20000, 7);
+    m.resize(20000, 7);
+    BOOST_REQUIRE(same_rows(v, m));
+    v.resize(50);
+    m.resize(50);
+    m.shrink_to_fit();
+    BOOST_REQUIRE(m.capacity() < 20000);
+    BOOST_REQUIRE(same_rows(v, m));
+
+    auto copy(m);
+    BOOST_REQUIRE(copy == m);
+    fwdpp::ts::mmap_vector<int> moved(std::move(copy));
+    BOOST_REQUIRE(moved == m);
+    BOOST_REQUIRE(copy.empty());
+    m.clear();
+    BOOST_REQUIRE(m.empty());
+    BOOST_REQUIRE(moved != m);
+    BOOST_REQUIRE_THROW(m.at(0), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(test_vector_range_operations)
+{
+    std::vector<int> v(5000);
+    std::iota(begin(v), end(v), 0);
+    fwdpp::ts::mmap_vector<int> m(begin(v), end(v)), other(10, -1);
+    // From another container
+    v.insert(v.end(), other.begin(), other.end());
+    m.insert(m.end(), other.begin(), other.end());
+    BOOST_REQUIRE(same_rows(v, m));
+    // Part of the container, while it must grow
+    std::vector<int> source(v.begin() + 10, v.begin() + 4000);
+    v.insert(v.begin() + 3, source.begin(), source.end());
+    m.insert(m.begin() + 3, m.begin() + 10, m.begin() + 4000);
+    BOOST_REQUIRE(same_rows(v, m));
+    v.assign(v.begin() + 100, v.begin() + 200);
+    m.assign(m.begin() + 100, m.begin() + 200);
+    BOOST_REQUIRE(same_rows(v, m));
+    // Input iterators
+    std::istringstream in("1 2 3 4");
+    m.assign(std::istream_iterator<int>(in), std::istream_iterator<int>());
+    std::istringstream in2("5 6");
+    m.insert(m.begin() + 1, std::istream_iterator<int>(in2),
+             std::istream_iterator<int>());
+    BOOST_REQUIRE(same_rows(std::vector<int>{1, 5, 6, 2, 3, 4}, m));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(test_mmap_table_collection)
+
+BOOST_FIXTURE_TEST_CASE(test_simplification_sorting, wf_mmap_fixture)
+{
+    evolve(false, false);
+    BOOST_REQUIRE(same_tables(std_tables, mmap_tables));
+}
+
+BOOST_FIXTURE_TEST_CASE(test_simplification_edge_buffering, wf_mmap_fixture)
+{
+    evolve(true, false);
+    BOOST_REQUIRE(same_tables(std_tables, mmap_tables));
+}
+
+BOOST_FIXTURE_TEST_CASE(test_simplification_from_buffer, wf_mmap_fixture)
+{
+    evolve(true, true);
+    BOOST_REQUIRE(same_tables(std_tables, mmap_tables));
+}
+
+BOOST_FIXTURE_TEST_CASE(test_tree_traversal, wf_mmap_fixture)
+{
+    evolve(false, false);
+    std::vector<fwdpp::ts::table_index_t> samples(200);
+    std::iota(begin(samples), end(samples), 0);
+    fwdpp::ts::tree_visitor<fwdpp::ts::std_table_collection> tv_std(
+        std_tables, samples, fwdpp::ts::update_samples_list(true));
+    fwdpp::ts::tree_visitor<fwdpp::ts::mmap_table_collection> tv_mmap(
+        mmap_tables, samples, fwdpp::ts::update_samples_list(true));
+    while (tv_std())
+        {
+            BOOST_REQUIRE(tv_mmap());
+            BOOST_REQUIRE(tv_std.tree().parents == tv_mmap.tree().parents);
+            BOOST_REQUIRE(tv_std.tree().leaf_counts == tv_mmap.tree().leaf_counts);
+        }
+    BOOST_REQUIRE(!tv_mmap());
+}
+
+BOOST_FIXTURE_TEST_CASE(test_serialization_round_trip, wf_mmap_fixture)
+{
+    evolve(false, false);
+    std::ostringstream o;
+    fwdpp::ts::io::serialize_tables(o, mmap_tables);
+    std::istringstream i(o.str());
+    auto tables = fwdpp::ts::io::deserialize_tables<fwdpp::ts::std_table_collection>()(i);
+    BOOST_REQUIRE(same_tables(tables, mmap_tables));
+
+    std::ostringstream o2;
+    fwdpp::ts::io::serialize_tables(o2, std_tables);
+    std::istringstream i2(o2.str());
+    auto mmap_tables2
+        = fwdpp::ts::io::deserialize_tables<fwdpp::ts::mmap_table_collection>()(i2);
+    BOOST_REQUIRE(mmap_tables == mmap_tables2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,93 @@
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <boost/test/unit_test.hpp>
+#include <fwdpp/ts/std_table_collection.hpp>
+#include <fwdpp/ts/table_collection_functions.hpp>
+#include <fwdpp/ts/simplification/simplification.hpp>
+
+namespace
+{
+    struct random_mutation_table_fixture
+    {
+        fwdpp::ts::std_table_collection tables;
+        std::vector<fwdpp::ts::simplification::mutation_node_map_entry> mutation_map;
+        std::vector<std::size_t> node_offsets;
+
+        random_mutation_table_fixture() : tables(1.), mutation_map{}, node_offsets{}
+        {
+            std::mt19937 generator(42);
+            for (int i = 0; i < 100; ++i)
+                {
+                    tables.push_back_node(0., 0);
+                }
+            std::uniform_real_distribution<double> position(0., 1.);
+            std::uniform_int_distribution<fwdpp::ts::table_index_t> node(0, 99);
+            for (std::size_t i = 0; i < 1000; ++i)
+                {
+                    auto site = tables.emplace_back_site(
+                        position(generator), fwdpp::ts::default_ancestral_state);
+                    tables.emplace_back_mutation(node(generator), i, site,
+                                                 fwdpp::ts::default_derived_state, true);
+                    // Some sites have two mutations
+                    if (i % 10 == 0)
+                        {
+                            tables.emplace_back_mutation(
+                                node(generator), i, site,
+                                fwdpp::ts::default_derived_state, true);
+                        }
+                }
+        }
+
+        void
+        check_mutation_map() const
+        {
+            BOOST_REQUIRE_EQUAL(mutation_map.size(), tables.mutations.size());
+            BOOST_REQUIRE(std::is_sorted(
+                begin(mutation_map), end(mutation_map),
+                [this](const fwdpp::ts::simplification::mutation_node_map_entry& a,
+                       const fwdpp::ts::simplification::mutation_node_map_entry& b) {
+                    return std::tie(a.node, tables.sites[a.site].position)
+                           < std::tie(b.node, tables.sites[b.site].position);
+                }));
+            std::vector<bool> seen(tables.mutations.size(), false);
+            for (const auto& m : mutation_map)
+                {
+                    BOOST_REQUIRE(!seen[m.location]);
+                    seen[m.location] = true;
+                    BOOST_REQUIRE_EQUAL(m.node, tables.mutations[m.location].node);
+                    BOOST_REQUIRE_EQUAL(m.site, tables.mutations[m.location].site);
+                }
+        }
+    };
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(test_mutation_simplification, random_mutation_table_fixture)
+
+BOOST_AUTO_TEST_CASE(test_mutation_map_sorted_table)
+{
+    fwdpp::ts::sort_mutation_table(tables);
+    fwdpp::ts::simplification::prep_mutation_simplification(tables, mutation_map,
+                                                            node_offsets);
+    check_mutation_map();
+    // Reusing the buffers gives the same result
+    auto copy = mutation_map;
+    fwdpp::ts::simplification::prep_mutation_simplification(tables, mutation_map,
+                                                            node_offsets);
+    BOOST_REQUIRE_EQUAL(copy.size(), mutation_map.size());
+    for (std::size_t i = 0; i < copy.size(); ++i)
+        {
+            BOOST_REQUIRE_EQUAL(copy[i].location, mutation_map[i].location);
+        }
+}
+
+BOOST_AUTO_TEST_CASE(test_mutation_map_unsorted_table)
+{
+    std::mt19937 generator(101);
+    std::shuffle(begin(tables.mutations), end(tables.mutations), generator);
+    fwdpp::ts::simplification::prep_mutation_simplification(tables, mutation_map,
+                                                            node_offsets);
+    check_mutation_map();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,176 @@
+#include <cmath>
+#include <random>
+#include <numeric>
+#include <vector>
+#include <algorithm>
+#include <boost/test/unit_test.hpp>
+#include <fwdpp/ts/std_table_collection.hpp>
+#include <fwdpp/ts/generate_data_matrix.hpp>
+#include <fwdpp/packed_data_matrix.hpp>
+#include "wfevolve_table_collection.hpp"
+
+namespace
+{
+    struct wf_packed_matrix_fixture
+    // 200 samples, so that rows span several words
+    {
+        fwdpp::ts::std_table_collection tables;
+        std::vector<fwdpp::ts::table_index_t> samples;
+
+        wf_packed_matrix_fixture() : tables(1.), samples(200)
+        {
+            wfevolve_table_collection(42, 100, 500, 0., 10., 50, false, false, false,
+                                      empty_policies{}, tables);
+            tables.build_indexes();
+            std::iota(begin(samples), end(samples), 0);
+            std::mt19937 rng(2020);
+            std::uniform_int_distribution<std::size_t> pick(0, tables.edges.size() - 1);
+            std::uniform_real_distribution<double> uniform(0., 1.);
+            std::vector<std::pair<double, std::size_t>> positions;
+            for (int i = 0; i < 100; ++i)
+                {
+                    auto e = pick(rng);
+                    const auto& edge = tables.edges[e];
+                    positions.emplace_back(
+                        edge.left + uniform(rng) * (edge.right - edge.left), e);
+                }
+            std::sort(begin(positions), end(positions));
+            for (std::size_t i = 0; i < positions.size(); ++i)
+                {
+                    const auto& edge = tables.edges[positions[i].second];
+                    auto s = tables.emplace_back_site(positions[i].first,
+                                                      fwdpp::ts::default_ancestral_state);
+                    const bool neutral = i % 3 != 0;
+                    tables.emplace_back_mutation(edge.parent, i, s,
+                                                 fwdpp::ts::default_derived_state,
+                                                 neutral);
+                    if (i % 10 == 0)
+                        {
+                            // Nested mutation to a third state
+                            tables.emplace_back_mutation(edge.child, i, s,
+                                                         std::int8_t{2}, neutral);
+                        }
+                }
+        }
+    };
+
+    void
+    require_equal(const fwdpp::state_matrix& unpacked,
+                  const fwdpp::packed_state_matrix& packed)
+    {
+        auto u = fwdpp::unpack(packed);
+        BOOST_REQUIRE(u.positions == unpacked.positions);
+        BOOST_REQUIRE_EQUAL(u.data.size(), unpacked.data.size());
+        for (std::size_t i = 0; i < u.data.size(); ++i)
+            {
+                BOOST_REQUIRE_EQUAL(static_cast<int>(u.data[i]),
+                                    static_cast<int>(unpacked.data[i] != 0));
+            }
+    }
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(test_packed_data_matrix, wf_packed_matrix_fixture)
+
+BOOST_AUTO_TEST_CASE(test_same_as_unpacked)
+{
+    auto dm = fwdpp::ts::generate_data_matrix(tables, samples, true, true, false);
+    auto pm = fwdpp::ts::generate_packed_data_matrix(tables, samples, true, true, false);
+    BOOST_REQUIRE_EQUAL(pm.ncol, dm.ncol);
+    BOOST_REQUIRE_EQUAL(pm.neutral.words_per_row(), 4);
+    BOOST_REQUIRE(!dm.neutral.positions.empty());
+    BOOST_REQUIRE(!dm.selected.positions.empty());
+    BOOST_REQUIRE(pm.neutral_keys == dm.neutral_keys);
+    BOOST_REQUIRE(pm.selected_keys == dm.selected_keys);
+    require_equal(dm.neutral, pm.neutral);
+    require_equal(dm.selected, pm.selected);
+    BOOST_REQUIRE_EQUAL(pm.neutral.data.size(),
+                        pm.neutral.nrow() * pm.neutral.words_per_row());
+}
+
+BOOST_AUTO_TEST_CASE(test_position_range)
+{
+    auto dm = fwdpp::ts::generate_data_matrix(tables, samples, true, false, true, 0.25,
+                                              0.5);
+    auto pm = fwdpp::ts::generate_packed_data_matrix(tables, samples, true, false,
+                                                     true, 0.25, 0.5);
+    BOOST_REQUIRE(pm.selected.positions.empty());
+    require_equal(dm.neutral, pm.neutral);
+}
+
+BOOST_AUTO_TEST_CASE(test_multithreaded)
+{
+    auto pm = fwdpp::ts::generate_packed_data_matrix(tables, samples, true, true, false);
+    auto pm2 = fwdpp::ts::generate_packed_data_matrix(tables, samples, true, true, false,
+                                                      0., 1., 5);
+    BOOST_REQUIRE(pm2.neutral.data == pm.neutral.data);
+    BOOST_REQUIRE(pm2.neutral.positions == pm.neutral.positions);
+    BOOST_REQUIRE(pm2.selected.data == pm.selected.data);
+    BOOST_REQUIRE(pm2.selected_keys == pm.selected_keys);
+}
+
+BOOST_AUTO_TEST_CASE(test_allele_counts)
+{
+    auto dm = fwdpp::ts::generate_data_matrix(tables, samples, true, true, false);
+    auto pm = fwdpp::ts::generate_packed_data_matrix(tables, samples, true, true, false);
+    auto counts = fwdpp::row_sums(pm);
+    for (auto m : {std::make_pair(&dm.neutral, &counts.first),
+                   std::make_pair(&dm.selected, &counts.second)})
+        {
+            BOOST_REQUIRE_EQUAL(m.second->size(), m.first->positions.size());
+            for (std::size_t i = 0; i < m.second->size(); ++i)
+                {
+                    auto first = m.first->data.begin() + i * dm.ncol;
+                    auto n = std::count_if(first, first + dm.ncol,
+                                           [](std::int8_t g) { return g != 0; });
+                    BOOST_REQUIRE_EQUAL((*m.second)[i], n);
+                }
+        }
+}
+
+BOOST_AUTO_TEST_CASE(test_pairwise_ld)
+{
+    auto pm = fwdpp::ts::generate_packed_data_matrix(tables, samples, true, false, true);
+    const auto& m = pm.neutral;
+    const double n = static_cast<double>(m.ncol);
+    for (std::size_t i = 0; i < m.nrow(); ++i)
+        {
+            for (std::size_t j = i; j < m.nrow(); ++j)
+                {
+                    double pa = 0., pb = 0., pab = 0.;
+                    for (std::size_t k = 0; k < m.ncol; ++k)
+                        {
+                            pa += m.get(i, k) / n;
+                            pb += m.get(j, k) / n;
+                            pab += (m.get(i, k) && m.get(j, k)) / n;
+                        }
+                    const double D = pab - pa * pb;
+                    auto ld = fwdpp::pairwise_ld(m, i, j);
+                    BOOST_REQUIRE_SMALL(ld.D - D, 1e-12);
+                    BOOST_REQUIRE_SMALL(
+                        ld.rsq - D * D / (pa * (1. - pa) * pb * (1. - pb)), 1e-9);
+                }
+            BOOST_REQUIRE_CLOSE(fwdpp::pairwise_ld(m, i, i).rsq, 1., 1e-9);
+        }
+    BOOST_REQUIRE_THROW(fwdpp::pairwise_ld(m, 0, m.nrow()), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(test_fixed_site_ld)
+{
+    fwdpp::packed_state_matrix m(70);
+    std::vector<int> all(70, 1), half(70, 0);
+    std::fill(begin(half), begin(half) + 35, 1);
+    auto set = [](int x) { return x == 1; };
+    m.push_back_row(0.1, all.begin(), all.end(), set);
+    m.push_back_row(0.2, half.begin(), half.end(), set);
+    BOOST_REQUIRE_EQUAL(fwdpp::allele_counts(m)[0], 70);
+    BOOST_REQUIRE_EQUAL(fwdpp::allele_counts(m)[1], 35);
+    // Unused bits in the last word are 0
+    BOOST_REQUIRE_EQUAL(m.row(0)[1], (std::uint64_t{1} << 6) - 1);
+    auto ld = fwdpp::pairwise_ld(m, 0, 1);
+    BOOST_REQUIRE_EQUAL(ld.D, 0.);
+    BOOST_REQUIRE(std::isnan(ld.rsq));
+    BOOST_REQUIRE_THROW(m.push_back_row(0.3, all.begin(), all.end() - 1, set),
+                        std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,137 @@
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <boost/test/unit_test.hpp>
+#include <fwdpp/ts/std_table_collection.hpp>
+#include <fwdpp/ts/simplify_tables.hpp>
+#include "wfevolve_table_collection.hpp"
+
+namespace
+{
+    struct simplified_tables_fixture
+    // Evolve without simplifying, then simplify
+    // once to fill the simplifier's edge ranges.
+    {
+        fwdpp::ts::std_table_collection tables;
+        fwdpp::ts::simplification::simplifier_internal_state<
+            fwdpp::ts::std_table_collection>
+            state;
+        std::vector<fwdpp::ts::table_index_t> samples, node_map;
+
+        simplified_tables_fixture() : tables(1.), state{}, samples{}, node_map{}
+        {
+            auto results = wfevolve_table_collection(42, 100, 200, 0., 10., 1000, false,
+                                                     false, true, empty_policies{},
+                                                     tables);
+            for (auto& p : results.alive_individuals)
+                {
+                    samples.push_back(p.nodes[0]);
+                    samples.push_back(p.nodes[1]);
+                }
+            fwdpp::ts::sort_edge_table(tables);
+            std::vector<std::size_t> preserved_variants;
+            fwdpp::ts::simplify_tables(samples, fwdpp::ts::simplification_flags{},
+                                       state, tables, node_map, preserved_variants);
+        }
+    };
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(test_parent_edge_ranges, simplified_tables_fixture)
+
+BOOST_AUTO_TEST_CASE(test_recorded_ranges)
+{
+    BOOST_REQUIRE(state.edge_ranges.describes(tables));
+    const auto null = std::numeric_limits<std::size_t>::max();
+    std::vector<std::size_t> starts(tables.num_nodes(), null),
+        stops(tables.num_nodes(), null);
+    for (std::size_t i = 0; i < tables.num_edges(); ++i)
+        {
+            auto p = tables.edges[i].parent;
+            if (starts[p] == null)
+                {
+                    starts[p] = i;
+                }
+            stops[p] = i;
+        }
+    for (std::size_t i = 0; i < tables.num_nodes(); ++i)
+        {
+            auto loc = state.edge_ranges[static_cast<fwdpp::ts::table_index_t>(i)];
+            BOOST_REQUIRE_EQUAL(loc.start, starts[i]);
+            BOOST_REQUIRE_EQUAL(loc.stop, stops[i]);
+        }
+}
+
+BOOST_AUTO_TEST_CASE(test_find_pre_existing_edges)
+{
+    // Give every node a new birth
+    fwdpp::ts::edge_buffer buffer;
+    buffer.reset(tables.num_nodes());
+    std::vector<fwdpp::ts::table_index_t> alive;
+    for (std::size_t i = 0; i < tables.num_nodes(); ++i)
+        {
+            auto n = static_cast<fwdpp::ts::table_index_t>(i);
+            alive.push_back(n);
+            buffer.extend(n, 0., 1., n);
+        }
+    auto scanned = fwdpp::ts::find_pre_existing_edges(tables, alive, buffer);
+    auto cached
+        = fwdpp::ts::find_pre_existing_edges(tables, alive, buffer, state.edge_ranges);
+    BOOST_REQUIRE_EQUAL(scanned.size(), cached.size());
+    for (std::size_t i = 0; i < scanned.size(); ++i)
+        {
+            BOOST_REQUIRE_EQUAL(scanned[i].parent, cached[i].parent);
+            BOOST_REQUIRE_EQUAL(scanned[i].start, cached[i].start);
+            BOOST_REQUIRE_EQUAL(scanned[i].stop, cached[i].stop);
+        }
+}
+
+BOOST_AUTO_TEST_CASE(test_stale_ranges)
+// If the edge table changes, the table is scanned.
+{
+    tables.edges.pop_back();
+    BOOST_REQUIRE(!state.edge_ranges.describes(tables));
+    fwdpp::ts::edge_buffer buffer;
+    buffer.reset(tables.num_nodes());
+    std::vector<fwdpp::ts::table_index_t> alive{tables.edges.back().parent};
+    buffer.extend(alive[0], 0., 1., alive[0]);
+    auto cached
+        = fwdpp::ts::find_pre_existing_edges(tables, alive, buffer, state.edge_ranges);
+    BOOST_REQUIRE_EQUAL(cached.size(), 1);
+    BOOST_REQUIRE_EQUAL(cached[0].stop, tables.num_edges() - 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_rows_changed_without_changing_length)
+// Ranges are rejected once rows are changed, even
+// though the number of edges is the same.
+{
+    auto first_parent = tables.edges.front().parent;
+    auto e = tables.edges.back();
+    tables.edges.pop_back();
+    tables.emplace_back_edge(e.left, e.right, e.parent, e.child);
+    BOOST_REQUIRE(!state.edge_ranges.describes(tables));
+
+    // Move the first parent's edges to the end of the table.
+    // Its cached range has the right length but the wrong location.
+    simplified_tables_fixture f;
+    auto& t = f.tables;
+    auto stop = static_cast<std::ptrdiff_t>(
+        f.state.edge_ranges[first_parent].stop);
+    std::rotate(begin(t.edges), begin(t.edges) + stop + 1, end(t.edges));
+    BOOST_REQUIRE(f.state.edge_ranges.describes(t));
+    t.clear_indexes();
+    BOOST_REQUIRE(!f.state.edge_ranges.describes(t));
+
+    fwdpp::ts::edge_buffer buffer;
+    buffer.reset(t.num_nodes());
+    std::vector<fwdpp::ts::table_index_t> alive{first_parent};
+    buffer.extend(first_parent, 0., 1., first_parent);
+    auto scanned = fwdpp::ts::find_pre_existing_edges(t, alive, buffer);
+    auto cached
+        = fwdpp::ts::find_pre_existing_edges(t, alive, buffer, f.state.edge_ranges);
+    BOOST_REQUIRE_EQUAL(cached.size(), 1);
+    BOOST_REQUIRE_EQUAL(cached[0].start, scanned[0].start);
+    BOOST_REQUIRE_EQUAL(cached[0].stop, scanned[0].stop);
+    BOOST_REQUIRE_EQUAL(cached[0].stop, t.num_edges() - 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,216 @@
+#include <sstream>
+#include <streambuf>
+#include <cstring>
+#include <stdexcept>
+#include <boost/test/unit_test.hpp>
+#include <fwdpp/ts/std_table_collection.hpp>
+#include <fwdpp/ts/compact_table_collection.hpp>
+#include <fwdpp/ts/table_collection_functions.hpp>
+#include <fwdpp/ts/serialization.hpp>
+#include <fwdpp/io/scalar_serialization.hpp>
+
+namespace
+{
+    struct serialization_fixture
+    {
+        fwdpp::ts::std_table_collection tables;
+        serialization_fixture() : tables(10.)
+        {
+            tables.push_back_node(2., 0);
+            tables.push_back_node(2., 1);
+            tables.push_back_node(1., 0);
+            tables.push_back_node(0., 1);
+            tables.push_back_edge(0., 5., 3, 2);
+            tables.push_back_edge(5., 10., 3, 1);
+            tables.push_back_edge(0., 5., 2, 0);
+            tables.push_back_edge(0., 5., 2, 1);
+            tables.push_back_edge(5., 10., 3, 0);
+            tables.emplace_back_site(2., fwdpp::ts::default_ancestral_state);
+            tables.emplace_back_mutation(2, 0lu, 0lu, fwdpp::ts::default_derived_state,
+                                         true);
+            tables.emplace_back_site(7., fwdpp::ts::default_ancestral_state);
+            tables.emplace_back_mutation(1, 1lu, 1lu, std::int8_t{2}, false);
+            tables.preserved_nodes.push_back(2);
+            tables.edge_offset = 3;
+            fwdpp::ts::sort_edge_table(tables);
+            tables.build_indexes();
+        }
+    };
+
+    template <typename T>
+    void
+    write_rows(std::ostream& o, const std::vector<T>& rows)
+    {
+        o.write(reinterpret_cast<const char*>(rows.data()), rows.size() * sizeof(T));
+    }
+
+    std::string
+    write_format_3(const fwdpp::ts::std_table_collection& tables)
+    // The layout written by fwdpp 0.8.0 and 0.9.x
+    {
+        std::ostringstream o;
+        fwdpp::io::scalar_writer sw;
+        o << "fwdppts";
+        const std::uint32_t format = 3;
+        sw(o, &format);
+        auto L = tables.genome_length();
+        sw(o, &L);
+        sw(o, &tables.edge_offset);
+        std::size_t n = tables.edges.size();
+        sw(o, &n);
+        n = tables.nodes.size();
+        sw(o, &n);
+        n = tables.mutations.size();
+        sw(o, &n);
+        n = tables.sites.size();
+        sw(o, &n);
+        write_rows(o, tables.edges);
+        write_rows(o, tables.nodes);
+        write_rows(o, tables.mutations);
+        write_rows(o, tables.sites);
+        n = tables.preserved_nodes.size();
+        sw(o, &n);
+        sw(o, tables.preserved_nodes.data(), n);
+        return o.str();
+    }
+
+    struct bounded_streambuf : public std::streambuf
+    // Accepts a fixed number of characters, then fails
+    {
+        std::size_t remaining;
+        explicit bounded_streambuf(std::size_t n) : remaining(n)
+        {
+        }
+
+        int_type
+        overflow(int_type c) override
+        {
+            if (remaining == 0 || traits_type::eq_int_type(c, traits_type::eof()))
+                {
+                    return traits_type::eof();
+                }
+            --remaining;
+            return c;
+        }
+    };
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(test_table_serialization, serialization_fixture)
+
+BOOST_AUTO_TEST_CASE(test_round_trip)
+{
+    std::ostringstream o;
+    fwdpp::ts::io::serialize_tables(o, tables);
+    std::istringstream i(o.str());
+    auto tables2
+        = fwdpp::ts::io::deserialize_tables<fwdpp::ts::std_table_collection>()(i);
+    BOOST_REQUIRE(tables == tables2);
+    BOOST_REQUIRE(tables2.indexed());
+    BOOST_REQUIRE_EQUAL(tables2.edge_offset, 3);
+}
+
+BOOST_AUTO_TEST_CASE(test_column_layout)
+{
+    std::ostringstream o;
+    fwdpp::ts::io::serialize_tables(o, tables);
+    std::istringstream i(o.str());
+    i.seekg(7);
+    fwdpp::io::scalar_reader sr;
+    std::uint32_t format;
+    sr(i, &format);
+    BOOST_REQUIRE_EQUAL(format, fwdpp::ts::io::TS_TABLES_VERSION);
+    BOOST_REQUIRE_EQUAL(format, 4);
+    double L;
+    sr(i, &L);
+    decltype(tables.edge_offset) edge_offset;
+    sr(i, &edge_offset);
+    // The edge table comes first, as left, right, parent, child
+    std::uint64_t nrows;
+    std::uint32_t ncols, element_size;
+    sr(i, &nrows);
+    sr(i, &ncols);
+    BOOST_REQUIRE_EQUAL(nrows, tables.edges.size());
+    BOOST_REQUIRE_EQUAL(ncols, 4);
+    sr(i, &element_size);
+    BOOST_REQUIRE_EQUAL(element_size, sizeof(double));
+    std::vector<double> left(nrows);
+    i.read(reinterpret_cast<char*>(left.data()), nrows * sizeof(double));
+    for (std::size_t j = 0; j < nrows; ++j)
+        {
+            BOOST_REQUIRE_EQUAL(left[j], tables.edges[j].left);
+        }
+}
+
+BOOST_AUTO_TEST_CASE(test_read_format_3)
+{
+    std::istringstream i(write_format_3(tables));
+    auto tables2
+        = fwdpp::ts::io::deserialize_tables<fwdpp::ts::std_table_collection>()(i);
+    BOOST_REQUIRE(tables == tables2);
+}
+
+BOOST_AUTO_TEST_CASE(test_compact_round_trip)
+{
+    std::ostringstream o;
+    fwdpp::ts::io::serialize_tables(o, tables);
+    std::istringstream i(o.str());
+    auto compact
+        = fwdpp::ts::io::deserialize_tables<fwdpp::ts::compact_table_collection>()(i);
+    BOOST_REQUIRE_EQUAL(compact.edges.size(), tables.edges.size());
+    BOOST_REQUIRE_EQUAL(compact.mutations.size(), tables.mutations.size());
+    std::ostringstream o2;
+    fwdpp::ts::io::serialize_tables(o2, compact);
+    std::istringstream i2(o2.str());
+    auto tables2
+        = fwdpp::ts::io::deserialize_tables<fwdpp::ts::std_table_collection>()(i2);
+    BOOST_REQUIRE(tables == tables2);
+}
+
+BOOST_AUTO_TEST_CASE(test_invalid_element_size)
+{
+    std::ostringstream o;
+    fwdpp::ts::io::serialize_tables(o, tables);
+    auto buffer = o.str();
+    // Offset of the element size of the first edge column
+    const auto offset = 7 + sizeof(std::uint32_t) + sizeof(double)
+                        + sizeof(tables.edge_offset) + sizeof(std::uint64_t)
+                        + sizeof(std::uint32_t);
+    const std::uint32_t bad = 3;
+    std::memcpy(&buffer[offset], &bad, sizeof(bad));
+    std::istringstream i(buffer);
+    BOOST_REQUIRE_THROW(
+        fwdpp::ts::io::deserialize_tables<fwdpp::ts::std_table_collection>()(i),
+        std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_truncated_input)
+{
+    std::ostringstream o;
+    fwdpp::ts::io::serialize_tables(o, tables);
+    auto buffer = o.str();
+    buffer.resize(buffer.size() / 2);
+    std::istringstream i(buffer);
+    BOOST_REQUIRE_THROW(
+        fwdpp::ts::io::deserialize_tables<fwdpp::ts::std_table_collection>()(i),
+        std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_failed_write)
+{
+    std::ostringstream o;
+    fwdpp::ts::io::serialize_tables(o, tables);
+    const auto size = o.str().size();
+    // Fail within the edge table and within the trailing preserved nodes
+    for (auto n : {std::size_t{64}, size - 1})
+        {
+            bounded_streambuf buffer(n);
+            std::ostream bounded(&buffer);
+            BOOST_REQUIRE_THROW(fwdpp::ts::io::serialize_tables(bounded, tables),
+                                std::runtime_error);
+        }
+    bounded_streambuf buffer(size);
+    std::ostream bounded(&buffer);
+    BOOST_REQUIRE_NO_THROW(fwdpp::ts::io::serialize_tables(bounded, tables));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
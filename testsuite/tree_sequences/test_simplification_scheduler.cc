@@ -0,0 +1,216 @@
+#include <stdexcept>
+#include <boost/test/unit_test.hpp>
+#include <fwdpp/ts/std_table_collection.hpp>
+#include <fwdpp/ts/columnar_table_collection.hpp>
+#include <fwdpp/ts/mmap_table_collection.hpp>
+#include <fwdpp/ts/simplification_scheduler.hpp>
+#include <fwdpp/ts/recording/edge_buffer.hpp>
+
+namespace
+{
+    struct scheduler_fixture
+    {
+        fwdpp::ts::std_table_collection tables;
+        scheduler_fixture() : tables(1.)
+        {
+        }
+
+        void
+        add_edges(std::size_t n)
+        // Reserving exactly keeps memory use predictable
+        {
+            tables.edges.reserve(tables.edges.size() + n);
+            for (std::size_t i = 0; i < n; ++i)
+                {
+                    tables.push_back_edge(0., 1., 0, 1);
+                }
+        }
+
+        void
+        simplify_to(std::size_t n)
+        {
+            tables.edges.resize(n);
+        }
+    };
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(test_simplification_scheduler, scheduler_fixture)
+
+BOOST_AUTO_TEST_CASE(test_invalid_parameters)
+{
+    BOOST_REQUIRE_THROW(fwdpp::ts::simplification_scheduler(0, 10, 0),
+                        std::invalid_argument);
+    BOOST_REQUIRE_THROW(fwdpp::ts::simplification_scheduler(10, 5, 0),
+                        std::invalid_argument);
+    BOOST_REQUIRE_THROW(fwdpp::ts::simplification_scheduler(1, 5, 0, 0.),
+                        std::invalid_argument);
+    BOOST_REQUIRE_THROW(fwdpp::ts::simplification_scheduler(1, 5, 0, 1.),
+                        std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(test_min_interval_and_edge_growth)
+{
+    fwdpp::ts::simplification_scheduler s(3, 100, 0);
+    add_edges(10);
+    BOOST_REQUIRE(!s.should_simplify(1, tables));
+    BOOST_REQUIRE(!s.should_simplify(2, tables));
+    BOOST_REQUIRE(s.should_simplify(3, tables));
+    BOOST_REQUIRE(s.decisions().back().reason
+                  == fwdpp::ts::simplification_reason::edge_growth);
+    BOOST_REQUIRE_EQUAL(s.decisions().back().edges_before, 10);
+    simplify_to(5);
+    // An overhead between half the target and the
+    // target does not change the growth factor
+    s.record_simplification(tables, 1., 0.08);
+    BOOST_REQUIRE_EQUAL(s.growth_factor(), 2.);
+    BOOST_REQUIRE_EQUAL(s.decisions().back().edges_after, 5);
+
+    add_edges(4);
+    BOOST_REQUIRE(!s.should_simplify(6, tables));
+    add_edges(1);
+    BOOST_REQUIRE(s.should_simplify(7, tables));
+    BOOST_REQUIRE_EQUAL(s.decisions().size(), 2);
+    BOOST_REQUIRE_EQUAL(s.decisions().back().interval, 4);
+}
+
+BOOST_AUTO_TEST_CASE(test_max_interval)
+{
+    fwdpp::ts::simplification_scheduler s(1, 5, 0);
+    add_edges(10);
+    BOOST_REQUIRE(s.should_simplify(1, tables));
+    s.record_simplification(tables, 1., 0.1);
+    // The edge table does not grow, so only the
+    // maximum interval triggers simplification
+    for (std::uint32_t g = 2; g < 6; ++g)
+        {
+            BOOST_REQUIRE(!s.should_simplify(g, tables));
+        }
+    BOOST_REQUIRE(s.should_simplify(6, tables));
+    BOOST_REQUIRE(s.decisions().back().reason
+                  == fwdpp::ts::simplification_reason::max_interval);
+}
+
+BOOST_AUTO_TEST_CASE(test_memory_usage)
+// Each backend reports the memory it allocates
+{
+    add_edges(100);
+    BOOST_REQUIRE_EQUAL(tables.memory_usage(),
+                        100 * sizeof(fwdpp::ts::std_table_collection::edge_t));
+
+    fwdpp::ts::columnar_table_collection columnar_tables(1.);
+    columnar_tables.edges.reserve(100);
+    // left, right, parent and child columns
+    BOOST_REQUIRE_EQUAL(columnar_tables.memory_usage(),
+                        100 * (2 * sizeof(double) + 2 * sizeof(std::int32_t)));
+
+    fwdpp::ts::mmap_table_collection mmap_tables(1.);
+    BOOST_REQUIRE_EQUAL(mmap_tables.memory_usage(), 0);
+    mmap_tables.push_back_edge(0., 1., 0, 1);
+    BOOST_REQUIRE_EQUAL(mmap_tables.memory_usage(),
+                        mmap_tables.edges.capacity() * sizeof(fwdpp::ts::edge));
+    BOOST_REQUIRE(mmap_tables.memory_usage() > 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_memory_budget)
+{
+    const auto edge_bytes = sizeof(fwdpp::ts::std_table_collection::edge_t);
+    fwdpp::ts::simplification_scheduler s(10, 100, 100 * edge_bytes);
+    add_edges(40);
+    BOOST_REQUIRE(!s.should_simplify(1, tables));
+    // 80 edges after 2 generations, with 40 more expected
+    // in the next generation, exceeds the budget
+    add_edges(40);
+    BOOST_REQUIRE(s.should_simplify(2, tables));
+    BOOST_REQUIRE(s.decisions().back().reason
+                  == fwdpp::ts::simplification_reason::memory_budget);
+    BOOST_REQUIRE_EQUAL(s.decisions().back().bytes_before, 80 * edge_bytes);
+}
+
+BOOST_AUTO_TEST_CASE(test_overhead_adaptation)
+{
+    fwdpp::ts::simplification_scheduler s(1, 1000, 0, 0.1);
+    add_edges(10);
+    BOOST_REQUIRE(s.should_simplify(1, tables));
+    // 50% overhead: the next interval should be longer,
+    // by no more than the maximum step
+    s.record_simplification(tables, 1., 1.);
+    BOOST_REQUIRE_EQUAL(s.growth_factor(), 2. * s.max_growth_step());
+    BOOST_REQUIRE_EQUAL(s.decisions().back().growth_factor, s.growth_factor());
+    add_edges(20);
+    BOOST_REQUIRE(s.should_simplify(2, tables));
+    // 1% overhead: the next interval should be shorter
+    s.record_simplification(tables, 99., 1.);
+    BOOST_REQUIRE_CLOSE(s.growth_factor(), 2., 1e-8);
+    add_edges(30);
+    BOOST_REQUIRE(s.should_simplify(3, tables));
+    // 12.5% overhead: the step is proportional to
+    // the ratio of overhead to target
+    s.record_simplification(tables, 7., 1.);
+    BOOST_REQUIRE_CLOSE(s.growth_factor(), 2.5, 1e-8);
+    add_edges(100);
+    BOOST_REQUIRE(s.should_simplify(4, tables));
+    // No time spent simplifying
+    s.record_simplification(tables, 1., 0.);
+    BOOST_REQUIRE_CLOSE(s.growth_factor(), 2.5 / s.max_growth_step(), 1e-8);
+    add_edges(110);
+    BOOST_REQUIRE(s.should_simplify(5, tables));
+    s.record_simplification(tables, 1., 0.);
+    BOOST_REQUIRE_EQUAL(s.growth_factor(), 1.5);
+}
+
+BOOST_AUTO_TEST_CASE(test_edge_buffer)
+// New edges are in a buffer, so the edge table does not grow
+{
+    fwdpp::ts::edge_buffer buffer;
+    buffer.reset(2);
+    fwdpp::ts::simplification_scheduler s(1, 100, 0);
+    add_edges(10);
+    BOOST_REQUIRE(s.should_simplify(1, tables, buffer));
+    s.record_simplification(tables, buffer, 1., 0.08);
+    BOOST_REQUIRE_EQUAL(s.decisions().back().edges_after, 10);
+    for (int i = 0; i < 10; ++i)
+        {
+            buffer.extend(0, 0., 1., 1);
+        }
+    BOOST_REQUIRE(!s.should_simplify(2, tables));
+    BOOST_REQUIRE(s.should_simplify(2, tables, buffer));
+    BOOST_REQUIRE(s.decisions().back().reason
+                  == fwdpp::ts::simplification_reason::edge_growth);
+    BOOST_REQUIRE_EQUAL(s.decisions().back().edges_before, 20);
+    BOOST_REQUIRE_EQUAL(s.decisions().back().bytes_before,
+                        tables.memory_usage() + buffer.memory_usage());
+    bool called = false;
+    s.timed_simplification(tables, buffer, [&]() {
+        buffer.reset(2);
+        called = true;
+    });
+    BOOST_REQUIRE(called);
+    BOOST_REQUIRE_EQUAL(s.decisions().back().edges_after, 10);
+
+    // The buffer's memory counts towards the budget
+    fwdpp::ts::simplification_scheduler budget(10, 100, tables.memory_usage() + 1000);
+    for (int i = 0; i < 100; ++i)
+        {
+            buffer.extend(1, 0., 1., 0);
+        }
+    BOOST_REQUIRE(!budget.should_simplify(1, tables));
+    BOOST_REQUIRE(budget.should_simplify(1, tables, buffer));
+    BOOST_REQUIRE(budget.decisions().back().reason
+                  == fwdpp::ts::simplification_reason::memory_budget);
+}
+
+BOOST_AUTO_TEST_CASE(test_call_order)
+{
+    fwdpp::ts::simplification_scheduler s(1, 1000, 0);
+    BOOST_REQUIRE_THROW(s.record_simplification(tables, 1., 1.), std::runtime_error);
+    add_edges(10);
+    BOOST_REQUIRE(s.should_simplify(1, tables));
+    BOOST_REQUIRE_THROW(s.should_simplify(2, tables), std::runtime_error);
+    bool called = false;
+    s.timed_simplification(tables, [&called]() { called = true; });
+    BOOST_REQUIRE(called);
+    BOOST_REQUIRE_EQUAL(s.decisions().size(), 1);
+    BOOST_REQUIRE_THROW(s.should_simplify(0, tables), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -1,3 +1,4 @@
+#include <vector>
 #include <iostream>
 #include <algorithm>
 #include <fwdpp/ts/site_visitor.hpp>
@@ -20,5 +21,52 @@ BOOST_FIXTURE_TEST_CASE(test_simple_iteration, simple_table_collection_infinite_
     BOOST_REQUIRE_EQUAL(num_sites, tables.sites.size());
 }
 
+BOOST_FIXTURE_TEST_CASE(test_sample_lists_of_current_tree,
+                        simple_table_collection_infinite_sites)
+// The sample lists of current_tree() are public,
+// so they must be up to date without going through
+// fwdpp::ts::samples_iterator.
+{
+    fwdpp::ts::site_visitor<fwdpp::ts::std_table_collection> sv(tables, samples);
+    decltype(sv()) i;
+    while ((i = sv()) != end(sv))
+        {
+            const auto& t = sv.current_tree();
+            auto mr = sv.get_mutations();
+            for (auto m = mr.first; m < mr.second; ++m)
+                {
+                    std::vector<fwdpp::ts::table_index_t> from_list, expected;
+                    auto s = t.left_sample[m->node];
+                    if (s != fwdpp::ts::NULL_INDEX)
+                        {
+                            while (true)
+                                {
+                                    from_list.push_back(t.sample_table_index_to_node(s));
+                                    if (s == t.right_sample[m->node])
+                                        {
+                                            break;
+                                        }
+                                    s = t.next_sample[s];
+                                }
+                        }
+                    for (auto u : samples)
+                        {
+                            for (auto v = u; v != fwdpp::ts::NULL_INDEX;
+                                 v = t.parents[v])
+                                {
+                                    if (v == m->node)
+                                        {
+                                            expected.push_back(u);
+                                            break;
+                                        }
+                                }
+                        }
+                    std::sort(begin(from_list), end(from_list));
+                    std::sort(begin(expected), end(expected));
+                    BOOST_REQUIRE(from_list == expected);
+                }
+        }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -0,0 +1,145 @@
+#include <random>
+#include <numeric>
+#include <vector>
+#include <algorithm>
+#include <boost/test/unit_test.hpp>
+#include <fwdpp/ts/std_table_collection.hpp>
+#include <fwdpp/ts/generate_data_matrix.hpp>
+#include <fwdpp/sparse_data_matrix.hpp>
+#include "wfevolve_table_collection.hpp"
+
+namespace
+{
+    struct wf_sparse_matrix_fixture
+    {
+        fwdpp::ts::std_table_collection tables;
+        std::vector<fwdpp::ts::table_index_t> samples;
+
+        wf_sparse_matrix_fixture() : tables(1.), samples(200)
+        {
+            wfevolve_table_collection(42, 100, 500, 0., 10., 50, false, false, false,
+                                      empty_policies{}, tables);
+            tables.build_indexes();
+            std::iota(begin(samples), end(samples), 0);
+            std::mt19937 rng(31);
+            std::uniform_int_distribution<std::size_t> pick(0, tables.edges.size() - 1);
+            std::uniform_real_distribution<double> uniform(0., 1.);
+            std::vector<std::pair<double, std::size_t>> positions;
+            for (int i = 0; i < 100; ++i)
+                {
+                    auto e = pick(rng);
+                    const auto& edge = tables.edges[e];
+                    positions.emplace_back(
+                        edge.left + uniform(rng) * (edge.right - edge.left), e);
+                }
+            std::sort(begin(positions), end(positions));
+            for (std::size_t i = 0; i < positions.size(); ++i)
+                {
+                    const auto& edge = tables.edges[positions[i].second];
+                    auto s = tables.emplace_back_site(positions[i].first,
+                                                      fwdpp::ts::default_ancestral_state);
+                    const bool neutral = i % 4 != 0;
+                    tables.emplace_back_mutation(edge.parent, i, s,
+                                                 fwdpp::ts::default_derived_state,
+                                                 neutral);
+                    if (i % 10 == 0)
+                        {
+                            // A nested mutation: a back mutation or a third state
+                            const auto state = static_cast<std::int8_t>(i % 20 == 0 ? 0 : 2);
+                            tables.emplace_back_mutation(edge.child, i, s, state,
+                                                         neutral);
+                        }
+                }
+        }
+    };
+
+    void
+    require_equal(const fwdpp::state_matrix& dense,
+                  const fwdpp::sparse_state_matrix& sparse)
+    {
+        BOOST_REQUIRE_EQUAL(sparse.row_offsets.size(), sparse.nrow() + 1);
+        for (std::size_t i = 0; i < sparse.nrow(); ++i)
+            {
+                BOOST_REQUIRE(std::is_sorted(
+                    sparse.columns.begin() + sparse.row_offsets[i],
+                    sparse.columns.begin() + sparse.row_offsets[i + 1]));
+            }
+        auto u = fwdpp::unpack(sparse);
+        BOOST_REQUIRE(u.positions == dense.positions);
+        BOOST_REQUIRE(u.data == dense.data);
+    }
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(test_sparse_data_matrix, wf_sparse_matrix_fixture)
+
+BOOST_AUTO_TEST_CASE(test_same_as_dense)
+{
+    for (bool skip_fixed : {false, true})
+        {
+            auto dm = fwdpp::ts::generate_data_matrix(tables, samples, true, true,
+                                                      skip_fixed);
+            auto sm = fwdpp::ts::generate_sparse_data_matrix(tables, samples, true,
+                                                             true, skip_fixed);
+            BOOST_REQUIRE_EQUAL(sm.ncol, dm.ncol);
+            BOOST_REQUIRE(!dm.selected.positions.empty());
+            BOOST_REQUIRE(sm.neutral_keys == dm.neutral_keys);
+            BOOST_REQUIRE(sm.selected_keys == dm.selected_keys);
+            require_equal(dm.neutral, sm.neutral);
+            require_equal(dm.selected, sm.selected);
+        }
+}
+
+BOOST_AUTO_TEST_CASE(test_multithreaded)
+{
+    auto dm = fwdpp::ts::generate_data_matrix(tables, samples, true, true, false, 0.2,
+                                              0.9);
+    auto sm = fwdpp::ts::generate_sparse_data_matrix(tables, samples, true, true,
+                                                     false, 0.2, 0.9, 6);
+    require_equal(dm.neutral, sm.neutral);
+    require_equal(dm.selected, sm.selected);
+    BOOST_REQUIRE(sm.neutral_keys == dm.neutral_keys);
+}
+
+BOOST_AUTO_TEST_CASE(test_row_sums)
+{
+    auto dm = fwdpp::ts::generate_data_matrix(tables, samples, true, true, false);
+    auto sm = fwdpp::ts::generate_sparse_data_matrix(tables, samples, true, true, false);
+    auto counts = fwdpp::row_sums(sm);
+    BOOST_REQUIRE_EQUAL(counts.first.size(), dm.neutral.positions.size());
+    for (std::size_t i = 0; i < counts.first.size(); ++i)
+        {
+            auto first = dm.neutral.data.begin() + i * dm.ncol;
+            BOOST_REQUIRE_EQUAL(counts.first[i],
+                                dm.ncol - std::count(first, first + dm.ncol, 0));
+        }
+    // Storage is proportional to the number of derived alleles
+    BOOST_REQUIRE_EQUAL(sm.neutral.columns.size(),
+                        std::accumulate(begin(counts.first), end(counts.first), 0u));
+}
+
+BOOST_AUTO_TEST_CASE(test_single_mutation_to_ancestral_state)
+{
+    // Site 1 has one mutation.  Give it the ancestral state.
+    std::size_t m = 0;
+    while (tables.mutations[m].site != 1)
+        {
+            ++m;
+        }
+    BOOST_REQUIRE(m + 1 == tables.mutations.size() || tables.mutations[m + 1].site != 1);
+    tables.mutations[m].derived_state = tables.sites[1].ancestral_state;
+    auto dm = fwdpp::ts::generate_data_matrix(tables, samples, true, true, false);
+    auto sm = fwdpp::ts::generate_sparse_data_matrix(tables, samples, true, true, false);
+    require_equal(dm.neutral, sm.neutral);
+    require_equal(dm.selected, sm.selected);
+    auto& rows = tables.mutations[m].neutral ? sm.neutral : sm.selected;
+    auto& keys = tables.mutations[m].neutral ? sm.neutral_keys : sm.selected_keys;
+    auto row = std::find(begin(keys), end(keys), tables.mutations[m].key) - begin(keys);
+    BOOST_REQUIRE(static_cast<std::size_t>(row) < keys.size());
+    BOOST_REQUIRE_EQUAL(rows.row_offsets[row + 1] - rows.row_offsets[row], 0);
+    for (auto state : rows.states)
+        {
+            BOOST_REQUIRE(state != tables.sites[1].ancestral_state);
+        }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,104 @@
+#include <vector>
+#include <algorithm>
+#include <boost/test/unit_test.hpp>
+#include <fwdpp/ts/std_table_collection.hpp>
+#include <fwdpp/ts/simplify_tables.hpp>
+#include "wfevolve_table_collection.hpp"
+
+namespace
+{
+    template <typename TableCollectionType>
+    void
+    stitch_by_copying(const std::vector<fwdpp::ts::table_index_t>& alive_at_last_simplification,
+                      double max_time, fwdpp::ts::edge_buffer& new_edges,
+                      TableCollectionType& tables)
+    // Reference implementation that copies the whole edge table
+    {
+        typename TableCollectionType::edge_table edge_liftover;
+        fwdpp::ts::copy_births_since_last_simplification(new_edges, tables, max_time,
+                                                         edge_liftover);
+        auto existing_edges = fwdpp::ts::find_pre_existing_edges(
+            tables, alive_at_last_simplification, new_edges);
+        auto offset = fwdpp::ts::handle_pre_existing_edges(tables, new_edges,
+                                                          existing_edges, edge_liftover);
+        for (; offset < tables.num_edges(); ++offset)
+            {
+                edge_liftover.emplace_back(tables.edges[offset]);
+            }
+        tables.edges.assign(begin(edge_liftover), end(edge_liftover));
+        new_edges.reset(tables.num_nodes());
+    }
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(test_stitch_together_edges)
+
+BOOST_AUTO_TEST_CASE(test_in_place_stitching_matches_copying)
+// Overlapping generations, so that parents alive at
+// the last simplification have both old edges and births.
+{
+    const unsigned N = 100;
+    fwdpp::GSLrng_mt rng(666);
+    fwdpp::ts::std_table_collection tables(1.);
+    fwdpp::ts::edge_buffer buffer;
+    auto state = fwdpp::ts::make_simplifier_state(tables);
+    std::vector<parent> parents;
+    for (unsigned i = 0; i < N; ++i)
+        {
+            auto id0 = tables.emplace_back_node(0, 0.);
+            auto id1 = tables.emplace_back_node(0, 0.);
+            parents.emplace_back(i, id0, id1);
+        }
+    std::vector<fwdpp::ts::table_index_t> alive_at_last_simplification(
+        tables.num_nodes());
+    std::iota(begin(alive_at_last_simplification), end(alive_at_last_simplification),
+              0);
+    std::vector<birth> births;
+    std::vector<double> breakpoints;
+    std::vector<fwdpp::ts::table_index_t> samples, node_map;
+    std::vector<std::size_t> preserved_variants;
+    for (unsigned step = 1; step <= 200; ++step)
+        {
+            deaths_and_parents(rng, parents, 0.5, births);
+            generate_births(rng, births, 10. / (4. * N), breakpoints, step, true, buffer,
+                            parents, tables);
+            if (step % 10 == 0)
+                {
+                    double max_time = -1;
+                    for (auto a : alive_at_last_simplification)
+                        {
+                            max_time = std::max(max_time, tables.nodes[a].time);
+                        }
+                    auto copied_tables = tables;
+                    auto copied_buffer = buffer;
+                    stitch_by_copying(alive_at_last_simplification, max_time,
+                                      copied_buffer, copied_tables);
+                    auto in_place_tables = tables;
+                    auto in_place_buffer = buffer;
+                    fwdpp::ts::stitch_together_edges(alive_at_last_simplification,
+                                                     max_time, in_place_buffer,
+                                                     in_place_tables);
+                    BOOST_REQUIRE(copied_tables.edges == in_place_tables.edges);
+
+                    samples.clear();
+                    for (auto& p : parents)
+                        {
+                            samples.push_back(p.nodes[0]);
+                            samples.push_back(p.nodes[1]);
+                        }
+                    fwdpp::ts::simplify_tables(samples, alive_at_last_simplification,
+                                               fwdpp::ts::simplification_flags{}, state,
+                                               tables, buffer, node_map,
+                                               preserved_variants);
+                    alive_at_last_simplification.clear();
+                    for (auto& p : parents)
+                        {
+                            p.nodes[0] = node_map[p.nodes[0]];
+                            p.nodes[1] = node_map[p.nodes[1]];
+                            alive_at_last_simplification.push_back(p.nodes[0]);
+                            alive_at_last_simplification.push_back(p.nodes[1]);
+                        }
+                }
+        }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -1,4 +1,7 @@
 #include <iostream>
+#include <random>
+#include <numeric>
+#include <algorithm>
 #include <boost/test/unit_test.hpp>
 #include <fwdpp/ts/std_table_collection.hpp>
 #include <fwdpp/ts/table_collection_functions.hpp>
@@ -44,3 +47,131 @@ BOOST_AUTO_TEST_CASE(
 
 BOOST_AUTO_TEST_SUITE_END()
 
+
+namespace
+{
+    struct random_edge_table_fixture
+    // Many nodes share a birth time, so that ties in time are
+    // broken by parent, child, and left.  left is unique.
+    {
+        fwdpp::ts::std_table_collection tables;
+        random_edge_table_fixture() : tables(1e6)
+        {
+            std::mt19937 generator(101);
+            std::uniform_int_distribution<int> time(0, 99);
+            for (int i = 0; i < 5000; ++i)
+                {
+                    tables.push_back_node(time(generator), 0);
+                }
+            std::uniform_int_distribution<fwdpp::ts::table_index_t> node(0, 4999);
+            for (int i = 0; i < 200000; ++i)
+                {
+                    double left = 1e6 * static_cast<double>(i) / 200000.;
+                    tables.push_back_edge(left, 1e6, node(generator), node(generator));
+                }
+            std::shuffle(begin(tables.edges), end(tables.edges), generator);
+        }
+
+        void
+        check_indexes() const
+        // The radix sort is stable, so stable_sort
+        // gives the same indexes.
+        {
+            std::vector<fwdpp::ts::table_index_t> I(tables.edges.size()),
+                O(tables.edges.size());
+            std::iota(begin(I), end(I), 0);
+            std::iota(begin(O), end(O), 0);
+            const auto& edges = tables.edges;
+            const auto& nodes = tables.nodes;
+            std::stable_sort(begin(I), end(I), [&](auto i, auto j) {
+                if (edges[i].left == edges[j].left)
+                    {
+                        return nodes[edges[i].parent].time > nodes[edges[j].parent].time;
+                    }
+                return edges[i].left < edges[j].left;
+            });
+            std::stable_sort(begin(O), end(O), [&](auto i, auto j) {
+                if (edges[i].right == edges[j].right)
+                    {
+                        return nodes[edges[i].parent].time < nodes[edges[j].parent].time;
+                    }
+                return edges[i].right < edges[j].right;
+            });
+            BOOST_REQUIRE(I == tables.input_left);
+            BOOST_REQUIRE(O == tables.output_right);
+        }
+    };
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(test_edge_table_sorting, random_edge_table_fixture)
+
+BOOST_AUTO_TEST_CASE(test_sort_edge_table)
+{
+    for (unsigned num_threads : {1u, 4u})
+        {
+            auto expected = tables.edges;
+            std::sort(begin(expected), end(expected),
+                      fwdpp::ts::get_edge_sort_cmp(tables));
+            auto t = tables;
+            fwdpp::ts::sort_edge_table(0, t, num_threads);
+            BOOST_REQUIRE(t.edges == expected);
+            BOOST_REQUIRE(fwdpp::ts::edge_table_strictly_sorted(t));
+        }
+}
+
+BOOST_AUTO_TEST_CASE(test_sort_edge_table_with_offset)
+{
+    const std::ptrdiff_t offset = 1234;
+    auto expected = tables.edges;
+    std::sort(begin(expected) + offset, end(expected),
+              fwdpp::ts::get_edge_sort_cmp(tables));
+    std::rotate(begin(expected), begin(expected) + offset, end(expected));
+    fwdpp::ts::sort_edge_table(offset, tables, 2);
+    BOOST_REQUIRE(tables.edges == expected);
+}
+
+BOOST_AUTO_TEST_CASE(test_build_indexes)
+{
+    fwdpp::ts::sort_edge_table(tables);
+    tables.build_indexes();
+    check_indexes();
+    tables.build_indexes(4);
+    check_indexes();
+}
+
+BOOST_AUTO_TEST_CASE(test_update_indexes)
+{
+    auto nedges = tables.edges.size();
+    std::vector<fwdpp::ts::edge> new_edges(tables.edges.begin() + nedges / 2,
+                                           tables.edges.end());
+    tables.edges.resize(nedges / 2);
+    tables.build_indexes();
+    BOOST_REQUIRE(tables.indexed());
+    // Add the rest of the edges in two batches
+    tables.edges.insert(end(tables.edges), begin(new_edges),
+                        begin(new_edges) + new_edges.size() / 3);
+    BOOST_REQUIRE(!tables.indexed());
+    tables.update_indexes();
+    check_indexes();
+    tables.edges.insert(end(tables.edges), begin(new_edges) + new_edges.size() / 3,
+                        end(new_edges));
+    tables.update_indexes(4);
+    check_indexes();
+    // No new edges
+    tables.update_indexes();
+    check_indexes();
+}
+
+BOOST_AUTO_TEST_CASE(test_update_indexes_after_sorting)
+// Sorting rewrites the edge table, so
+// the indexes must be rebuilt.
+{
+    tables.build_indexes();
+    fwdpp::ts::sort_edge_table(tables);
+    BOOST_REQUIRE(tables.input_left.empty());
+    BOOST_REQUIRE(tables.output_right.empty());
+    tables.update_indexes();
+    check_indexes();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,161 @@
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+#include <boost/test/unit_test.hpp>
+#include <fwdpp/ts/std_table_collection.hpp>
+#include <fwdpp/ts/tree_visitor.hpp>
+#include "wfevolve_table_collection.hpp"
+
+namespace
+{
+    struct tree_state
+    // The parts of a marginal_tree that do not depend
+    // on the order in which edges were added.
+    {
+        double left, right;
+        std::vector<fwdpp::ts::table_index_t> parents, leaf_counts, roots;
+        std::vector<std::vector<fwdpp::ts::table_index_t>> samples_below;
+
+        explicit tree_state(const fwdpp::ts::marginal_tree& m)
+            : left(m.left), right(m.right), parents(m.parents),
+              leaf_counts(m.leaf_counts), roots{}, samples_below(m.size())
+        {
+            for (auto r = m.left_root; r != fwdpp::ts::NULL_INDEX; r = m.right_sib[r])
+                {
+                    roots.push_back(r);
+                }
+            std::sort(begin(roots), end(roots));
+            for (std::size_t u = 0; u < m.size(); ++u)
+                {
+                    auto i = m.left_sample[u];
+                    if (i == fwdpp::ts::NULL_INDEX)
+                        {
+                            continue;
+                        }
+                    while (true)
+                        {
+                            samples_below[u].push_back(i);
+                            if (i == m.right_sample[u])
+                                {
+                                    break;
+                                }
+                            i = m.next_sample[i];
+                        }
+                    std::sort(begin(samples_below[u]), end(samples_below[u]));
+                }
+        }
+
+        bool
+        operator==(const tree_state& other) const
+        {
+            return left == other.left && right == other.right
+                   && parents == other.parents && leaf_counts == other.leaf_counts
+                   && roots == other.roots && samples_below == other.samples_below;
+        }
+    };
+
+    struct wf_seek_fixture
+    {
+        fwdpp::ts::std_table_collection tables;
+        std::vector<fwdpp::ts::table_index_t> samples;
+        std::vector<tree_state> forward;
+
+        wf_seek_fixture() : tables(1.), samples(200), forward{}
+        {
+            wfevolve_table_collection(42, 100, 500, 0., 10., 50, false, false, false,
+                                      empty_policies{}, tables);
+            tables.build_indexes();
+            std::iota(begin(samples), end(samples), 0);
+            auto tv = visitor();
+            while (tv())
+                {
+                    forward.emplace_back(tv.tree());
+                }
+        }
+
+        fwdpp::ts::tree_visitor<fwdpp::ts::std_table_collection>
+        visitor() const
+        {
+            return fwdpp::ts::tree_visitor<fwdpp::ts::std_table_collection>(
+                tables, samples, fwdpp::ts::update_samples_list(true));
+        }
+    };
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(test_tree_visitor_seek, wf_seek_fixture)
+
+BOOST_AUTO_TEST_CASE(test_multiple_trees)
+{
+    BOOST_REQUIRE(forward.size() > 10);
+    BOOST_REQUIRE_EQUAL(forward.front().left, 0.);
+    BOOST_REQUIRE_EQUAL(forward.back().right, 1.);
+}
+
+BOOST_AUTO_TEST_CASE(test_seek_to_each_tree)
+{
+    auto tv = visitor();
+    // Seek in reverse order, so that each seek
+    // starts from a different tree.
+    for (auto i = forward.rbegin(); i != forward.rend(); ++i)
+        {
+            tv.seek((i->left + i->right) / 2.);
+            BOOST_REQUIRE(tree_state(tv.tree()) == *i);
+            tv.seek(i->left);
+            BOOST_REQUIRE(tree_state(tv.tree()) == *i);
+        }
+}
+
+BOOST_AUTO_TEST_CASE(test_advance_after_seek)
+{
+    auto tv = visitor();
+    const auto start = forward.size() / 2;
+    tv.seek(forward[start].left);
+    for (auto i = start + 1; i < forward.size(); ++i)
+        {
+            BOOST_REQUIRE(tv());
+            BOOST_REQUIRE(tree_state(tv.tree()) == forward[i]);
+        }
+    BOOST_REQUIRE(!tv());
+}
+
+BOOST_AUTO_TEST_CASE(test_prev)
+{
+    auto tv = visitor();
+    BOOST_REQUIRE(!tv.prev());
+    while (tv())
+        {
+        }
+    BOOST_REQUIRE(tree_state(tv.tree()) == forward.back());
+    for (auto i = forward.size() - 1; i > 0; --i)
+        {
+            BOOST_REQUIRE(tv.prev());
+            BOOST_REQUIRE(tree_state(tv.tree()) == forward[i - 1]);
+        }
+    BOOST_REQUIRE(!tv.prev());
+    BOOST_REQUIRE(tree_state(tv.tree()) == forward.front());
+    // Direction can change at any tree
+    BOOST_REQUIRE(tv());
+    BOOST_REQUIRE(tree_state(tv.tree()) == forward[1]);
+    BOOST_REQUIRE(tv());
+    BOOST_REQUIRE(tv.prev());
+    BOOST_REQUIRE(tree_state(tv.tree()) == forward[1]);
+}
+
+BOOST_AUTO_TEST_CASE(test_seek_then_prev)
+{
+    auto tv = visitor();
+    const auto start = forward.size() / 3;
+    tv.seek(forward[start].left);
+    BOOST_REQUIRE(tv.prev());
+    BOOST_REQUIRE(tree_state(tv.tree()) == forward[start - 1]);
+}
+
+BOOST_AUTO_TEST_CASE(test_seek_out_of_range)
+{
+    auto tv = visitor();
+    BOOST_REQUIRE_THROW(tv.seek(-0.1), std::invalid_argument);
+    BOOST_REQUIRE_THROW(tv.seek(1.), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,323 @@
+#include <cstdio>
+#include <sstream>
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+#include <boost/test/unit_test.hpp>
+#include <fwdpp/ts/std_table_collection.hpp>
+#include <fwdpp/ts/tskit_trees.hpp>
+#include "simple_table_collection_infinite_sites.hpp"
+#include "wfevolve_table_collection.hpp"
+#include "tskit_utils.hpp"
+
+namespace
+{
+    template <typename A, typename B>
+    bool
+    same_rows(const A& a, const B& b)
+    {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+    }
+
+    template <typename A, typename B>
+    bool
+    same_tables(const A& a, const B& b)
+    {
+        return a.genome_length() == b.genome_length() && same_rows(a.nodes, b.nodes)
+               && same_rows(a.edges, b.edges) && same_rows(a.sites, b.sites)
+               && same_rows(a.mutations, b.mutations)
+               && a.preserved_nodes == b.preserved_nodes
+               && a.input_left == b.input_left && a.output_right == b.output_right;
+    }
+
+    template <typename TableCollectionType>
+    TableCollectionType
+    round_trip(const TableCollectionType& tables,
+               const std::vector<fwdpp::ts::table_index_t>& samples,
+               double forward_time, std::vector<fwdpp::ts::table_index_t>& samples_out)
+    {
+        std::stringstream buffer;
+        fwdpp::ts::io::write_tskit_trees(buffer, tables, samples, forward_time);
+        return fwdpp::ts::io::read_tskit_trees<TableCollectionType>()(
+            buffer, forward_time, samples_out);
+    }
+
+    table_collection_ptr
+    load_tskit_tables(const char* filename)
+    {
+        table_collection_ptr rv(new tsk_table_collection_t(),
+                                [](tsk_table_collection_t* tables) {
+                                    tsk_table_collection_free(tables);
+                                    delete tables;
+                                });
+        handle_tskit_return_code(tsk_table_collection_load(rv.get(), filename, 0));
+        return rv;
+    }
+
+    template <typename T>
+    bool
+    same_column(const T* a, const T* b, tsk_size_t n)
+    {
+        return std::equal(a, a + n, b);
+    }
+
+    struct wf_tables_fixture
+    // Overlapping generations with preserved nodes
+    {
+        fwdpp::ts::std_table_collection tables;
+        std::vector<fwdpp::ts::table_index_t> samples;
+        double forward_time;
+        wf_tables_fixture() : tables(1.), samples{}, forward_time{0.}
+        {
+            auto results = wfevolve_table_collection(42, 100, 500, 0.5, 10., 50, false,
+                                                     false, false, empty_policies{},
+                                                     tables);
+            for (auto& p : results.alive_individuals)
+                {
+                    samples.push_back(p.nodes[0]);
+                    samples.push_back(p.nodes[1]);
+                }
+            std::sort(begin(samples), end(samples));
+            std::vector<fwdpp::ts::table_index_t> preserved;
+            for (fwdpp::ts::table_index_t i = 0;
+                 preserved.size() < 3
+                 && static_cast<std::size_t>(i) < tables.nodes.size();
+                 ++i)
+                {
+                    if (!std::binary_search(begin(samples), end(samples), i))
+                        {
+                            preserved.push_back(i);
+                        }
+                }
+            BOOST_REQUIRE_EQUAL(preserved.size(), 3);
+            tables.record_preserved_nodes(preserved);
+            tables.build_indexes();
+            for (auto& n : tables.nodes)
+                {
+                    forward_time = std::max(forward_time, n.time);
+                }
+        }
+    };
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(test_tskit_trees)
+
+BOOST_FIXTURE_TEST_CASE(test_round_trip_with_mutations,
+                        simple_table_collection_infinite_sites)
+{
+    std::vector<fwdpp::ts::table_index_t> samples_out;
+    tables.mutations[2].neutral = false;
+    tables.mutations[3].derived_state = -7;
+    auto t = round_trip(tables, samples, 3., samples_out);
+    BOOST_REQUIRE(same_tables(tables, t));
+    BOOST_REQUIRE(samples_out == samples);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_round_trip_wf_tables, wf_tables_fixture)
+{
+    std::vector<fwdpp::ts::table_index_t> samples_out;
+    auto t = round_trip(tables, samples, forward_time, samples_out);
+    BOOST_REQUIRE(same_tables(tables, t));
+    BOOST_REQUIRE(samples_out == samples);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_load_with_tskit, wf_tables_fixture)
+{
+    const char* filename = "test_load_with_tskit.trees";
+    {
+        std::ofstream o(filename, std::ios::binary);
+        fwdpp::ts::io::write_tskit_trees(o, tables, samples, forward_time);
+    }
+    auto loaded = load_tskit_tables(filename);
+    std::remove(filename);
+
+    std::vector<int> is_sample(tables.nodes.size(), 0);
+    for (auto s : samples)
+        {
+            is_sample[s] = 1;
+        }
+    for (auto p : tables.preserved_nodes)
+        {
+            is_sample[p] = 1;
+        }
+    auto expected = dump_table_collection_to_tskit(tables, forward_time, is_sample);
+
+    BOOST_REQUIRE_EQUAL(loaded->sequence_length, expected->sequence_length);
+    BOOST_REQUIRE_EQUAL(loaded->nodes.num_rows, expected->nodes.num_rows);
+    BOOST_REQUIRE(same_column(loaded->nodes.time, expected->nodes.time,
+                              expected->nodes.num_rows));
+    for (tsk_size_t i = 0; i < expected->nodes.num_rows; ++i)
+        {
+            BOOST_REQUIRE_EQUAL(loaded->nodes.flags[i] & TSK_NODE_IS_SAMPLE,
+                                expected->nodes.flags[i]);
+            BOOST_REQUIRE_EQUAL(
+                static_cast<bool>(loaded->nodes.flags[i]
+                                  & fwdpp::ts::io::FWDPP_NODE_IS_PRESERVED),
+                std::count(begin(tables.preserved_nodes), end(tables.preserved_nodes),
+                           static_cast<fwdpp::ts::table_index_t>(i))
+                    == 1);
+        }
+    BOOST_REQUIRE_EQUAL(loaded->edges.num_rows, expected->edges.num_rows);
+    const auto num_edges = expected->edges.num_rows;
+    BOOST_REQUIRE(same_column(loaded->edges.left, expected->edges.left, num_edges));
+    BOOST_REQUIRE(same_column(loaded->edges.right, expected->edges.right, num_edges));
+    BOOST_REQUIRE(same_column(loaded->edges.parent, expected->edges.parent, num_edges));
+    BOOST_REQUIRE(same_column(loaded->edges.child, expected->edges.child, num_edges));
+    BOOST_REQUIRE_EQUAL(loaded->sites.num_rows, tables.sites.size());
+    BOOST_REQUIRE_EQUAL(loaded->mutations.num_rows, tables.mutations.size());
+
+    tsk_treeseq_wrapper loaded_treeseq(loaded.get());
+    tsk_treeseq_wrapper expected_treeseq(expected.get());
+    BOOST_REQUIRE_EQUAL(tsk_treeseq_get_num_samples(loaded_treeseq.get()),
+                        tsk_treeseq_get_num_samples(expected_treeseq.get()));
+    BOOST_REQUIRE_EQUAL(tsk_treeseq_get_num_trees(loaded_treeseq.get()),
+                        tsk_treeseq_get_num_trees(expected_treeseq.get()));
+}
+
+BOOST_FIXTURE_TEST_CASE(test_read_tskit_output, wf_tables_fixture)
+{
+    const char* filename = "test_read_tskit_output.trees";
+    std::vector<int> is_sample(tables.nodes.size(), 0);
+    for (auto s : samples)
+        {
+            is_sample[s] = 1;
+        }
+    auto tskit_tables = dump_table_collection_to_tskit(tables, forward_time, is_sample);
+    handle_tskit_return_code(tsk_table_collection_dump(tskit_tables.get(), filename, 0));
+
+    std::vector<fwdpp::ts::table_index_t> samples_out;
+    std::ifstream in(filename, std::ios::binary);
+    auto t = fwdpp::ts::io::read_tskit_trees<fwdpp::ts::std_table_collection>()(
+        in, forward_time, samples_out);
+    in.close();
+    std::remove(filename);
+
+    BOOST_REQUIRE_EQUAL(t.genome_length(), tables.genome_length());
+    BOOST_REQUIRE(samples_out == samples);
+    BOOST_REQUIRE(t.preserved_nodes.empty());
+    BOOST_REQUIRE_EQUAL(t.nodes.size(), tables.nodes.size());
+    for (std::size_t i = 0; i < t.nodes.size(); ++i)
+        {
+            // dump_table_collection_to_tskit does not record populations
+            BOOST_REQUIRE_EQUAL(t.nodes[i].time, tables.nodes[i].time);
+            BOOST_REQUIRE_EQUAL(t.nodes[i].deme, -1);
+        }
+    BOOST_REQUIRE(same_rows(t.edges, tables.edges));
+    BOOST_REQUIRE(t.sites.empty());
+    BOOST_REQUIRE(t.mutations.empty());
+    BOOST_REQUIRE(t.indexed());
+}
+
+BOOST_FIXTURE_TEST_CASE(test_kastore_layout, simple_table_collection_infinite_sites)
+{
+    std::stringstream buffer;
+    fwdpp::ts::io::write_tskit_trees(buffer, tables, samples, 3.);
+    auto bytes = buffer.str();
+    BOOST_REQUIRE(std::memcmp(bytes.data(), "\211KAS\r\n\032\n", 8) == 0);
+    BOOST_REQUIRE_EQUAL(fwdpp::ts::detail::decode_little_endian<std::uint64_t>(
+                            bytes.data() + 16),
+                        bytes.size());
+    const auto num_items
+        = fwdpp::ts::detail::decode_little_endian<std::uint32_t>(bytes.data() + 12);
+    std::vector<std::string> keys;
+    for (std::uint32_t i = 0; i < num_items; ++i)
+        {
+            const char* d = bytes.data() + 64 + 64 * i;
+            auto key_start = fwdpp::ts::detail::decode_little_endian<std::uint64_t>(d + 8);
+            auto key_len = fwdpp::ts::detail::decode_little_endian<std::uint64_t>(d + 16);
+            auto array_start
+                = fwdpp::ts::detail::decode_little_endian<std::uint64_t>(d + 24);
+            BOOST_REQUIRE_EQUAL(array_start % 8, 0);
+            keys.emplace_back(bytes.data() + key_start, key_len);
+        }
+    BOOST_REQUIRE(std::is_sorted(begin(keys), end(keys)));
+
+    std::istringstream in(bytes);
+    auto items = fwdpp::ts::detail::read_kastore(
+        in, {"format/name", "nodes/time", "nodes/flags", "uuid"});
+    auto name = fwdpp::ts::detail::kastore_get<std::int8_t>(items, "format/name");
+    BOOST_REQUIRE_EQUAL(std::string(name.begin(), name.end()), "tskit.trees");
+    BOOST_REQUIRE_EQUAL(items.at("uuid").length, 36);
+    // tskit time runs backwards
+    auto time = fwdpp::ts::detail::kastore_get<double>(items, "nodes/time");
+    for (std::size_t i = 0; i < time.size(); ++i)
+        {
+            BOOST_REQUIRE_EQUAL(time[i], 3. - tables.nodes[i].time);
+        }
+    auto flags = fwdpp::ts::detail::kastore_get<std::uint32_t>(items, "nodes/flags");
+    BOOST_REQUIRE_EQUAL(std::count(begin(flags), end(flags), 1u), samples.size());
+}
+
+BOOST_FIXTURE_TEST_CASE(test_mutation_parents, simple_table_collection_infinite_sites)
+{
+    tables.sites.clear();
+    tables.mutations.clear();
+    auto s = tables.emplace_back_site(0.25, std::int8_t{0});
+    tables.emplace_back_mutation(4, 0lu, s, std::int8_t{1}, true);
+    tables.emplace_back_mutation(0, 1lu, s, std::int8_t{2}, true);
+    tables.emplace_back_mutation(2, 2lu, s, std::int8_t{1}, true);
+    s = tables.emplace_back_site(0.5, std::int8_t{0});
+    tables.emplace_back_mutation(5, 3lu, s, std::int8_t{1}, true);
+    tables.emplace_back_mutation(3, 4lu, s, std::int8_t{2}, true);
+    tables.emplace_back_mutation(3, 5lu, s, std::int8_t{3}, true);
+    s = tables.emplace_back_site(0.75, std::int8_t{0});
+    tables.emplace_back_mutation(1, 6lu, s, std::int8_t{1}, true);
+
+    std::stringstream buffer;
+    fwdpp::ts::io::write_tskit_trees(buffer, tables, samples, 3.);
+    auto items = fwdpp::ts::detail::read_kastore(buffer, {"mutations/parent"});
+    auto parents
+        = fwdpp::ts::detail::kastore_get<std::int32_t>(items, "mutations/parent");
+    BOOST_REQUIRE(parents == std::vector<std::int32_t>({-1, 0, -1, -1, 3, 4, -1}));
+}
+
+BOOST_FIXTURE_TEST_CASE(test_mutation_parents_match_tskit,
+                        simple_table_collection_infinite_sites)
+{
+    // Stack a second mutation below the one on node 4,
+    // after it in the table, as tskit requires
+    auto m = std::find_if(begin(tables.mutations), end(tables.mutations),
+                          [](const fwdpp::ts::mutation_record& r) { return r.node == 4; });
+    BOOST_REQUIRE(m != end(tables.mutations));
+    tables.mutations.insert(m + 1, fwdpp::ts::mutation_record{
+                                       0, tables.mutations.size(), m->site,
+                                       std::int8_t{2}, true});
+    const char* filename = "test_mutation_parents_match_tskit.trees";
+    {
+        std::ofstream o(filename, std::ios::binary);
+        fwdpp::ts::io::write_tskit_trees(o, tables, samples, 3.);
+    }
+    auto loaded = load_tskit_tables(filename);
+    std::remove(filename);
+    const auto n = loaded->mutations.num_rows;
+    std::vector<tsk_id_t> written(loaded->mutations.parent,
+                                  loaded->mutations.parent + n);
+    BOOST_REQUIRE(std::count(begin(written), end(written), -1)
+                  < static_cast<std::ptrdiff_t>(n));
+    handle_tskit_return_code(
+        tsk_table_collection_compute_mutation_parents(loaded.get(), 0));
+    BOOST_REQUIRE(same_column(written.data(), loaded->mutations.parent, n));
+}
+
+BOOST_AUTO_TEST_CASE(test_unindexed_tables)
+{
+    fwdpp::ts::std_table_collection tables(1.);
+    tables.push_back_node(0, 0);
+    tables.push_back_node(1, 0);
+    tables.push_back_edge(0, 1, 0, 1);
+    std::ostringstream o;
+    BOOST_REQUIRE_THROW(fwdpp::ts::io::write_tskit_trees(o, tables, {1}, 1.),
+                        fwdpp::ts::tables_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_invalid_input)
+{
+    std::istringstream in("not a kastore file, but long enough to hold a header.....");
+    std::vector<fwdpp::ts::table_index_t> samples;
+    BOOST_REQUIRE_THROW(
+        fwdpp::ts::io::read_tskit_trees<fwdpp::ts::std_table_collection>()(in, 0.,
+                                                                           samples),
+        std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
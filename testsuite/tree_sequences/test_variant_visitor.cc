@@ -0,0 +1,75 @@
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <boost/test/unit_test.hpp>
+#include <fwdpp/ts/variant_visitor.hpp>
+#include <fwdpp/ts/generate_data_matrix.hpp>
+#include "simple_table_collection_infinite_sites.hpp"
+
+namespace
+{
+    void
+    require_same_rows(
+        fwdpp::ts::variant_visitor<fwdpp::ts::std_table_collection>& vv,
+        const fwdpp::data_matrix& dm)
+    // The variants are the rows of dm, with neutral
+    // and selected rows interleaved by position.
+    {
+        std::size_t n = 0, s = 0;
+        const auto* buffer = vv.genotypes().data();
+        while (vv())
+            {
+                BOOST_REQUIRE(vv.genotypes().data() == buffer);
+                const auto& sm = vv.neutral() ? dm.neutral : dm.selected;
+                const auto& keys = vv.neutral() ? dm.neutral_keys : dm.selected_keys;
+                auto& row = vv.neutral() ? n : s;
+                BOOST_REQUIRE(row < sm.positions.size());
+                BOOST_REQUIRE_EQUAL(vv.position(), sm.positions[row]);
+                BOOST_REQUIRE_EQUAL(vv.key(), keys[row]);
+                BOOST_REQUIRE(std::equal(vv.genotypes().begin(), vv.genotypes().end(),
+                                         sm.data.begin() + row * dm.ncol));
+                ++row;
+            }
+        BOOST_REQUIRE_EQUAL(n, dm.neutral.positions.size());
+        BOOST_REQUIRE_EQUAL(s, dm.selected.positions.size());
+        BOOST_REQUIRE(!vv());
+    }
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(test_variant_visitor, simple_table_collection_infinite_sites)
+
+BOOST_AUTO_TEST_CASE(test_same_as_data_matrix)
+{
+    // Make some variants selected
+    for (std::size_t i = 0; i < tables.mutations.size(); i += 2)
+        {
+            tables.mutations[i].neutral = false;
+        }
+    for (bool skip_fixed : {false, true})
+        {
+            auto dm = fwdpp::ts::generate_data_matrix(tables, samples, true, true,
+                                                      skip_fixed);
+            BOOST_REQUIRE(!dm.neutral.positions.empty());
+            BOOST_REQUIRE(!dm.selected.positions.empty());
+            fwdpp::ts::variant_visitor<fwdpp::ts::std_table_collection> vv(
+                tables, samples, true, true, skip_fixed);
+            require_same_rows(vv, dm);
+        }
+}
+
+BOOST_AUTO_TEST_CASE(test_position_range)
+{
+    const double start = tables.sites[2].position;
+    const double stop = tables.sites[5].position;
+    auto dm = fwdpp::ts::generate_data_matrix(tables, samples, true, false, false,
+                                              start, stop);
+    BOOST_REQUIRE_EQUAL(dm.neutral.positions.size(), 3);
+    fwdpp::ts::variant_visitor<fwdpp::ts::std_table_collection> vv(
+        tables, samples, true, false, false, start, stop);
+    require_same_rows(vv, dm);
+    BOOST_REQUIRE_THROW(fwdpp::ts::variant_visitor<fwdpp::ts::std_table_collection>(
+                            tables, samples, true, true, false, stop, start),
+                        std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
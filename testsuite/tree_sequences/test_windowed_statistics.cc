@@ -0,0 +1,375 @@
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <boost/test/unit_test.hpp>
+#include <fwdpp/ts/std_table_collection.hpp>
+#include <fwdpp/ts/tree_visitor.hpp>
+#include <fwdpp/ts/windowed_statistics.hpp>
+#include "wfevolve_table_collection.hpp"
+
+namespace
+{
+    using fwdpp::ts::statistic_mode;
+    using fwdpp::ts::table_index_t;
+
+    struct wf_statistics_fixture
+    {
+        fwdpp::ts::std_table_collection tables;
+        std::vector<fwdpp::ts::sample_group_map> one_group, two_groups;
+        std::vector<table_index_t> samples;
+        std::vector<double> windows;
+
+        wf_statistics_fixture()
+            : tables(1.), one_group{}, two_groups{}, samples{},
+              windows{0., 0.1, 0.15, 0.4, 0.5, 0.77, 0.9, 1.}
+        {
+            wfevolve_table_collection(42, 100, 500, 0., 10., 50, false, false, false,
+                                      empty_policies{}, tables);
+            tables.build_indexes();
+            for (table_index_t i = 0; i < 200; ++i)
+                {
+                    samples.push_back(i);
+                    one_group.emplace_back(i, 0);
+                    two_groups.emplace_back(i, i < 120 ? 0 : 1);
+                }
+            add_mutations();
+        }
+
+        void
+        add_mutations()
+        // One mutation on the child of each of a random set of edges.
+        // Two sites get a second mutation on the parent of the edge.
+        {
+            std::mt19937 rng(101);
+            std::uniform_int_distribution<std::size_t> pick(0, tables.edges.size() - 1);
+            std::uniform_real_distribution<double> uniform(0., 1.);
+            std::vector<std::pair<double, std::size_t>> positions;
+            for (int i = 0; i < 150; ++i)
+                {
+                    auto e = pick(rng);
+                    const auto& edge = tables.edges[e];
+                    positions.emplace_back(
+                        edge.left + uniform(rng) * (edge.right - edge.left), e);
+                }
+            std::sort(begin(positions), end(positions));
+            for (std::size_t i = 0; i < positions.size(); ++i)
+                {
+                    const auto& edge = tables.edges[positions[i].second];
+                    auto s = tables.emplace_back_site(positions[i].first,
+                                                      fwdpp::ts::default_ancestral_state);
+                    if (i == 30 || i == 90)
+                        {
+                            tables.emplace_back_mutation(edge.parent, i, s,
+                                                         std::int8_t{1}, true);
+                        }
+                    tables.emplace_back_mutation(
+                        edge.child, i, s, static_cast<std::int8_t>(i == 30 ? 2 : 1),
+                        true);
+                }
+        }
+
+        template <typename F>
+        std::vector<std::vector<double>>
+        brute_force_branch(const std::vector<fwdpp::ts::sample_group_map>& groups,
+                           std::size_t K, const F& f, bool polarised) const
+        // Sample counts are found by walking up from each sample
+        {
+            const auto n = fwdpp::ts::detail::sample_group_sizes(groups);
+            const auto G = n.size();
+            std::vector<std::vector<double>> result(windows.size() - 1,
+                                                    std::vector<double>(K, 0.));
+            fwdpp::ts::tree_visitor<fwdpp::ts::std_table_collection> tv(
+                tables, samples, fwdpp::ts::update_samples_list(false));
+            std::vector<double> y(K), z(K), complement(G);
+            while (tv())
+                {
+                    const auto& tree = tv.tree();
+                    std::vector<std::vector<double>> x(tree.size(),
+                                                       std::vector<double>(G, 0.));
+                    for (auto& s : groups)
+                        {
+                            for (auto u = s.node_id; u != fwdpp::ts::NULL_INDEX;
+                                 u = tree.parents[u])
+                                {
+                                    x[u][s.group] += 1.;
+                                }
+                        }
+                    for (std::size_t u = 0; u < tree.size(); ++u)
+                        {
+                            const auto p = tree.parents[u];
+                            if (p == fwdpp::ts::NULL_INDEX)
+                                {
+                                    continue;
+                                }
+                            f(x[u].data(), y.data());
+                            if (!polarised)
+                                {
+                                    for (std::size_t g = 0; g < G; ++g)
+                                        {
+                                            complement[g] = n[g] - x[u][g];
+                                        }
+                                    f(complement.data(), z.data());
+                                    for (std::size_t k = 0; k < K; ++k)
+                                        {
+                                            y[k] += z[k];
+                                        }
+                                }
+                            const double bl
+                                = tables.nodes[u].time - tables.nodes[p].time;
+                            for (std::size_t w = 0; w + 1 < windows.size(); ++w)
+                                {
+                                    const double span
+                                        = std::min(tree.right, windows[w + 1])
+                                          - std::max(tree.left, windows[w]);
+                                    if (span > 0.)
+                                        {
+                                            for (std::size_t k = 0; k < K; ++k)
+                                                {
+                                                    result[w][k] += bl * span * y[k];
+                                                }
+                                        }
+                                }
+                        }
+                }
+            return result;
+        }
+
+        template <typename F>
+        std::vector<std::vector<double>>
+        brute_force_site(const std::vector<fwdpp::ts::sample_group_map>& groups,
+                         std::size_t K, const F& f, bool polarised) const
+        // Genotypes are found by walking up from each sample
+        // to the nearest mutation.
+        {
+            const auto G = fwdpp::ts::detail::sample_group_sizes(groups).size();
+            std::vector<std::vector<double>> result(windows.size() - 1,
+                                                    std::vector<double>(K, 0.));
+            fwdpp::ts::tree_visitor<fwdpp::ts::std_table_collection> tv(
+                tables, samples, fwdpp::ts::update_samples_list(false));
+            std::vector<double> y(K);
+            while (tv())
+                {
+                    const auto& tree = tv.tree();
+                    for (std::size_t s = 0; s < tables.sites.size(); ++s)
+                        {
+                            const double pos = tables.sites[s].position;
+                            if (pos < tree.left || !(pos < tree.right))
+                                {
+                                    continue;
+                                }
+                            std::vector<std::vector<double>> counts(
+                                3, std::vector<double>(G, 0.));
+                            for (auto& sample : groups)
+                                {
+                                    std::int8_t state = tables.sites[s].ancestral_state;
+                                    bool found = false;
+                                    for (auto u = sample.node_id;
+                                         u != fwdpp::ts::NULL_INDEX && !found;
+                                         u = tree.parents[u])
+                                        {
+                                            for (auto& m : tables.mutations)
+                                                {
+                                                    if (m.site == s && m.node == u)
+                                                        {
+                                                            state = m.derived_state;
+                                                            found = true;
+                                                        }
+                                                }
+                                        }
+                                    counts[state][sample.group] += 1.;
+                                }
+                            const auto w = static_cast<std::size_t>(
+                                std::upper_bound(begin(windows), end(windows), pos)
+                                - begin(windows) - 1);
+                            for (std::size_t a = polarised ? 1 : 0; a < 3; ++a)
+                                {
+                                    if (a > 0
+                                        && std::none_of(
+                                            begin(tables.mutations),
+                                            end(tables.mutations),
+                                            [s, a](const fwdpp::ts::mutation_record& m) {
+                                                return m.site == s
+                                                       && m.derived_state
+                                                              == static_cast<
+                                                                  std::int8_t>(a);
+                                            }))
+                                        {
+                                            continue;
+                                        }
+                                    f(counts[a].data(), y.data());
+                                    for (std::size_t k = 0; k < K; ++k)
+                                        {
+                                            result[w][k] += y[k];
+                                        }
+                                }
+                        }
+                }
+            return result;
+        }
+    };
+
+    void
+    require_close(const std::vector<std::vector<double>>& a,
+                  const std::vector<std::vector<double>>& b)
+    {
+        BOOST_REQUIRE_EQUAL(a.size(), b.size());
+        for (std::size_t w = 0; w < a.size(); ++w)
+            {
+                BOOST_REQUIRE_EQUAL(a[w].size(), b[w].size());
+                for (std::size_t k = 0; k < a[w].size(); ++k)
+                    {
+                        BOOST_REQUIRE_SMALL(a[w][k] - b[w][k],
+                                            1e-9 * (1. + std::abs(b[w][k])));
+                    }
+            }
+    }
+
+    struct sample_count
+    // Summary function that returns x unchanged
+    {
+        std::size_t G;
+        void
+        operator()(const double* x, double* out) const
+        {
+            std::copy(x, x + G, out);
+        }
+    };
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(test_windowed_statistics, wf_statistics_fixture)
+
+BOOST_AUTO_TEST_CASE(test_branch_mode)
+{
+    for (bool polarised : {true, false})
+        {
+            sample_count f{2};
+            auto expected = brute_force_branch(two_groups, 2, f, polarised);
+            for (unsigned threads : {1u, 3u, 16u})
+                {
+                    auto result = fwdpp::ts::general_statistic(
+                        tables, two_groups, 2, f, windows, statistic_mode::branch,
+                        polarised, false, threads);
+                    require_close(result, expected);
+                }
+        }
+}
+
+BOOST_AUTO_TEST_CASE(test_site_mode)
+{
+    for (bool polarised : {true, false})
+        {
+            sample_count f{2};
+            auto expected = brute_force_site(two_groups, 2, f, polarised);
+            for (unsigned threads : {1u, 4u})
+                {
+                    auto result = fwdpp::ts::general_statistic(
+                        tables, two_groups, 2, f, windows, statistic_mode::site,
+                        polarised, false, threads);
+                    require_close(result, expected);
+                }
+        }
+}
+
+BOOST_AUTO_TEST_CASE(test_diversity_and_divergence)
+{
+    const std::vector<double> n{120., 80.};
+    auto pi = [&n](const double* x, double* out) {
+        for (std::size_t g = 0; g < 2; ++g)
+            {
+                out[g] = x[g] * (n[g] - x[g]) / (n[g] * (n[g] - 1.));
+            }
+    };
+    auto dxy = [&n](const double* x, double* out) {
+        out[0] = x[0] * (n[1] - x[1]) / (n[0] * n[1]);
+    };
+    for (auto mode : {statistic_mode::branch, statistic_mode::site})
+        {
+            auto expected_pi = mode == statistic_mode::branch
+                                   ? brute_force_branch(two_groups, 2, pi, false)
+                                   : brute_force_site(two_groups, 2, pi, false);
+            auto expected_dxy = mode == statistic_mode::branch
+                                    ? brute_force_branch(two_groups, 1, dxy, false)
+                                    : brute_force_site(two_groups, 1, dxy, false);
+            for (std::size_t w = 0; w + 1 < windows.size(); ++w)
+                {
+                    for (auto& v : expected_pi[w])
+                        {
+                            v /= windows[w + 1] - windows[w];
+                        }
+                    expected_dxy[w][0] /= windows[w + 1] - windows[w];
+                }
+            require_close(fwdpp::ts::diversity(tables, two_groups, windows, mode, 2),
+                          expected_pi);
+            require_close(fwdpp::ts::divergence(tables, two_groups, windows, mode, 2),
+                          expected_dxy);
+        }
+}
+
+BOOST_AUTO_TEST_CASE(test_site_frequency_spectrum)
+{
+    const std::vector<double> whole_genome{0., 1.};
+    auto sfs = fwdpp::ts::site_frequency_spectrum(
+        tables, one_group, 0, whole_genome, statistic_mode::site, true);
+    BOOST_REQUIRE_EQUAL(sfs[0].size(), 201);
+    double num_alleles = 0.;
+    for (auto v : sfs[0])
+        {
+            num_alleles += v;
+        }
+    // One site has two derived states
+    BOOST_REQUIRE_EQUAL(num_alleles, static_cast<double>(tables.sites.size() + 1));
+
+    auto branch = fwdpp::ts::site_frequency_spectrum(
+        tables, one_group, 0, windows, statistic_mode::branch, true, 3);
+    auto folded = fwdpp::ts::site_frequency_spectrum(
+        tables, one_group, 0, windows, statistic_mode::branch, false, 3);
+    BOOST_REQUIRE_EQUAL(folded[0].size(), 101);
+    for (std::size_t w = 0; w + 1 < windows.size(); ++w)
+        {
+            BOOST_REQUIRE_EQUAL(branch[w][0], 0.);
+            for (std::size_t i = 1; i < 100; ++i)
+                {
+                    BOOST_REQUIRE_SMALL(
+                        folded[w][i] - (branch[w][i] + branch[w][200 - i]), 1e-9);
+                }
+            BOOST_REQUIRE_SMALL(folded[w][100] - branch[w][100], 1e-9);
+        }
+}
+
+BOOST_AUTO_TEST_CASE(test_span_normalise)
+{
+    sample_count f{1};
+    auto raw = fwdpp::ts::general_statistic(tables, one_group, 1, f, windows,
+                                            statistic_mode::branch, true, false, 2);
+    auto normalised = fwdpp::ts::general_statistic(
+        tables, one_group, 1, f, windows, statistic_mode::branch, true, true, 2);
+    for (std::size_t w = 0; w + 1 < windows.size(); ++w)
+        {
+            BOOST_REQUIRE_CLOSE(normalised[w][0] * (windows[w + 1] - windows[w]),
+                                raw[w][0], 1e-9);
+        }
+}
+
+BOOST_AUTO_TEST_CASE(test_invalid_input)
+{
+    sample_count f{1};
+    for (auto w : {std::vector<double>{0.}, std::vector<double>{0., 0.5},
+                   std::vector<double>{0.1, 1.}, std::vector<double>{0., 0.5, 0.5, 1.}})
+        {
+            BOOST_REQUIRE_THROW(fwdpp::ts::general_statistic(tables, one_group, 1, f, w,
+                                                             statistic_mode::site, true,
+                                                             false, 1),
+                                std::invalid_argument);
+        }
+    std::vector<fwdpp::ts::sample_group_map> negative{{0, -1}};
+    BOOST_REQUIRE_THROW(fwdpp::ts::general_statistic(tables, negative, 1, f, windows,
+                                                     statistic_mode::site, true, false,
+                                                     1),
+                        fwdpp::ts::samples_error);
+    BOOST_REQUIRE_THROW(
+        fwdpp::ts::divergence(tables, one_group, windows, statistic_mode::site),
+        std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
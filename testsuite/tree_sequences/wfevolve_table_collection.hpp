@@ -155,7 +155,7 @@ flush_buffer_n_simplify(
     double max_time = -1; //-1;//std::numeric_limits<double>::max();
     for (auto a : alive_at_last_simplification)
         {
-            max_time = std::max(max_time, tables.nodes[a].time);
+            max_time = std::max<double>(max_time, tables.nodes[a].time);
         }
 
     std::vector<std::size_t> temp{};
@@ -289,7 +289,7 @@ wfevolve_table_collection(unsigned seed, unsigned N, unsigned nsteps, double psu
             double max_time = -1; //-1;//std::numeric_limits<double>::max();
             for (auto a : alive_at_last_simplification)
                 {
-                    max_time = std::max(max_time, tables.nodes[a].time);
+                    max_time = std::max<double>(max_time, tables.nodes[a].time);
                 }
             stitch_together_edges(alive_at_last_simplification, max_time, buffer,
                                   edge_liftover, tables);
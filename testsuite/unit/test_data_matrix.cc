@@ -0,0 +1,211 @@
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <system_error>
+#include <boost/test/unit_test.hpp>
+#include <fwdpp/types/mutation.hpp>
+#include <fwdpp/diploid_population.hpp>
+#include <fwdpp/data_matrix.hpp>
+#include <fwdpp/packed_data_matrix.hpp>
+#include <fwdpp/sampling_functions.hpp>
+
+namespace
+{
+    struct random_population_fixture
+    // 75 diploids with random haploid genomes.  There are
+    // more than 64 haploid genomes, so that packed rows span
+    // several words.
+    {
+        using poptype = fwdpp::diploid_population<fwdpp::mutation>;
+        using mutation_container = poptype::haploid_genome_t::mutation_container;
+        poptype pop;
+        std::vector<std::size_t> individuals;
+
+        random_population_fixture() : pop(75), individuals()
+        {
+            std::mt19937 rng(101);
+            std::bernoulli_distribution carries(0.2);
+            for (unsigned i = 0; i < 40; ++i)
+                {
+                    pop.mutations.emplace_back(static_cast<double>(i) / 40.,
+                                               (i % 4 == 1) ? 0.1 : 0., 1., 0);
+                }
+            pop.mcounts.assign(pop.mutations.size(), 0);
+            pop.haploid_genomes.clear();
+            for (std::size_t i = 0; i < 2 * pop.diploids.size(); ++i)
+                {
+                    mutation_container n, s;
+                    for (std::size_t k = 0; k < pop.mutations.size(); ++k)
+                        {
+                            // Mutation 0 is in every haploid genome
+                            if (k == 0 || carries(rng))
+                                {
+                                    (pop.mutations[k].neutral ? n : s).push_back(k);
+                                    ++pop.mcounts[k];
+                                }
+                        }
+                    pop.haploid_genomes.emplace_back(1, n, s);
+                }
+            for (std::size_t i = 0; i < pop.diploids.size(); ++i)
+                {
+                    pop.diploids[i].first = 2 * i;
+                    pop.diploids[i].second = 2 * i + 1;
+                }
+            for (std::size_t i = 0; i < pop.diploids.size(); i += 2)
+                {
+                    individuals.push_back(i);
+                }
+            std::shuffle(begin(individuals), end(individuals), rng);
+        }
+
+        std::vector<std::int8_t>
+        naive_rows(const std::vector<std::pair<std::size_t, fwdpp::uint_t>>& keys,
+                   const bool neutral, const bool genotype) const
+        {
+            std::vector<std::int8_t> rv;
+            for (auto& k : keys)
+                {
+                    for (auto i : individuals)
+                        {
+                            std::int8_t sum = 0;
+                            for (auto g : {pop.diploids[i].first, pop.diploids[i].second})
+                                {
+                                    auto& m = neutral ? pop.haploid_genomes[g].mutations
+                                                      : pop.haploid_genomes[g].smutations;
+                                    std::int8_t x
+                                        = std::find(begin(m), end(m), k.first) != end(m);
+                                    if (genotype)
+                                        {
+                                            sum += x;
+                                        }
+                                    else
+                                        {
+                                            rv.push_back(x);
+                                        }
+                                }
+                            if (genotype)
+                                {
+                                    rv.push_back(sum);
+                                }
+                        }
+                }
+            return rv;
+        }
+    };
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(test_data_matrix, random_population_fixture)
+
+BOOST_AUTO_TEST_CASE(test_mutation_keys)
+{
+    auto keys = fwdpp::mutation_keys(pop, individuals, true, true);
+    BOOST_REQUIRE(!keys.first.empty());
+    BOOST_REQUIRE(!keys.second.empty());
+    // Keys are listed in order of first appearance in the sample
+    BOOST_REQUIRE_EQUAL(keys.first[0].first, 0);
+    BOOST_REQUIRE_EQUAL(keys.first[0].second, 2 * individuals.size());
+    for (auto& k : keys.first)
+        {
+            BOOST_REQUIRE(pop.mutations[k.first].neutral);
+        }
+    for (auto& k : keys.second)
+        {
+            BOOST_REQUIRE(!pop.mutations[k.first].neutral);
+        }
+    auto h = fwdpp::haplotype_matrix(pop, individuals, keys.first, keys.second);
+    auto counts = fwdpp::row_sums(h);
+    for (std::size_t i = 0; i < keys.first.size(); ++i)
+        {
+            BOOST_REQUIRE_EQUAL(counts.first[i], keys.first[i].second);
+        }
+    for (std::size_t i = 0; i < keys.second.size(); ++i)
+        {
+            BOOST_REQUIRE_EQUAL(counts.second[i], keys.second[i].second);
+        }
+}
+
+BOOST_AUTO_TEST_CASE(test_same_as_naive)
+{
+    auto keys = fwdpp::mutation_keys(pop, individuals, true, true);
+    // A repeated key gets a copy of the row
+    keys.first.push_back(keys.first[1]);
+    for (unsigned num_threads : {1u, 4u})
+        {
+            auto h = fwdpp::haplotype_matrix(pop, individuals, keys.first, keys.second,
+                                             num_threads);
+            BOOST_REQUIRE(h.neutral.data == naive_rows(keys.first, true, false));
+            BOOST_REQUIRE(h.selected.data == naive_rows(keys.second, false, false));
+            BOOST_REQUIRE_EQUAL(h.neutral.positions.size(), keys.first.size());
+            auto g = fwdpp::genotype_matrix(pop, individuals, keys.first, keys.second,
+                                            num_threads);
+            BOOST_REQUIRE(g.neutral.data == naive_rows(keys.first, true, true));
+            BOOST_REQUIRE(g.selected.data == naive_rows(keys.second, false, true));
+            auto p = fwdpp::packed_haplotype_matrix(pop, individuals, keys.first,
+                                                    keys.second, num_threads);
+            BOOST_REQUIRE(fwdpp::unpack(p.neutral).data == h.neutral.data);
+            BOOST_REQUIRE(fwdpp::unpack(p.selected).data == h.selected.data);
+            BOOST_REQUIRE(p.neutral_keys == h.neutral_keys);
+        }
+}
+
+BOOST_AUTO_TEST_CASE(test_sample_individuals_threads)
+{
+    auto a = fwdpp::sample_individuals(pop, individuals, true, true, true);
+    auto b = fwdpp::sample_individuals(pop, individuals, true, true, true, 3);
+    BOOST_REQUIRE(a.neutral.data == b.neutral.data);
+    BOOST_REQUIRE(a.selected.data == b.selected.data);
+    BOOST_REQUIRE(a.neutral.positions == b.neutral.positions);
+    // Mutation 0 is fixed
+    BOOST_REQUIRE(std::find(begin(a.neutral_keys), end(a.neutral_keys), 0)
+                  == end(a.neutral_keys));
+    BOOST_REQUIRE(std::is_sorted(begin(a.neutral.positions), end(a.neutral.positions)));
+}
+
+BOOST_AUTO_TEST_CASE(test_invalid_key)
+{
+    std::vector<std::pair<std::size_t, fwdpp::uint_t>> keys{{pop.mutations.size(), 1}};
+    BOOST_REQUIRE_THROW(fwdpp::haplotype_matrix(pop, individuals, keys, {}),
+                        std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(test_exception_in_worker_thread)
+{
+    std::vector<int> visited(100, 0);
+    BOOST_REQUIRE_THROW(fwdpp::data_matrix_details::run_over_individuals(
+                            visited.size(), 4, 8,
+                            [&visited](std::size_t first, std::size_t last) {
+                                for (auto i = first; i < last; ++i)
+                                    {
+                                        visited[i] = 1;
+                                    }
+                                if (first > 0)
+                                    {
+                                        throw std::runtime_error("worker failed");
+                                    }
+                            }),
+                        std::runtime_error);
+    // All ranges run before the exception is rethrown
+    BOOST_REQUIRE_EQUAL(std::count(begin(visited), end(visited), 1), visited.size());
+}
+
+BOOST_AUTO_TEST_CASE(test_thread_join_guard)
+// Unwinding past started threads, as when starting
+// a later thread fails, must join them, not terminate.
+{
+    std::vector<int> ran(3, 0);
+    BOOST_REQUIRE_THROW(
+        {
+            fwdpp::fwdpp_internal::thread_join_guard guard;
+            for (std::size_t i = 0; i < ran.size(); ++i)
+                {
+                    guard.threads.emplace_back([&ran, i]() { ran[i] = 1; });
+                }
+            throw std::system_error(
+                std::make_error_code(std::errc::resource_unavailable_try_again));
+        },
+        std::system_error);
+    BOOST_REQUIRE_EQUAL(std::count(begin(ran), end(ran), 1), 3);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
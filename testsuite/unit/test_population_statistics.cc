@@ -0,0 +1,99 @@
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include <fwdpp/types/mutation.hpp>
+#include <fwdpp/diploid_population.hpp>
+#include <fwdpp/sampling_functions.hpp>
+#include <fwdpp/population_statistics.hpp>
+
+namespace
+{
+    struct small_population_fixture
+    // 3 diploids, so n = 6
+    {
+        using poptype = fwdpp::diploid_population<fwdpp::mutation>;
+        using mutation_container = poptype::haploid_genome_t::mutation_container;
+        poptype pop;
+
+        small_population_fixture() : pop(3)
+        {
+            // Mutations 0, 1 and 4 are neutral.
+            // Mutation 3 is extinct.  Mutation 4 is fixed.
+            for (unsigned i = 0; i < 5; ++i)
+                {
+                    pop.mutations.emplace_back(static_cast<double>(i) / 5.,
+                                               (i == 2 || i == 3) ? 0.1 : 0., 1., 0);
+                }
+            pop.mcounts = {1, 3, 2, 0, 6};
+            pop.haploid_genomes.clear();
+            pop.haploid_genomes.emplace_back(1, mutation_container{0, 1, 4},
+                                             mutation_container{2});
+            pop.haploid_genomes.emplace_back(1, mutation_container{1, 4},
+                                             mutation_container{2});
+            pop.haploid_genomes.emplace_back(1, mutation_container{1, 4},
+                                             mutation_container{});
+            for (int i = 0; i < 3; ++i)
+                {
+                    pop.haploid_genomes.emplace_back(1, mutation_container{4},
+                                                     mutation_container{});
+                }
+            for (std::size_t i = 0; i < 3; ++i)
+                {
+                    pop.diploids[i].first = 2 * i;
+                    pop.diploids[i].second = 2 * i + 1;
+                }
+        }
+    };
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(test_population_statistics, small_population_fixture)
+
+BOOST_AUTO_TEST_CASE(test_known_values)
+{
+    auto s = fwdpp::population_summary_statistics(pop);
+    BOOST_REQUIRE_EQUAL(s.sample_size, 6);
+    BOOST_REQUIRE(s.neutral.sfs == (std::vector<std::uint32_t>{0, 1, 0, 1, 0, 0, 1}));
+    BOOST_REQUIRE(s.selected.sfs == (std::vector<std::uint32_t>{0, 0, 1, 0, 0, 0, 0}));
+    BOOST_REQUIRE_EQUAL(s.neutral.segregating_sites, 2);
+    BOOST_REQUIRE_EQUAL(s.selected.segregating_sites, 1);
+    BOOST_REQUIRE_CLOSE(s.neutral.theta_pi, (2. * 5. + 2. * 9.) / 30., 1e-10);
+    BOOST_REQUIRE_CLOSE(s.selected.theta_pi, 2. * 8. / 30., 1e-10);
+}
+
+BOOST_AUTO_TEST_CASE(test_same_as_data_matrix)
+{
+    auto dm = fwdpp::sample_individuals(pop, {0, 1, 2}, true, true, true);
+    auto counts = fwdpp::row_sums(dm);
+    auto s = fwdpp::population_summary_statistics(pop);
+    const double n = static_cast<double>(dm.ncol);
+    double pi = 0.;
+    for (auto c : counts.first)
+        {
+            pi += 2. * c * (n - c) / (n * (n - 1.));
+        }
+    BOOST_REQUIRE_EQUAL(counts.first.size(), s.neutral.segregating_sites);
+    BOOST_REQUIRE_EQUAL(counts.second.size(), s.selected.segregating_sites);
+    BOOST_REQUIRE_CLOSE(s.neutral.theta_pi, pi, 1e-10);
+}
+
+BOOST_AUTO_TEST_CASE(test_reuse)
+{
+    fwdpp::population_summary s;
+    fwdpp::population_summary_statistics(pop, s);
+    const auto data = s.neutral.sfs.data();
+    pop.mcounts[0] = 0;
+    fwdpp::population_summary_statistics(pop, s);
+    // No reallocation for the same population size
+    BOOST_REQUIRE(s.neutral.sfs.data() == data);
+    BOOST_REQUIRE_EQUAL(s.neutral.sfs[1], 0);
+    BOOST_REQUIRE_EQUAL(s.neutral.segregating_sites, 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_invalid_counts)
+{
+    pop.mcounts[0] = 7;
+    BOOST_REQUIRE_THROW(fwdpp::population_summary_statistics(pop), std::invalid_argument);
+    pop.mcounts.pop_back();
+    BOOST_REQUIRE_THROW(fwdpp::population_summary_statistics(pop), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()